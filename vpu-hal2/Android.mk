@@ -14,8 +14,12 @@ LOCAL_MODULE_OWNER := intel
 #LOCAL_MULTILIB := both
 LOCAL_MULTILIB := 64
 LOCAL_SRC_FILES := \
+    VpuBlobCache.cpp \
     VpuDriver.cpp \
-    VpuPreparedModel.cpp
+    VpuPartitioner.cpp \
+    VpuPoolCache.cpp \
+    VpuPreparedModel.cpp \
+    VpuWorkerPool.cpp
 
 LOCAL_C_INCLUDES += \
 	$(LOCAL_PATH) \
@@ -60,6 +64,8 @@ LOCAL_SHARED_LIBRARIES := \
     android.hidl.memory@1.0 \
     libinference_engine
 
+# loaded through the plugin dispatcher for the CPU partitions of a model
+LOCAL_REQUIRED_MODULES := libMKLDNNPlugin
 
 LOCAL_STATIC_LIBRARIES := libgraphAPI libpugixml
 
@@ -102,6 +108,7 @@ ZPATH := $(LOCAL_PATH)
 include $(CLEAR_VARS)
 
 include $(ZPATH)/graphAPI/graphAPI.mk
+include $(ZPATH)/fp16/fp16.mk
 include $(ZPATH)/graphTests/graphTests.mk
 include $(ZPATH)/ncsdk2/api/src/Android.mk
 include $(ZPATH)/dl/Android.mk
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VpuBlobCache"
+
+#include <cutils/log.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "VpuBlobCache.h"
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+#define VPU_BLOB_CACHE_SUFFIX ".blob"
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+void VpuBlobCache::Hasher::update(const void* data, size_t size)
+{
+    // two independent 64-bit lanes: FNV-1a and a multiply-rotate mix,
+    // both fed eight bytes at a time to keep hashing of large weights cheap
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    mLength += size;
+
+    while (size >= sizeof(uint64_t)) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        mH1 = (mH1 ^ w) * 0x100000001b3ULL;
+        mH2 = rotl64(mH2 ^ (w * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+        p += sizeof(w);
+        size -= sizeof(w);
+    }
+    while (size > 0) {
+        mH1 = (mH1 ^ *p) * 0x100000001b3ULL;
+        mH2 = rotl64(mH2 ^ (*p * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+        p++;
+        size--;
+    }
+}
+
+void VpuBlobCache::Hasher::update(const std::string& str)
+{
+    update(static_cast<uint64_t>(str.size()));
+    update(str.data(), str.size());
+}
+
+std::string VpuBlobCache::Hasher::digest() const
+{
+    uint64_t h1 = mH1 ^ mLength;
+    uint64_t h2 = mH2 ^ rotl64(mLength, 17);
+    char str[33];
+    snprintf(str, sizeof(str), "%016llx%016llx",
+             (unsigned long long)h1, (unsigned long long)h2);
+    return str;
+}
+
+VpuBlobCache::VpuBlobCache(const std::string& dir, uint64_t maxBytes)
+    : mDir(dir), mMaxBytes(maxBytes)
+{
+    if (mkdir(mDir.c_str(), 0700) != 0 && errno != EEXIST) {
+        ALOGW("cannot create blob cache directory %s: %s", mDir.c_str(), strerror(errno));
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    trim();
+}
+
+std::string VpuBlobCache::path(const std::string& key) const
+{
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "v%d-", VPU_BLOB_CACHE_VERSION);
+    return mDir + "/" + prefix + key + VPU_BLOB_CACHE_SUFFIX;
+}
+
+std::string VpuBlobCache::tempPath(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", getpid(), mTempCounter++);
+    return mDir + "/" + key + suffix;
+}
+
+bool VpuBlobCache::lookup(const std::string& key)
+{
+    std::string file = path(key);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (access(file.c_str(), R_OK) != 0) {
+        return false;
+    }
+    // the modification time is the LRU timestamp
+    utimes(file.c_str(), nullptr);
+    return true;
+}
+
+bool VpuBlobCache::commit(const std::string& key, const std::string& tempFile)
+{
+    std::string file = path(key);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (rename(tempFile.c_str(), file.c_str()) != 0) {
+        ALOGW("cannot publish blob cache entry %s: %s", file.c_str(), strerror(errno));
+        unlink(tempFile.c_str());
+        return false;
+    }
+    trim();
+    return true;
+}
+
+void VpuBlobCache::remove(const std::string& key)
+{
+    std::string file = path(key);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    unlink(file.c_str());
+}
+
+// True for a file tempPath() named whose writer is gone: its process no
+// longer exists or the file is older than VPU_BLOB_CACHE_TEMP_MAX_AGE_S.
+static bool isStaleTempFile(const std::string& name, const std::string& file)
+{
+    static const char kTempSuffix[] = ".tmp";
+    const size_t suffixLen = strlen(kTempSuffix);
+    if (name.size() <= suffixLen || name.compare(name.size() - suffixLen, suffixLen, kTempSuffix) != 0) {
+        return false;
+    }
+
+    // <key>.<pid>.<counter>.tmp
+    size_t counterDot = name.rfind('.', name.size() - suffixLen - 1);
+    size_t pidDot = counterDot == std::string::npos || counterDot == 0 ? std::string::npos
+                                                                       : name.rfind('.', counterDot - 1);
+    if (pidDot == std::string::npos) {
+        return false;
+    }
+    pid_t pid = static_cast<pid_t>(atoi(name.c_str() + pidDot + 1));
+
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0) {
+        return false;
+    }
+    if (time(nullptr) - st.st_mtime > VPU_BLOB_CACHE_TEMP_MAX_AGE_S) {
+        return true;
+    }
+    return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+// Must be called with mMutex held.
+void VpuBlobCache::trim()
+{
+    struct Entry {
+        std::string file;
+        time_t mtime;
+        uint64_t size;
+    };
+
+    DIR* dir = opendir(mDir.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "v%d-", VPU_BLOB_CACHE_VERSION);
+    const size_t suffixLen = strlen(VPU_BLOB_CACHE_SUFFIX);
+
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    while (struct dirent* ent = readdir(dir)) {
+        std::string name = ent->d_name;
+        if (isStaleTempFile(name, mDir + "/" + name)) {
+            ALOGI("removing %s left by a failed write", name.c_str());
+            unlink((mDir + "/" + name).c_str());
+            continue;
+        }
+        if (name.size() <= suffixLen ||
+            name.compare(name.size() - suffixLen, suffixLen, VPU_BLOB_CACHE_SUFFIX) != 0) {
+            continue;
+        }
+
+        std::string file = mDir + "/" + name;
+        if (name.compare(0, strlen(prefix), prefix) != 0) {
+            ALOGI("evicting %s written by another cache version", name.c_str());
+            unlink(file.c_str());
+            continue;
+        }
+
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0) {
+            continue;
+        }
+        entries.push_back({file, st.st_mtime, static_cast<uint64_t>(st.st_size)});
+        totalBytes += st.st_size;
+    }
+    closedir(dir);
+
+    if (totalBytes <= mMaxBytes) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+    for (const auto& entry : entries) {
+        if (totalBytes <= mMaxBytes) {
+            break;
+        }
+        ALOGI("evicting %s (%llu bytes)", entry.file.c_str(), (unsigned long long)entry.size);
+        unlink(entry.file.c_str());
+        totalBytes -= entry.size;
+    }
+}
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_ML_NN_VPU_BLOBCACHE_H
+#define ANDROID_ML_NN_VPU_BLOBCACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+// Bump when the HAL changes how it converts NNAPI models, so networks
+// compiled by an older HAL are evicted instead of reused.
+#define VPU_BLOB_CACHE_VERSION 1
+
+// A temporary file older than this is left over from a failed or killed
+// write even if its pid is alive again, as no compile takes that long.
+#define VPU_BLOB_CACHE_TEMP_MAX_AGE_S (60 * 60)
+
+// On-disk cache of networks exported by the Myriad plugin, keyed by a hash
+// of the NNAPI model and the plugin configuration. Entries are files in one
+// directory; the directory is trimmed to maxBytes by evicting the least
+// recently used entries, and entries written by another cache version are
+// removed on the first trim, as are temporary files of writes that died.
+class VpuBlobCache {
+public:
+    // 128-bit hash used to build cache keys.
+    class Hasher {
+    public:
+        void update(const void* data, size_t size);
+        template <typename T>
+        void update(const T& value) { update(&value, sizeof(value)); }
+        void update(const std::string& str);
+        std::string digest() const;
+
+    private:
+        uint64_t mH1 = 0xcbf29ce484222325ULL;
+        uint64_t mH2 = 0x9e3779b97f4a7c15ULL;
+        uint64_t mLength = 0;
+    };
+
+    VpuBlobCache(const std::string& dir, uint64_t maxBytes);
+
+    // Returns true if key is cached and marks it as most recently used.
+    bool lookup(const std::string& key);
+
+    // Where the entry for key lives once committed.
+    std::string path(const std::string& key) const;
+
+    // Returns a fresh file name a new entry for key is written to before
+    // commit(), unique even when the same model is prepared concurrently.
+    std::string tempPath(const std::string& key);
+
+    // Publishes tempFile as the entry for key and trims the cache.
+    bool commit(const std::string& key, const std::string& tempFile);
+
+    // Drops an entry, e.g. one the plugin refused to import.
+    void remove(const std::string& key);
+
+private:
+    void trim();
+
+    std::string mDir;
+    uint64_t mMaxBytes;
+    uint32_t mTempCounter = 0;
+    std::mutex mMutex;
+};
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
+
+#endif // ANDROID_ML_NN_VPU_BLOBCACHE_H
@@ -20,6 +20,7 @@
 #include "VpuPreparedModel.h"
 //#include "Utils.h"
 #include <android-base/logging.h>
+#include <cutils/properties.h>
 #include <hidl/LegacySupport.h>
 #include <thread>
 
@@ -30,6 +31,33 @@ namespace neuralnetworks {
 namespace V1_0 {
 namespace vpu_driver {
 
+// Defaults for the execution worker pool; each can be overridden through
+// the matching vendor.vpu.* system property.
+#define VPU_DEFAULT_EXEC_WORKERS      VPU_DEFAULT_INFER_REQUESTS
+#define VPU_DEFAULT_EXEC_QUEUE_DEPTH  64
+#define VPU_DEFAULT_BLOB_CACHE_DIR    "/data/vendor/vpu/blob_cache"
+#define VPU_DEFAULT_BLOB_CACHE_MB     256
+
+VpuDriver::VpuDriver()
+{
+    int workers = property_get_int32("vendor.vpu.exec_workers", VPU_DEFAULT_EXEC_WORKERS);
+    int queueDepth = property_get_int32("vendor.vpu.exec_queue_depth", VPU_DEFAULT_EXEC_QUEUE_DEPTH);
+    // block the caller by default, reject only when explicitly asked to
+    auto policy = property_get_bool("vendor.vpu.exec_reject_when_full", false) ?
+                  VpuWorkerPool::kReject : VpuWorkerPool::kBlock;
+
+    mWorkerPool = std::make_shared<VpuWorkerPool>(workers > 0 ? workers : 1,
+                                                  queueDepth > 0 ? queueDepth : 1, policy);
+
+    // a cache size of 0 disables the blob cache
+    int cacheMb = property_get_int32("vendor.vpu.blob_cache_mb", VPU_DEFAULT_BLOB_CACHE_MB);
+    if (cacheMb > 0) {
+        char cacheDir[PROPERTY_VALUE_MAX];
+        property_get("vendor.vpu.blob_cache_dir", cacheDir, VPU_DEFAULT_BLOB_CACHE_DIR);
+        mBlobCache = std::make_shared<VpuBlobCache>(cacheDir, (uint64_t)cacheMb << 20);
+    }
+}
+
 Return<ErrorStatus> VpuDriver::prepareModel(const Model& model,
                                              const sp<IPreparedModelCallback>& callback)
 {
@@ -47,7 +75,7 @@ Return<ErrorStatus> VpuDriver::prepareModel(const Model& model,
     }
 
     // TODO: make asynchronous later
-    sp<VpuPreparedModel> preparedModel = new VpuPreparedModel(model);
+    sp<VpuPreparedModel> preparedModel = new VpuPreparedModel(model, mWorkerPool, mBlobCache);
     if (!preparedModel->initialize()) {
         ALOGI("failed to initialize preparedmodel");
         callback->notify(ErrorStatus::GENERAL_FAILURE, nullptr);
@@ -123,9 +151,13 @@ Return<void> VpuDriver::getSupportedOperations(const Model& model,
         return Void();
     }
 
+    // operations the Myriad lacks are run by the CPU plugin in the same
+    // prepared model, so they are reported as supported too
+    bool cpuFallback = VpuPreparedModel::cpuFallbackEnabled();
     for (int i = 0; i < count; i++) {
         const auto& operation = model.operations[i];
-        supported[i] = VpuPreparedModel::isOperationSupported(operation, model);
+        supported[i] = VpuPreparedModel::isOperationSupported(operation, model) ||
+                       (cpuFallback && VpuPreparedModel::isOperationSupportedOnCpu(operation, model));
     }
 
     cb(ErrorStatus::NONE, supported);
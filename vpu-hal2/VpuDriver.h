@@ -22,7 +22,10 @@
 #include <android/hardware/neuralnetworks/1.0/IDevice.h>
 #include <android/hardware/neuralnetworks/1.0/IPreparedModel.h>
 #include <hardware/hardware.h>
+#include <memory>
 #include <string>
+#include "VpuBlobCache.h"
+#include "VpuWorkerPool.h"
 
 namespace android {
 namespace hardware {
@@ -39,7 +42,7 @@ using ::android::hardware::neuralnetworks::V1_0::IDevice;
 // on the CPU.  An actual driver would not do that.
 class VpuDriver : public IDevice {
 public:
-    VpuDriver() {}
+    VpuDriver();
 //    VpuDriver(const char* name) : mName(name) {}
 
   ~VpuDriver() override {}
@@ -53,6 +56,11 @@ public:
 //    int run();
 //protected:
 //    std::string mName;
+private:
+    // executes requests for every prepared model created by this driver
+    std::shared_ptr<VpuWorkerPool> mWorkerPool;
+    // compiled networks reused across prepareModel calls, null if disabled
+    std::shared_ptr<VpuBlobCache> mBlobCache;
 };
 
 
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VpuPartitioner"
+
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <algorithm>
+#include "VpuPartitioner.h"
+
+using InferenceEngine::TargetDevice;
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+static double numberOfElements(const hidl_vec<uint32_t>& dims)
+{
+    double count = 1;
+    for (auto d : dims) count *= d;
+    return count;
+}
+
+static int32_t getConstInt32(const Model& model, uint32_t index, int32_t defaultValue)
+{
+    const Operand& operand = model.operands[index];
+    if (operand.lifetime != OperandLifeTime::CONSTANT_COPY ||
+        operand.location.length < sizeof(int32_t)) {
+        return defaultValue;
+    }
+    return *reinterpret_cast<const int32_t*>(&model.operandValues[operand.location.offset]);
+}
+
+// Only tensors flowing between operations can cross the link; constants
+// are compiled into the network of the subgraph that reads them.
+static bool isActivation(const Operand& operand)
+{
+    return operand.lifetime == OperandLifeTime::TEMPORARY_VARIABLE ||
+           operand.lifetime == OperandLifeTime::MODEL_INPUT ||
+           operand.lifetime == OperandLifeTime::MODEL_OUTPUT;
+}
+
+// Rough number of floating point operations, counting a multiply-add as two.
+static double operationFlops(const Model& model, const Operation& operation)
+{
+    const hidl_vec<uint32_t>& ins = operation.inputs;
+    double outputs = numberOfElements(model.operands[operation.outputs[0]].dimensions);
+
+    switch (operation.type) {
+        case OperationType::CONV_2D: {
+            // filter is [depth_out, height, width, depth_in]
+            const auto& filter = model.operands[ins[1]].dimensions;
+            return filter.size() == 4 ? 2 * outputs * filter[1] * filter[2] * filter[3] : outputs;
+        }
+        case OperationType::DEPTHWISE_CONV_2D: {
+            // filter is [1, height, width, depth_out]
+            const auto& filter = model.operands[ins[1]].dimensions;
+            return filter.size() == 4 ? 2 * outputs * filter[1] * filter[2] : outputs;
+        }
+        case OperationType::FULLY_CONNECTED: {
+            // weights are [num_units, input_size]
+            const auto& weights = model.operands[ins[1]].dimensions;
+            return weights.size() == 2 ? 2 * outputs * weights[1] : outputs;
+        }
+        case OperationType::AVERAGE_POOL_2D:
+        case OperationType::MAX_POOL_2D:
+        case OperationType::L2_POOL_2D: {
+            // filter width and height precede the activation in both the
+            // explicit and the implicit padding signatures
+            size_t n = ins.size();
+            return outputs * getConstInt32(model, ins[n - 3], 3) * getConstInt32(model, ins[n - 2], 3);
+        }
+        case OperationType::LOCAL_RESPONSE_NORMALIZATION:
+            return outputs * (2 * getConstInt32(model, ins[1], 2) + 1);
+        default:
+            return outputs;
+    }
+}
+
+VpuCostModel VpuCostModel::fromProperties()
+{
+    VpuCostModel cost;
+    cost.vpuGflops = property_get_int32("vendor.vpu.cost.vpu_gflops", VPU_DEFAULT_COST_VPU_GFLOPS);
+    cost.cpuGflops = property_get_int32("vendor.vpu.cost.cpu_gflops", VPU_DEFAULT_COST_CPU_GFLOPS);
+    cost.usbMBps = property_get_int32("vendor.vpu.cost.usb_mbps", VPU_DEFAULT_COST_USB_MBPS);
+    cost.transferUs = property_get_int32("vendor.vpu.cost.transfer_us", VPU_DEFAULT_COST_TRANSFER_US);
+    cost.vpuDispatchUs = property_get_int32("vendor.vpu.cost.vpu_dispatch_us",
+                                            VPU_DEFAULT_COST_VPU_DISPATCH_US);
+    cost.cpuDispatchUs = property_get_int32("vendor.vpu.cost.cpu_dispatch_us",
+                                            VPU_DEFAULT_COST_CPU_DISPATCH_US);
+
+    cost.vpuGflops = std::max(cost.vpuGflops, 0.001);
+    cost.cpuGflops = std::max(cost.cpuGflops, 0.001);
+    cost.usbMBps = std::max(cost.usbMBps, 0.001);
+    return cost;
+}
+
+double VpuCostModel::operationUs(const Model& model, const Operation& operation,
+                                 TargetDevice device) const
+{
+    double gflops = device == TargetDevice::eMYRIAD ? vpuGflops : cpuGflops;
+    return operationFlops(model, operation) / (gflops * 1e3);
+}
+
+double VpuCostModel::transferUsOf(const Operand& operand) const
+{
+    // tensors cross the link in fp16, and 1 MB/s moves one byte per us
+    return transferUs + numberOfElements(operand.dimensions) * 2 / usbMBps;
+}
+
+namespace {
+
+class Partition {
+public:
+    Partition(const Model& model, const VpuCostModel& cost) : mModel(model), mCost(cost)
+    {
+        const size_t operandCount = model.operands.size();
+        mProducer.assign(operandCount, -1);
+        mConsumers.resize(operandCount);
+        for (size_t i = 0; i < model.operations.size(); i++) {
+            for (auto o : model.operations[i].outputs) mProducer[o] = i;
+            for (auto in : model.operations[i].inputs) {
+                auto& consumers = mConsumers[in];
+                if (consumers.empty() || consumers.back() != i) consumers.push_back(i);
+            }
+        }
+    }
+
+    // Estimated latency of one inference with the given placement.
+    double cost(const std::vector<TargetDevice>& devices) const
+    {
+        double us = 0;
+        for (size_t i = 0; i < devices.size(); i++) {
+            us += mCost.operationUs(mModel, mModel.operations[i], devices[i]);
+        }
+
+        for (size_t t = 0; t < mModel.operands.size(); t++) {
+            const Operand& operand = mModel.operands[t];
+            if (!isActivation(operand)) continue;
+
+            // the client reads and writes model tensors on the host
+            TargetDevice from = mProducer[t] < 0 ? TargetDevice::eCPU : devices[mProducer[t]];
+            bool toVpu = false;
+            bool toCpu = operand.lifetime == OperandLifeTime::MODEL_OUTPUT;
+            for (auto c : mConsumers[t]) {
+                (devices[c] == TargetDevice::eMYRIAD ? toVpu : toCpu) = true;
+            }
+            if ((from == TargetDevice::eCPU && toVpu) || (from == TargetDevice::eMYRIAD && toCpu)) {
+                us += mCost.transferUsOf(operand);
+            }
+        }
+
+        for (auto& run : runs(devices)) {
+            us += devices[run.first] == TargetDevice::eMYRIAD ? mCost.vpuDispatchUs
+                                                               : mCost.cpuDispatchUs;
+        }
+        return us;
+    }
+
+    // [begin, end) ranges of consecutive operations placed on the same device
+    static std::vector<std::pair<size_t, size_t>> runs(const std::vector<TargetDevice>& devices)
+    {
+        std::vector<std::pair<size_t, size_t>> result;
+        for (size_t i = 0; i < devices.size(); i++) {
+            if (result.empty() || devices[result.back().first] != devices[i]) {
+                result.push_back({i, i});
+            }
+            result.back().second = i + 1;
+        }
+        return result;
+    }
+
+    VpuSubgraphInfo subgraph(TargetDevice device, size_t begin, size_t end) const
+    {
+        VpuSubgraphInfo info;
+        info.device = device;
+        auto inRun = [begin, end](int op) { return op >= (int)begin && op < (int)end; };
+
+        for (size_t i = begin; i < end; i++) {
+            const Operation& operation = mModel.operations[i];
+            info.operations.push_back(i);
+            for (auto in : operation.inputs) {
+                if (!isActivation(mModel.operands[in]) || inRun(mProducer[in])) continue;
+                if (std::find(info.inputs.begin(), info.inputs.end(), in) == info.inputs.end()) {
+                    info.inputs.push_back(in);
+                }
+            }
+            for (auto o : operation.outputs) {
+                bool readOutside = mModel.operands[o].lifetime == OperandLifeTime::MODEL_OUTPUT;
+                for (auto c : mConsumers[o]) readOutside |= !inRun(c);
+                if (readOutside) info.outputs.push_back(o);
+            }
+        }
+        return info;
+    }
+
+private:
+    const Model& mModel;
+    const VpuCostModel& mCost;
+    std::vector<int> mProducer;                  // operation writing each operand, -1 if none
+    std::vector<std::vector<size_t>> mConsumers; // operations reading each operand
+};
+
+}  // namespace
+
+std::vector<VpuSubgraphInfo> partitionModel(const Model& model,
+                                            const std::vector<bool>& vpuSupported,
+                                            const std::vector<bool>& cpuSupported,
+                                            const VpuCostModel& cost)
+{
+    const size_t count = model.operations.size();
+    std::vector<TargetDevice> devices(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!vpuSupported[i] && !cpuSupported[i]) {
+            ALOGI("operation %zu (type %d) is supported by no device", i, (int)model.operations[i].type);
+            return {};
+        }
+        devices[i] = vpuSupported[i] ? TargetDevice::eMYRIAD : TargetDevice::eCPU;
+    }
+
+    Partition partition(model, cost);
+    double best = partition.cost(devices);
+
+    // Move the single subgraph that gains the most to the other device until
+    // no move helps. Every move strictly lowers the estimate, so this ends.
+    for (;;) {
+        std::vector<TargetDevice> bestDevices;
+        for (auto& run : Partition::runs(devices)) {
+            TargetDevice other = devices[run.first] == TargetDevice::eMYRIAD ? TargetDevice::eCPU
+                                                                            : TargetDevice::eMYRIAD;
+            const std::vector<bool>& supported = other == TargetDevice::eMYRIAD ? vpuSupported
+                                                                               : cpuSupported;
+            bool movable = true;
+            for (size_t i = run.first; i < run.second; i++) movable &= supported[i];
+            if (!movable) continue;
+
+            std::vector<TargetDevice> candidate = devices;
+            std::fill(candidate.begin() + run.first, candidate.begin() + run.second, other);
+            double us = partition.cost(candidate);
+            if (us < best) {
+                best = us;
+                bestDevices = std::move(candidate);
+            }
+        }
+        if (bestDevices.empty()) break;
+        devices = std::move(bestDevices);
+    }
+
+    std::vector<VpuSubgraphInfo> subgraphs;
+    for (auto& run : Partition::runs(devices)) {
+        subgraphs.push_back(partition.subgraph(devices[run.first], run.first, run.second));
+        ALOGI("subgraph %zu: operations [%zu, %zu) on %s, %zu inputs, %zu outputs",
+              subgraphs.size() - 1, run.first, run.second,
+              devices[run.first] == TargetDevice::eMYRIAD ? "MYRIAD" : "CPU",
+              subgraphs.back().inputs.size(), subgraphs.back().outputs.size());
+    }
+    ALOGI("model partitioned into %zu subgraphs, estimated %.0f us per inference",
+          subgraphs.size(), best);
+    return subgraphs;
+}
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_ML_NN_VPU_PARTITIONER_H
+#define ANDROID_ML_NN_VPU_PARTITIONER_H
+
+#include <android/hardware/neuralnetworks/1.0/types.h>
+#include <ie_device.hpp>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+// Defaults for the partition cost model; each can be overridden through
+// the matching vendor.vpu.cost.* system property.
+#define VPU_DEFAULT_COST_VPU_GFLOPS      20
+#define VPU_DEFAULT_COST_CPU_GFLOPS      10
+#define VPU_DEFAULT_COST_USB_MBPS        300
+#define VPU_DEFAULT_COST_TRANSFER_US     250
+#define VPU_DEFAULT_COST_VPU_DISPATCH_US 1500
+#define VPU_DEFAULT_COST_CPU_DISPATCH_US 100
+
+// Estimates, in microseconds, how long operations take on each device and
+// how long a tensor takes to cross the USB link between host and stick.
+struct VpuCostModel {
+    double vpuGflops;
+    double cpuGflops;
+    double usbMBps;
+    double transferUs;      // fixed cost of every tensor crossing the link
+    double vpuDispatchUs;   // fixed cost of every subgraph run on each device
+    double cpuDispatchUs;
+
+    static VpuCostModel fromProperties();
+
+    double operationUs(const Model& model, const Operation& operation,
+                       InferenceEngine::TargetDevice device) const;
+    double transferUsOf(const Operand& operand) const;
+};
+
+// A run of model operations executed by one network on one device.
+// Operations keep the model order, which NNAPI guarantees is topological,
+// so the subgraphs of a partition run one after the other.
+struct VpuSubgraphInfo {
+    InferenceEngine::TargetDevice device;
+    std::vector<uint32_t> operations;
+    // tensors read by the subgraph but produced by the client or an
+    // earlier subgraph
+    std::vector<uint32_t> inputs;
+    // tensors produced by the subgraph and read by the client or a later
+    // subgraph
+    std::vector<uint32_t> outputs;
+};
+
+// Assigns every operation to the Myriad or to the CPU and groups them into
+// subgraphs. Operations start on the Myriad wherever it supports them; then
+// whole subgraphs are moved between devices as long as that lowers the
+// estimated latency, so a few supported operations between CPU subgraphs
+// are not worth two round trips over USB. Returns an empty partition if
+// some operation runs on neither device.
+std::vector<VpuSubgraphInfo> partitionModel(const Model& model,
+                                            const std::vector<bool>& vpuSupported,
+                                            const std::vector<bool>& cpuSupported,
+                                            const VpuCostModel& cost);
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
+
+#endif // ANDROID_ML_NN_VPU_PARTITIONER_H
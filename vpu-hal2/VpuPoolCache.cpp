@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VpuPoolCache"
+
+#include <cutils/log.h>
+#include <hidlmemory/mapping.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "VpuPoolCache.h"
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+static size_t getSizeFromInts(int lower, int higher)
+{
+    return (uint32_t)(lower) + ((uint64_t)(uint32_t)(higher) << 32);
+}
+
+// Fills key with the identity of pool. Returns false if the pool cannot
+// be told apart from other pools and therefore must not be cached.
+static bool getPoolKey(const hidl_memory& pool, VpuPoolMapping::Key* key)
+{
+    const native_handle_t* handle = pool.handle();
+    if (handle == nullptr || handle->numFds < 1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(handle->data[0], &st) != 0 || S_ISCHR(st.st_mode)) {
+        return false;
+    }
+
+    key->dev = st.st_dev;
+    key->ino = st.st_ino;
+    key->size = pool.size();
+    if (pool.name() == "mmap_fd") {
+        key->prot = handle->data[1];
+        key->offset = getSizeFromInts(handle->data[2], handle->data[3]);
+    } else {
+        key->prot = PROT_READ | PROT_WRITE;
+        key->offset = 0;
+    }
+    return true;
+}
+
+static bool mapPool(const hidl_memory& pool, VpuPoolMapping* mapping)
+{
+    auto memType = pool.name();
+    if (memType == "ashmem") {
+        mapping->memory = mapMemory(pool);
+        if (mapping->memory == nullptr) {
+            ALOGE("Can't map shared memory.");
+            return false;
+        }
+        mapping->memory->update();
+        mapping->buffer = reinterpret_cast<uint8_t*>(static_cast<void*>(mapping->memory->getPointer()));
+        if (mapping->buffer == nullptr) {
+            ALOGE("Can't access shared memory.");
+            mapping->memory = nullptr;
+            return false;
+        }
+        mapping->size = pool.size();
+        return true;
+    } else if (memType == "mmap_fd") {
+        size_t size = pool.size();
+        int fd = pool.handle()->data[0];
+        int prot = pool.handle()->data[1];
+        size_t offset = getSizeFromInts(pool.handle()->data[2], pool.handle()->data[3]);
+        void* buffer = mmap(nullptr, size, prot, MAP_SHARED, fd, offset);
+        if (buffer == MAP_FAILED) {
+            ALOGE("Can't mmap the file descriptor: %s", strerror(errno));
+            return false;
+        }
+        mapping->buffer = static_cast<uint8_t*>(buffer);
+        mapping->size = size;
+        mapping->prot = prot;
+        return true;
+    } else {
+        ALOGE("unsupported hidl_memory type %s", memType.c_str());
+        return false;
+    }
+}
+
+static void unmapPool(VpuPoolMapping* mapping)
+{
+    if (mapping->memory == nullptr) {
+        munmap(mapping->buffer, mapping->size);
+    }
+    delete mapping;
+}
+
+bool VpuPoolMapping::flush(size_t offset, size_t length)
+{
+    if (memory != nullptr) {
+        memory->commit();
+        return true;
+    }
+    if (!(prot & PROT_WRITE) || length == 0) {
+        return true;
+    }
+
+    // msync needs a page aligned start; the pool itself starts on a page
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset & ~(pageSize - 1);
+    if (msync(buffer + start, offset + length - start, MS_SYNC) != 0) {
+        ALOGE("msync of [%zu, %zu) failed: %s", offset, offset + length, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+VpuPoolCache::VpuPoolCache(size_t maxEntries)
+    : mMaxEntries(maxEntries)
+{
+}
+
+VpuPoolCache::~VpuPoolCache()
+{
+    ALOGI("request pool mappings: %llu reused, %llu mapped",
+          (unsigned long long)mHits, (unsigned long long)mMisses);
+
+    for (auto mapping : mEntries) {
+        if (mapping->refs != 0) {
+            ALOGW("unmapping a pool still used by %u requests", mapping->refs);
+        }
+        unmapPool(mapping);
+    }
+}
+
+bool VpuPoolCache::acquire(const hidl_vec<hidl_memory>& pools, std::vector<VpuPoolMapping*>* mappings)
+{
+    mappings->clear();
+    mappings->reserve(pools.size());
+    for (size_t i = 0; i < pools.size(); i++) {
+        VpuPoolMapping* mapping = acquire(pools[i]);
+        if (mapping == nullptr) {
+            ALOGE("Could not map pool %zu", i);
+            release(*mappings);
+            mappings->clear();
+            return false;
+        }
+        mappings->push_back(mapping);
+    }
+    return true;
+}
+
+void VpuPoolCache::release(const std::vector<VpuPoolMapping*>& mappings)
+{
+    for (auto mapping : mappings) {
+        release(mapping);
+    }
+}
+
+VpuPoolMapping* VpuPoolCache::acquire(const hidl_memory& pool)
+{
+    VpuPoolMapping::Key key = {};
+    bool cacheable = getPoolKey(pool, &key);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (cacheable) {
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            if ((*it)->key == key) {
+                VpuPoolMapping* mapping = *it;
+                mEntries.splice(mEntries.begin(), mEntries, it);
+                mapping->refs++;
+                mHits++;
+                return mapping;
+            }
+        }
+    }
+
+    VpuPoolMapping* mapping = new VpuPoolMapping();
+    mapping->key = key;
+    mapping->cached = cacheable;
+    mapping->buffer = nullptr;
+    mapping->size = 0;
+    mapping->prot = 0;
+    mapping->refs = 1;
+    if (!mapPool(pool, mapping)) {
+        delete mapping;
+        return nullptr;
+    }
+    mMisses++;
+
+    if (cacheable) {
+        mEntries.push_front(mapping);
+        trim();
+    }
+    return mapping;
+}
+
+void VpuPoolCache::release(VpuPoolMapping* mapping)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mapping->refs--;
+    if (!mapping->cached) {
+        if (mapping->refs == 0) {
+            unmapPool(mapping);
+        }
+        return;
+    }
+    trim();
+}
+
+// Must be called with mMutex held. Mappings in use are never dropped, so
+// the cache may exceed mMaxEntries while more pools than that are busy.
+void VpuPoolCache::trim()
+{
+    auto it = mEntries.end();
+    while (mEntries.size() > mMaxEntries && it != mEntries.begin()) {
+        --it;
+        if ((*it)->refs == 0) {
+            unmapPool(*it);
+            it = mEntries.erase(it);
+        }
+    }
+}
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_ML_NN_VPU_POOLCACHE_H
+#define ANDROID_ML_NN_VPU_POOLCACHE_H
+
+#include <android/hidl/memory/1.0/IMemory.h>
+#include <hidl/HidlSupport.h>
+#include <sys/types.h>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+// Default number of idle request pool mappings kept per prepared model.
+#define VPU_DEFAULT_POOL_CACHE_ENTRIES 16
+
+// A request memory pool mapped into the driver. Handed out by VpuPoolCache
+// and valid until released.
+struct VpuPoolMapping {
+    // Identity of the pool. HIDL gives every request its own fd, so the
+    // open file is identified by device and inode instead of fd number.
+    struct Key {
+        dev_t dev;
+        ino_t ino;
+        uint64_t offset;
+        uint64_t size;
+        int prot;
+
+        bool operator==(const Key& other) const {
+            return dev == other.dev && ino == other.ino && offset == other.offset &&
+                   size == other.size && prot == other.prot;
+        }
+    };
+
+    Key key;
+    bool cached;
+    sp<hidl::memory::V1_0::IMemory> memory;  // ashmem pools
+    uint8_t* buffer;                        // start of the pool
+    size_t size;
+    int prot;                               // mmap_fd pools
+    uint32_t refs;
+
+    // Makes [offset, offset + length) written by the device visible to the
+    // client. Only mmap_fd pools can be synced by range; ashmem pools are
+    // committed as a whole.
+    bool flush(size_t offset, size_t length);
+};
+
+// Per prepared model cache of request pool mappings. Clients reuse the same
+// pools for many requests, so mappings are refcounted and kept after the
+// request completes; the least recently used idle mappings are unmapped once
+// more than maxEntries are held. Pools whose identity cannot be established
+// (e.g. legacy /dev/ashmem, where every region shares one inode) are mapped
+// per request and unmapped on release.
+class VpuPoolCache {
+public:
+    explicit VpuPoolCache(size_t maxEntries);
+    ~VpuPoolCache();
+
+    // Maps every pool of a request. On failure nothing stays acquired.
+    bool acquire(const hidl_vec<hidl_memory>& pools, std::vector<VpuPoolMapping*>* mappings);
+    void release(const std::vector<VpuPoolMapping*>& mappings);
+
+private:
+    VpuPoolMapping* acquire(const hidl_memory& pool);
+    void release(VpuPoolMapping* mapping);
+    void trim();
+
+    size_t mMaxEntries;
+    // most recently used first
+    std::list<VpuPoolMapping*> mEntries;
+    uint64_t mHits = 0;
+    uint64_t mMisses = 0;
+    std::mutex mMutex;
+};
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
+
+#endif // ANDROID_ML_NN_VPU_POOLCACHE_H
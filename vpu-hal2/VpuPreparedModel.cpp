@@ -19,9 +19,12 @@
 
 #include <android-base/logging.h>
 #include <cutils/log.h>
+#include <cutils/properties.h>
+#include <unistd.h>
 #include <thread>
 #include "VpuPreparedModel.h"
 #include "vpu_plugin.hpp"
+#include "precision_utils.h"
 #include <fstream>
 
 #define DISABLE_ALL_QUANT
@@ -203,142 +206,6 @@ std::vector<uint32_t>& shapeToDims(const TensorDims& shape, Layout layout)
 }
 
 
-// Function to convert F32 into F16
-// F32: exp_bias:127 SEEEEEEE EMMMMMMM MMMMMMMM MMMMMMMM.
-// F16: exp_bias:15  SEEEEEMM MMMMMMMM
-#define EXP_MASK_F32 	 0x7F800000U
-#define EXP_MASK_F16     0x7C00U
-
-
-// small helper function to represent uint32_t value as float32
-float asfloat(uint32_t v) {
-    return *reinterpret_cast<float *>(&v);
-}
-
-// Function to convert F32 into F16
-float f16tof32(short x) {
-    // this is storage for output result
-    uint32_t u = x;
-
-    // get sign in 32bit format
-    uint32_t s = ((u & 0x8000) << 16);
-
-    // check for NAN and INF
-    if ((u & EXP_MASK_F16) == EXP_MASK_F16) {
-        // keep mantissa only
-        u &= 0x03FF;
-
-        // check if it is NAN and raise 10 bit to be align with intrin
-        if (u) {
-            u |= 0x0200;
-        }
-
-        u <<= (23 - 10);
-        u |= EXP_MASK_F32;
-        u |= s;
-    } else if ((x & EXP_MASK_F16) == 0) {  // check for zero and denormals. both are converted to zero
-        u = s;
-    } else {
-        // abs
-        u = (u & 0x7FFF);
-
-        // shift mantissa and exp from f16 to f32 position
-        u <<= (23 - 10);
-
-        // new bias for exp (f16 bias is 15 and f32 bias is 127)
-        u += ((127 - 15) << 23);
-
-        // add sign
-        u |= s;
-    }
-
-    // finaly represent result as float and return
-    return *reinterpret_cast<float *>(&u);
-}
-
-// This function convert f32 to f16 with rounding to nearest value to minimize error
-// the denormal values are converted to 0.
-short f32tof16(float x) {
-    // create minimal positive normal f16 value in f32 format
-    // exp:-14,mantissa:0 -> 2^-14 * 1.0
-    static float min16 = asfloat((127 - 14) << 23);
-
-    // create maximal positive normal f16 value in f32 and f16 formats
-    // exp:15,mantissa:11111 -> 2^15 * 1.(11111)
-    static float max16 = asfloat(((127 + 15) << 23) | 0x007FE000);
-    static uint32_t max16f16 = ((15 + 15) << 10) | 0x3FF;
-
-    // define and declare variable for intermidiate and output result
-    // the union is used to simplify representation changing
-    union {
-        float f;
-        uint32_t u;
-    } v;
-    v.f = x;
-
-    // get sign in 16bit format
-    uint32_t s = (v.u >> 16) & 0x8000;  // sign 16:  00000000 00000000 10000000 00000000
-
-    // make it abs
-    v.u &= 0x7FFFFFFF;  // abs mask: 01111111 11111111 11111111 11111111
-
-    // check NAN and INF
-    if ((v.u & EXP_MASK_F32) == EXP_MASK_F32) {
-        if (v.u & 0x007FFFFF) {
-            return s | (v.u >> (23 - 10)) | 0x0200;  // return NAN f16
-        } else {
-            return s | (v.u >> (23 - 10));  // return INF f16
-        }
-    }
-
-    // to make f32 round to nearest f16
-    // create halfULP for f16 and add it to origin value
-    float halfULP = asfloat(v.u & EXP_MASK_F32) * asfloat((127 - 11) << 23);
-    v.f += halfULP;
-
-    // if input value is not fit normalized f16 then return 0
-    // denormals are not covered by this code and just converted to 0
-    if (v.f < min16 * 0.5F) {
-        return s;
-    }
-
-    // if input value between min16/2 and min16 then return min16
-    if (v.f < min16) {
-        return s | (1 << 10);
-    }
-
-    // if input value more than maximal allowed value for f16
-    // then return this maximal value
-    if (v.f >= max16) {
-        return max16f16 | s;
-    }
-
-    // change exp bias from 127 to 15
-    v.u -= ((127 - 15) << 23);
-
-    // round to f16
-    v.u >>= (23 - 10);
-
-    return v.u | s;
-}
-
-void f16tof32Arrays(float *dst, const short *src, uint32_t& nelem, float scale = 1, float bias = 0) {
-    VLOG(L1, "convert f16tof32Arrays...\n");
-    const short *_src = reinterpret_cast<const short *>(src);
-
-    for (uint32_t i = 0; i < nelem; i++) {
-        dst[i] = f16tof32(_src[i]) * scale + bias;
-    }
-}
-
-void f32tof16Arrays(short *dst, const float *src, uint32_t& nelem, float scale = 1, float bias = 0) {
-    VLOG(L1, "convert f32tof16Arrays...");
-    for (uint32_t i = 0; i < nelem; i++) {
-        dst[i] = f32tof16(src[i] * scale + bias);
-        //VLOG(L1, "element no: %d", i);
-    }
-}
-
 int sizeOfData(OperandType type, std::vector<uint32_t> dims)
 {
     int size;
@@ -670,7 +537,7 @@ IRBlob::Ptr VpuPreparedModel::GetConstOperandAsTensor(uint32_t index)
     nnAssert(true);
     }
 
-    f32tof16Arrays(fp16Array, (float *)buf, nelem);
+    PrecisionUtils::f32tof16Arrays(fp16Array, (float *)buf, nelem);
 		return blob;
 
 #else //FP32 support
@@ -763,7 +630,7 @@ Blob::Ptr VpuPreparedModel::GetInOutOperandAsBlob(RunTimeOperandInfo& op, const
     VLOG(L1, "Request model input buffer is null pointer");
     }
 
-    f32tof16Arrays(fp16Array, (float *)buf, nelem);
+    PrecisionUtils::f32tof16Arrays(fp16Array, (float *)buf, nelem);
 
     return blob;
     }
@@ -784,7 +651,7 @@ Blob::Ptr VpuPreparedModel::GetInOutOperandAsBlob(RunTimeOperandInfo& op, const
       VLOG(L1, "Model buffer len = %d bytes length= %d bytes fp16Array= %d bytes\n",len , length, sizeof(fp16Array));
       nnAssert(true);
       }
-      f16tof32Arrays((float *)buf, fp16Array,length);
+      PrecisionUtils::f16tof32Arrays((float *)buf, fp16Array, length);
 
       return blob;
     }
@@ -827,7 +694,7 @@ OutputPort VpuPreparedModel::getPort(int index)
           else if (op.dimensions.size() == 2) order = {0, 1};
           else order = {0}; //(op.dimensions.size() < 2)
 
-          auto operandInfo = mNet.createInput(operandName.str(), permuteDims(toDims(op.dimensions), order)); // NHWC -> NCHW
+          auto operandInfo = mNet->createInput(operandName.str(), permuteDims(toDims(op.dimensions), order)); // NHWC -> NCHW
           mPorts[index] = operandInfo->getInputData();
           //mPorts[index]->setLayout(NHWC); // mPorts[i]->name
           //mPorts[index]->setPrecision(InferenceEngine::Precision::FP16);
@@ -1156,12 +1023,21 @@ bool VpuPreparedModel::initialize()
     bool success = false;
 
     //Check operation supoorted or not, user may not call getOpertionSupported()
-    for (const auto& operation : mModel.operations) {
-        success = isOperationSupported(operation, mModel);
-        if (!success) {
-            VLOG(L1, "get unsupported operation in initialize()");
-            return false;
-        }
+    const size_t count = mModel.operations.size();
+    const bool cpuFallback = cpuFallbackEnabled();
+    std::vector<bool> vpuSupported(count), cpuSupported(count);
+    for (size_t i = 0; i < count; i++) {
+        vpuSupported[i] = isOperationSupported(mModel.operations[i], mModel);
+        cpuSupported[i] = cpuFallback && isOperationSupportedOnCpu(mModel.operations[i], mModel);
+    }
+
+    // operations the Myriad lacks run on the CPU plugin instead of failing
+    // the whole model
+    auto partition = partitionModel(mModel, vpuSupported, cpuSupported,
+                                    VpuCostModel::fromProperties());
+    if (partition.empty()) {
+        VLOG(L1, "get unsupported operation in initialize()");
+        return false;
     }
 
     success = setRunTimePoolInfosFromHidlMemories(&mPoolInfos, mModel.pools);
@@ -1178,100 +1054,221 @@ bool VpuPreparedModel::initialize()
         return false;
     }
 
+    mPoolCache.reset(new VpuPoolCache(
+            property_get_int32("vendor.vpu.pool_cache_entries", VPU_DEFAULT_POOL_CACHE_ENTRIES)));
 
-    for (const auto& operation : mModel.operations) {
-        VLOG(L1, "get operation %d ready to add", operation.type);
-       switch (operation.type) {
-            case OperationType::CONV_2D:
-              success = operationConv2D(operation);
-              break;
-            case OperationType::DEPTHWISE_CONV_2D:
-                success = operationDepthwiseConv2D(operation);
-                break;
-            case OperationType::MAX_POOL_2D:
-                success = operationMaxPool2D(operation);
-                break;
-            case OperationType::AVERAGE_POOL_2D:
-                success = operationAveragePool2D(operation);
-                break;
-            case OperationType::RELU:
-                success = operationRELU(operation);
-                break;
-            case OperationType::RELU1:
-                success = operationRELU1(operation);
-                break;
-            case OperationType::RELU6:
-                success = operationRELU6(operation);
-                break;
-            case OperationType::LOGISTIC:
-                success = operationLogisticSigmoid(operation);
-                break;
-            case OperationType::TANH:
-                success = operationTANH(operation);
-                break;
-            case OperationType::CONCATENATION:
-                success = operationConCat(operation);
-                break;
-            case OperationType::SOFTMAX:
-                success = operationSoftmax(operation);
-                break;
-            case OperationType::LOCAL_RESPONSE_NORMALIZATION:
-                success = operationLRN(operation);
-                break;
-            case OperationType::FULLY_CONNECTED:
-                success = operationFullyConnected(operation);
-                break;
-            case OperationType::L2_NORMALIZATION:
-                success = operationL2Normalization(operation);
-                break;
-            case OperationType::RESHAPE:
-                success = operationReshape(operation);
-                break;
-/*            case OperationType::ADD:
-                success = operationAdd(operation);
-                break;*/
-            default:
-                VLOG(L1, "unsupported operation %d", operation.type);
-                return false;
+    size_t numRequests = property_get_int32("vendor.vpu.infer_requests", VPU_DEFAULT_INFER_REQUESTS);
+    mSubgraphs.resize(partition.size());
+    for (size_t i = 0; i < partition.size(); i++) {
+        VpuSubgraph& subgraph = mSubgraphs[i];
+        subgraph.info = partition[i];
+        if (!buildSubgraph(subgraph, i)) {
+            return false;
         }
-        if (success == false) {
-                VLOG(L1, "failed to convert operation %d", operation.type);
-                return false;
+
+        // a missing CPU plugin must fail the model, not the service
+        try {
+            VLOG(L1, "initialize ExecuteNetwork");
+            subgraph.engine.reset(new ExecuteNetwork(*subgraph.net, subgraph.info.device));
+            loadNetwork(subgraph, numRequests);
+        } catch (const std::exception& ex) {
+            ALOGE("failed to load subgraph %zu: %s", i, ex.what());
+            return false;
+        }
+    }
+    mNet = nullptr;
+
+    return true;
+}
+
+bool VpuPreparedModel::convertOperation(const Operation& operation)
+{
+    VLOG(L1, "get operation %d ready to add", operation.type);
+    switch (operation.type) {
+        case OperationType::ADD:
+            return operationAdd(operation);
+        case OperationType::CONV_2D:
+            return operationConv2D(operation);
+        case OperationType::DEPTHWISE_CONV_2D:
+            return operationDepthwiseConv2D(operation);
+        case OperationType::MAX_POOL_2D:
+            return operationMaxPool2D(operation);
+        case OperationType::AVERAGE_POOL_2D:
+            return operationAveragePool2D(operation);
+        case OperationType::MUL:
+            return operationMUL(operation);
+        case OperationType::RELU:
+            return operationRELU(operation);
+        case OperationType::RELU1:
+            return operationRELU1(operation);
+        case OperationType::RELU6:
+            return operationRELU6(operation);
+        case OperationType::LOGISTIC:
+            return operationLogisticSigmoid(operation);
+        case OperationType::TANH:
+            return operationTANH(operation);
+        case OperationType::CONCATENATION:
+            return operationConCat(operation);
+        case OperationType::SOFTMAX:
+            return operationSoftmax(operation);
+        case OperationType::LOCAL_RESPONSE_NORMALIZATION:
+            return operationLRN(operation);
+        case OperationType::FULLY_CONNECTED:
+            return operationFullyConnected(operation);
+        case OperationType::L2_NORMALIZATION:
+            return operationL2Normalization(operation);
+        case OperationType::RESHAPE:
+            return operationReshape(operation);
+        default:
+            VLOG(L1, "unsupported operation %d", operation.type);
+            return false;
+    }
+}
+
+// Converts the operations of one subgraph into its own network. Tensors
+// produced by an earlier subgraph enter it as network inputs.
+bool VpuPreparedModel::buildSubgraph(VpuSubgraph& subgraph, size_t index)
+{
+    std::string suffix = index ? std::to_string(index) : "";
+    subgraph.net.reset(new IRDocument("nnNet" + suffix));
+    mNet = subgraph.net.get();
+
+    for (auto i : subgraph.info.inputs) {
+        std::ostringstream operandName; operandName << "operand."<<i;
+        subgraph.inputNames.push_back(operandName.str());
+        if (mModel.operands[i].lifetime == OperandLifeTime::MODEL_INPUT) {
+            continue;  // created by getPort()
+        }
+
+        const TensorDesc& desc = mHandoffDescs[i];
+        auto operandInfo = mNet->createInput(operandName.str(), desc.getDims());
+        mPorts[i] = operandInfo->getInputData();
+        mPorts[i]->setPrecision(InferenceEngine::Precision::FP32);
+        VLOG(L1, "subgraph %zu reads mPorts[%d] from an earlier subgraph", index, i);
+    }
+
+    for (auto i : subgraph.info.operations) {
+        const auto& operation = mModel.operations[i];
+        if (!convertOperation(operation)) {
+            VLOG(L1, "failed to convert operation %d", operation.type);
+            return false;
         }
         VLOG(L1, "convert operation %d success", operation.type);
     }
 
-    finalizeOutput();
+    finalizeOutput(subgraph);
 
-    //initialize IE operation input/output ports
-//    convertModel(mNet);
+    // the CPU plugin only runs FP32 networks
+    if (subgraph.info.device == TargetDevice::eCPU) {
+        mNet->setPrecision(InferenceEngine::Precision::FP32);
+    }
 
     //debug graph
-    mNet.buildNetwork();
+    mNet->buildNetwork();
     std::fstream dot;
-    std::string graphfile("/data/graphfile");
-    dot.open("/data/graph.dot", std::ios::out);
-    mNet.save(graphfile);
-    mNet.crateDotFile(dot);
+    std::string graphfile("/data/graphfile" + suffix);
+    dot.open("/data/graph" + suffix + ".dot", std::ios::out);
+    mNet->save(graphfile);
+    mNet->crateDotFile(dot);
     dot.close();
 
-    VLOG(L1, "initialize ExecuteNetwork");
-		enginePtr = new ExecuteNetwork(mNet, TargetDevice::eMYRIAD);
-		//enginePtr->prepareInput();
-		//enginePtr->prepareOutput();
-		//printf("load network\n");
-		enginePtr->loadNetwork();
+    return true;
+}
 
-		//auto ob = enginePtr->Infer(inData);
+// Hash of everything that affects the compiled network: the model graph,
+// its constant data, the plugin config and the plugin build.
+std::string VpuPreparedModel::computeCacheKey(const VpuSubgraph& subgraph)
+{
+    VpuBlobCache::Hasher hasher;
+
+    hasher.update(subgraph.engine->pluginVersion());
+
+    std::map<std::string, std::string> networkConfig;
+    setConfig(networkConfig);
+    for (const auto& entry : networkConfig) {
+        hasher.update(entry.first);
+        hasher.update(entry.second);
+    }
+
+    for (uint32_t i = 0; i < mModel.operands.size(); i++) {
+        const auto& operand = mModel.operands[i];
+        hasher.update(operand.type);
+        hasher.update(operand.lifetime);
+        hasher.update(operand.scale);
+        hasher.update(operand.zeroPoint);
+        hasher.update(static_cast<uint64_t>(operand.dimensions.size()));
+        hasher.update(operand.dimensions.data(), operand.dimensions.size() * sizeof(uint32_t));
+
+        if (operand.lifetime == OperandLifeTime::CONSTANT_COPY ||
+            operand.lifetime == OperandLifeTime::CONSTANT_REFERENCE) {
+            uint32_t len;
+            const uint8_t *buf = GetOperandMemory(mModel, i, len);
+            hasher.update(len);
+            hasher.update(buf, len);
+        }
+    }
 
-    return true;
+    for (const auto& operation : mModel.operations) {
+        hasher.update(operation.type);
+        hasher.update(static_cast<uint64_t>(operation.inputs.size()));
+        hasher.update(operation.inputs.data(), operation.inputs.size() * sizeof(uint32_t));
+        hasher.update(static_cast<uint64_t>(operation.outputs.size()));
+        hasher.update(operation.outputs.data(), operation.outputs.size() * sizeof(uint32_t));
+    }
+
+    hasher.update(static_cast<uint64_t>(mModel.inputIndexes.size()));
+    hasher.update(mModel.inputIndexes.data(), mModel.inputIndexes.size() * sizeof(uint32_t));
+    hasher.update(static_cast<uint64_t>(mModel.outputIndexes.size()));
+    hasher.update(mModel.outputIndexes.data(), mModel.outputIndexes.size() * sizeof(uint32_t));
+
+    // which part of the model the network was compiled from
+    const VpuSubgraphInfo& info = subgraph.info;
+    hasher.update(static_cast<uint64_t>(info.operations.size()));
+    hasher.update(info.operations.data(), info.operations.size() * sizeof(uint32_t));
+    hasher.update(static_cast<uint64_t>(info.inputs.size()));
+    hasher.update(info.inputs.data(), info.inputs.size() * sizeof(uint32_t));
+    hasher.update(static_cast<uint64_t>(info.outputs.size()));
+    hasher.update(info.outputs.data(), info.outputs.size() * sizeof(uint32_t));
+
+    return hasher.digest();
+}
+
+// Loads the network onto the device, importing a previously compiled blob
+// from the cache when there is one and populating the cache otherwise.
+// Only Myriad networks can be exported, CPU networks are always compiled.
+void VpuPreparedModel::loadNetwork(VpuSubgraph& subgraph, size_t numRequests)
+{
+    ExecuteNetwork* enginePtr = subgraph.engine.get();
+    if (mBlobCache == nullptr || subgraph.info.device != TargetDevice::eMYRIAD) {
+        enginePtr->loadNetwork(numRequests);
+        return;
+    }
+
+    std::string key = computeCacheKey(subgraph);
+    if (mBlobCache->lookup(key)) {
+        if (enginePtr->importNetwork(mBlobCache->path(key), numRequests)) {
+            VLOG(L1, "network %s loaded from blob cache", key.c_str());
+            return;
+        }
+        // stale or corrupt entry, compile again and replace it
+        mBlobCache->remove(key);
+    }
+
+    enginePtr->loadNetwork(numRequests);
+
+    std::string tempFile = mBlobCache->tempPath(key);
+    if (enginePtr->exportNetwork(tempFile)) {
+        mBlobCache->commit(key, tempFile);
+        VLOG(L1, "network %s added to blob cache", key.c_str());
+    } else {
+        unlink(tempFile.c_str());
+    }
 }
 
 void VpuPreparedModel::deinitialize()
 {
     VLOG(L1, "deinitialize");
-    delete enginePtr;
-    enginePtr = nullptr;
+    mSubgraphs.clear();
 
     for (const auto& operand : mOperands) {
 /*        for (const auto& buf : operand.buffer) {
@@ -1334,118 +1331,117 @@ void VpuPreparedModel::asyncExecute(const Request& request,
                                        const sp<IExecutionCallback>& callback)
 {
 
-    std::vector<RunTimePoolInfo> requestPoolInfos;
-    if (!setRunTimePoolInfosFromHidlMemories(&requestPoolInfos, request.pools)) {
+    // pools are mapped once and reused by later requests on the same memory
+    std::vector<VpuPoolMapping*> requestPools;
+    if (!mPoolCache->acquire(request.pools, &requestPools)) {
         callback->notify(ErrorStatus::GENERAL_FAILURE);
         return;
     }
 
-    //std::vector<IRBlob::Ptr> input;
-    //std::vector<TBlob<float>::Ptr> output;
-    auto inOutData = [this, &requestPoolInfos](const std::vector<uint32_t>& indexes,
-                       const hidl_vec<RequestArgument>& arguments, bool inputFromRequest, ExecuteNetwork* enginePtr, std::vector<OutputPort> mPorts) {
-        //do memcpy for input data
-        for (size_t i = 0; i < indexes.size(); i++) {
-            RunTimeOperandInfo& operand = mOperands[indexes[i]];
-            const RequestArgument& arg = arguments[i];
-            auto poolIndex = arg.location.poolIndex;
-            nnAssert(poolIndex < requestPoolInfos.size());
-            auto& r = requestPoolInfos[poolIndex];
-            VLOG(L1, "Copy request input/output to model input/output");
-            //std::ostringstream operandName; operandName << "operand."<<indexes[i]; //use mPort[i]->name
-            if (inputFromRequest){
-                //model/request oputput pointer pass to inference engine input
-                //memcpy(operand.buffer, r.buffer + arg.location.offset, operand.length)
-                //auto in = GetOperandAsTensor(operand, operand.buffer, operand.length);
-                auto inputBlob = GetInOutOperandAsBlob(operand, const_cast<uint8_t*>(r.buffer + arg.location.offset), operand.length); //if not doing memcpy
-                //VLOG(L1, "setBlob for mPorts[%d]->name %s", indexes[i], mPorts[indexes[i]]->name.c_str());
-                enginePtr->setBlob(mPorts[indexes[i]]->name, inputBlob); //setInputBlob(const std::string &,IRBlob::Ptr);
-
-              }
-            else {
-                //inference engine output pointer pass to model/request oputput
-                //copy model oputput to request output
-                //memcpy(r.buffer + arg.location.offset, operand.buffer, operand.length);
-                auto outputBlob = GetInOutOperandAsBlob(operand, const_cast<uint8_t*>(r.buffer + arg.location.offset), operand.length); //if not doing memcpy
-                enginePtr->setBlob(mPorts[indexes[i]]->name, outputBlob);
-
-              }
-
-        }
-
+    std::map<uint32_t, const RequestArgument*> arguments;
+    for (size_t i = 0; i < mModel.inputIndexes.size(); i++)
+        arguments[mModel.inputIndexes[i]] = &request.inputs[i];
+    for (size_t i = 0; i < mModel.outputIndexes.size(); i++)
+        arguments[mModel.outputIndexes[i]] = &request.outputs[i];
+
+    //request input/output pointer pass to inference engine, no memcpy
+    auto requestBlob = [this, &requestPools, &arguments](uint32_t index) {
+        RunTimeOperandInfo& operand = mOperands[index];
+        const RequestArgument& arg = *arguments[index];
+        auto poolIndex = arg.location.poolIndex;
+        nnAssert(poolIndex < requestPools.size());
+        auto& r = *requestPools[poolIndex];
+        return GetInOutOperandAsBlob(operand, const_cast<uint8_t*>(r.buffer + arg.location.offset), operand.length);
     };
 
-
-
-    // compile it
-
-    //InfEng inference_engine(InferenceEngine::TargetDevice::eMYRIAD);
-
-    //auto executeNet1 = inference_engine.Compile(mNet);
+    // Tensors passed between subgraphs. The producing network writes the
+    // blob the consuming network reads, so nothing is copied in between.
+    std::map<uint32_t, Blob::Ptr> handoff;
 
     VLOG(L1, "pass request inputs/outputs buffer to network/model respectively");
 
-    inOutData(mModel.inputIndexes, request.inputs, true, enginePtr, mPorts);
-    inOutData(mModel.outputIndexes, request.outputs, false, enginePtr, mPorts);
-
-    VLOG(L1, "Run");
+    // Subgraphs run in order, each on an infer request of its own network
+    // that is held only while it runs. Concurrent executions thus pipeline:
+    // one runs a CPU subgraph while the next is on the Myriad.
+    auto runSubgraphs = [&]() {
+        for (size_t s = 0; s < mSubgraphs.size(); s++) {
+            VpuSubgraph& subgraph = mSubgraphs[s];
+            ExecuteNetwork* enginePtr = subgraph.engine.get();
+            InferRequestLease lease(enginePtr);
+            size_t requestId = lease.id();
+            VLOG(L1, "subgraph %zu checked out infer request %zu", s, requestId);
+
+            for (size_t i = 0; i < subgraph.info.inputs.size(); i++) {
+                uint32_t index = subgraph.info.inputs[i];
+                auto found = handoff.find(index);
+                auto inputBlob = found != handoff.end() ? found->second : requestBlob(index);
+                enginePtr->setBlob(requestId, subgraph.inputNames[i], inputBlob);
+            }
 
-    //auto output = execute.Infer(input).wait();
-    enginePtr->Infer();
+            for (size_t i = 0; i < subgraph.info.outputs.size(); i++) {
+                uint32_t index = subgraph.info.outputs[i];
+                const TensorDesc& desc = mHandoffDescs[index];
+                Blob::Ptr outputBlob;
+                if (mOperands[index].lifetime == OperandLifeTime::MODEL_OUTPUT) {
+                    outputBlob = requestBlob(index);
+                    // later subgraphs read the request buffer through the layout
+                    // this network produces it in
+                    handoff[index] = make_shared_blob<float>(desc, outputBlob->buffer().as<float*>(),
+                                                             outputBlob->size());
+                } else {
+                    outputBlob = make_shared_blob<float>(desc);
+                    outputBlob->allocate();
+                    handoff[index] = outputBlob;
+                }
+                enginePtr->setBlob(requestId, subgraph.outputNames[i], outputBlob);
+            }
 
+            VLOG(L1, "Run subgraph %zu", s);
+            if (enginePtr->Infer(requestId) != StatusCode::OK) {
+                ALOGE("subgraph %zu failed to run", s);
+                return false;
+            }
+        }
+        return true;
+    };
 
-//    VLOG(L1, "copy model output to request output");
+    bool succeeded = false;
+    try {
+        succeeded = runSubgraphs();
+    } catch (const std::exception& ex) {
+        ALOGE("subgraph execution threw: %s", ex.what());
+    } catch (...) {
+        ALOGE("subgraph execution threw an unknown exception");
+    }
+    if (!succeeded) {
+        mPoolCache->release(requestPools);
+        callback->notify(ErrorStatus::GENERAL_FAILURE);
+        return;
+    }
 
     VLOG(L1, "update shared memories");
-    for (auto runtimeInfo : requestPoolInfos) {
-        runtimeInfo.update();
+    // only the output ranges were written, sync those instead of whole pools
+    for (size_t i = 0; i < mModel.outputIndexes.size(); i++) {
+        const RunTimeOperandInfo& operand = mOperands[mModel.outputIndexes[i]];
+        const DataLocation& location = request.outputs[i].location;
+        requestPools[location.poolIndex]->flush(location.offset, operand.length);
     }
 
 #ifdef VPU_DEBUG
-    {
-        VLOG(L1, "Model output0 are:");
-        const RunTimeOperandInfo& output = mOperands[mModel.outputIndexes[0]];
-        InferenceEngine::TBlob<float>::Ptr outBlob = enginePtr->getBlob(mPorts[mModel.outputIndexes[0]]->name);
-
-        auto nelem = (outBlob->size() > 20 ? 20 : outBlob->size());
-        for (int i = 0; i <  nelem; i++) {
-        VLOG(L1, "outBlob elements %d = %f", i, outBlob->readOnly()[i]);
-        }
-        /*
-        auto outbuf = outBlob->cbuffer();
-        const uint8_t* buf1 = outbuf.as<uint8_t*>();
-        memcpy(output.buffer, buf1, output.length);
-        //uint8_t* buffer
-        printOperandbuf(L2, const_cast<uint8_t*>(output.buffer), output.dimensions);
-        */
-        VLOG(L1, "Model input0 are:");
-        const RunTimeOperandInfo& input = mOperands[mModel.inputIndexes[0]];
-        InferenceEngine::TBlob<float>::Ptr inBlob = enginePtr->getBlob(mPorts[mModel.inputIndexes[0]]->name);
-        nelem = (inBlob->size() > 20 ? 20 : inBlob->size());
-        for (int i = 0; i < nelem ; i++) {
-        VLOG(L1, "inBlob elements %d = %f", i, inBlob->readOnly()[i]);
-        }
-
-        /*
-        auto inbuf = inBlob->cbuffer();
-        uint8_t* buf2 = inbuf.as<uint8_t*>();
-        memcpy(input.buffer, inbuf, input.length);
-        printOperandbuf(L4, input.buffer, input.dimensions, 20);
-        */
-        for(const auto& op : mModel.operations) {
-            const auto& o = mOperands[op.outputs[0]];
-            InferenceEngine::TBlob<float>::Ptr opBlob = enginePtr->getBlob(mPorts[op.outputs[0]]->name);
-            VLOG(L1, "Operation %d has output 0(lifetime %d) are:", op.type, o.lifetime);
-
-            nelem = (opBlob->size() > 20 ? 20 : opBlob->size());
-            for (int i = 0; i <  nelem; i++) {
-            VLOG(L1, "operation output Blob elements %d = %f", i, opBlob->readOnly()[i]);
-            }
-            //printOperandbuf(L4, o.buffer, o.dimensions, 20);
+    for (const auto& entry : handoff) {
+        VLOG(L1, "operand %d %s subgraph output elements are:", entry.first,
+             mOperands[entry.first].lifetime == OperandLifeTime::MODEL_OUTPUT ? "model" : "intermediate");
+        auto mem = entry.second->cbuffer();
+        const float* buf = mem.as<const float*>();
+        auto nelem = (entry.second->size() > 20 ? 20 : entry.second->size());
+        for (int i = 0; i < nelem; i++) {
+        VLOG(L1, "elements %d = %f", i, buf[i]);
         }
     }
 #endif
 
+    mPoolCache->release(requestPools);
+
     Return<void> returned = callback->notify(ErrorStatus::NONE);
     if (!returned.isOk()) {
         ALOGE("hidl callback failed to return properly: %s", returned.description().c_str());
@@ -1477,11 +1473,29 @@ Return<ErrorStatus> VpuPreparedModel::execute(const Request& request,
     }
 
 
-    // This thread is intentionally detached because the vpu driver service
-    // is expected to live forever.
-    std::thread([this, request, callback]{ asyncExecute(request, callback); }).detach();
+    // The task holds a strong reference so the prepared model outlives
+    // any request still waiting in the queue.
+    sp<VpuPreparedModel> self = this;
+    // anything asyncExecute lets escape still fails the execution; the pool
+    // logs the exception
+    auto task = [self, request, callback] {
+        try {
+            self->asyncExecute(request, callback);
+        } catch (...) {
+            callback->notify(ErrorStatus::GENERAL_FAILURE);
+            throw;
+        }
+    };
+    if (!mWorkerPool->submit(task)) {
+        ALOGE("failed to queue execution");
+        callback->notify(ErrorStatus::GENERAL_FAILURE);
+        return ErrorStatus::GENERAL_FAILURE;
+    }
 
-    VLOG(L1, "Start execute thread done");
+    auto stats = mWorkerPool->getStats();
+    VLOG(L2, "execution queued, depth %zu (max %zu) rejected %llu avg wait %llu us",
+         stats.queueDepth, stats.maxQueueDepth, (unsigned long long)stats.rejected,
+         (unsigned long long)(stats.completed ? stats.totalWaitUs / stats.completed : 0));
 
     return ErrorStatus::NONE;
 }
@@ -1665,6 +1679,75 @@ bool VpuPreparedModel::isOperationSupported(const Operation& operation, const Mo
     return true;
 }
 
+// Whether the operation can be converted for the CPU plugin, which runs
+// the parts of a model the Myriad does not support.
+bool VpuPreparedModel::isOperationSupportedOnCpu(const Operation& operation, const Model& model)
+{
+    VLOG(L1, "Check operation %d on CPU", operation.type);
+
+    for (auto i : operation.inputs) {
+        if (model.operands[i].type == OperandType::TENSOR_QUANT8_ASYMM) return false;
+    }
+    for (auto i : operation.outputs) {
+        if (model.operands[i].type == OperandType::TENSOR_QUANT8_ASYMM) return false;
+    }
+
+    auto isConstant = [&model](uint32_t index) {
+        auto lifetime = model.operands[index].lifetime;
+        return lifetime == OperandLifeTime::CONSTANT_COPY ||
+               lifetime == OperandLifeTime::CONSTANT_REFERENCE;
+    };
+    const auto& input0 = model.operands[operation.inputs[0]];
+
+    switch(operation.type) {
+        case OperationType::ADD:
+        {
+            // a constant addend becomes a ScaleShift, otherwise no broadcast
+            bool const0 = isConstant(operation.inputs[0]);
+            bool const1 = isConstant(operation.inputs[1]);
+            if (const0 && const1) return false;
+            if (!const0 && !const1 && input0.dimensions != model.operands[operation.inputs[1]].dimensions)
+                return false;
+            break;
+        }
+        case OperationType::MUL:
+            if (isConstant(operation.inputs[0]) || isConstant(operation.inputs[1]) ||
+                input0.dimensions != model.operands[operation.inputs[1]].dimensions)
+                return false;
+            break;
+        case OperationType::RELU1:
+        case OperationType::RELU6:
+            break;
+        case OperationType::SOFTMAX:
+        case OperationType::CONV_2D:
+        case OperationType::DEPTHWISE_CONV_2D:
+        case OperationType::AVERAGE_POOL_2D:
+        case OperationType::MAX_POOL_2D:
+        case OperationType::FULLY_CONNECTED:
+        case OperationType::RELU:
+        case OperationType::LOGISTIC:
+        case OperationType::TANH:
+        case OperationType::LOCAL_RESPONSE_NORMALIZATION:
+        case OperationType::CONCATENATION:
+        case OperationType::L2_NORMALIZATION:
+        case OperationType::RESHAPE:
+            // same converters and shape constraints as on the Myriad
+            return isOperationSupported(operation, model);
+        default:
+            return false;
+    }
+    VLOG(L1, "Operation %d supported by CPU", operation.type);
+
+    return true;
+}
+
+// The MKLDNN plugin is installed with the HAL (dl/mkldnn.mk); setting the
+// property to false rejects unsupported models up front instead.
+bool VpuPreparedModel::cpuFallbackEnabled()
+{
+    return property_get_bool("vendor.vpu.cpu_fallback", true);
+}
+
 bool VpuPreparedModel::isConst(int index)
 {
 	const auto op = mModel.operands[index];
@@ -1690,9 +1773,9 @@ bool VpuPreparedModel::operationAdd(const Operation& operation)
 				}
 				// this will use ScaleShift
 				if (isIn0Const) //if op.inputs[1] is a Model input
-					out = AddConst(mNet, getPort(operation.inputs[1]),GetConstOperandAsTensor(operation.inputs[0]));
+					out = AddConst(*mNet, getPort(operation.inputs[1]),GetConstOperandAsTensor(operation.inputs[0]));
 				else // isIn1Const is const //op.inputs[0] is a Model input
-					out = AddConst(mNet, getPort(operation.inputs[0]),GetConstOperandAsTensor(operation.inputs[1]));
+					out = AddConst(*mNet, getPort(operation.inputs[0]),GetConstOperandAsTensor(operation.inputs[1]));
 			} else { // both inputs[0] & inputs[1] are model inputs
 				out = getPort(operation.inputs[0]) + getPort(operation.inputs[1]);
 			}
@@ -2662,11 +2745,11 @@ void VpuPreparedModel::initializeInput(RunTimeOperandInfo* input)
 {
 }
 //from {pmem, shape} to {new pmem, type, buffer, format, length}
-void VpuPreparedModel::finalizeOutput(/*RunTimeOperandInfo* output */)
+void VpuPreparedModel::finalizeOutput(VpuSubgraph& subgraph)
 {
   VLOG(L1, "finalize Output");
-  // loop over all outputs
-  for (auto i : mModel.outputIndexes)
+  // loop over the model outputs and the tensors later subgraphs read
+  for (auto i : subgraph.info.outputs)
 	{
 //		mPorts[i]->setLayout(NHWC);
 
@@ -2690,7 +2773,9 @@ void VpuPreparedModel::finalizeOutput(/*RunTimeOperandInfo* output */)
 */
 		//mPorts[i]->setPrecision(InferenceEngine::Precision::FP16);
     mPorts[i]->setPrecision(InferenceEngine::Precision::FP32);
-		mNet.addOutput(mPorts[i]);
+		mNet->addOutput(mPorts[i]);
+    subgraph.outputNames.push_back(mPorts[i]->name);
+    mHandoffDescs[i] = TensorDesc(InferenceEngine::Precision::FP32, mPorts[i]->getDims(), mPorts[i]->getLayout());
 
 //to debug
     VLOG(L1, "mPorts[%d] %s dims size %d", i, mPorts[i]->name.c_str(), dims_size);
@@ -34,12 +34,17 @@
 #include <hidlmemory/mapping.h>
 #include <hardware/hardware.h>
 #include <sys/mman.h>
+#include <memory>
 #include <string>
 
 //#include <mvnc.h>
 
 //vpu include
 #include "vpu_plugin.hpp"
+#include "VpuBlobCache.h"
+#include "VpuPartitioner.h"
+#include "VpuPoolCache.h"
+#include "VpuWorkerPool.h"
 #include <fstream>
 
 using ::android::hidl::memory::V1_0::IMemory;
@@ -112,6 +117,16 @@ struct RunTimePoolInfo {
 bool setRunTimePoolInfosFromHidlMemories(std::vector<RunTimePoolInfo>* poolInfos,
                                          const hidl_vec<hidl_memory>& pools);
 
+// One partition of the model, compiled for and run on a single device.
+struct VpuSubgraph {
+    VpuSubgraphInfo info;
+    std::unique_ptr<IRDocument> net;
+    // declared after net, the engine refers to its network
+    std::unique_ptr<ExecuteNetwork> engine;
+    // network blob names of info.inputs and info.outputs
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+};
 
 
 // Base class used to create vpu drivers for the NN HAL.  This class
@@ -121,15 +136,18 @@ bool setRunTimePoolInfosFromHidlMemories(std::vector<RunTimePoolInfo>* poolInfos
 // on the CPU.  An actual driver would not do that.
 class VpuPreparedModel : public IPreparedModel {
 public:
-    VpuPreparedModel(const Model& model)
+    VpuPreparedModel(const Model& model, const std::shared_ptr<VpuWorkerPool>& workerPool,
+                     const std::shared_ptr<VpuBlobCache>& blobCache)
           : // Make a copy of the model, as we need to preserve it.
-            mModel(model), mNet("nnNet") {
+            mModel(model), mNet(nullptr), mWorkerPool(workerPool), mBlobCache(blobCache) {
 	}
     ~VpuPreparedModel() override {deinitialize();}
     bool initialize();
     Return<ErrorStatus> execute(const Request& request,
                                 const sp<IExecutionCallback>& callback) override;
     static bool isOperationSupported(const Operation& operation, const Model& model);
+    static bool isOperationSupportedOnCpu(const Operation& operation, const Model& model);
+    static bool cpuFallbackEnabled();
     static bool validModel(const Model& model);
     static bool validateRequest(const Request& request, const Model& model);
 
@@ -138,6 +156,10 @@ private:
     bool initializeRunTimeOperandInfo();
     void asyncExecute(const Request& request, const sp<IExecutionCallback>& callback);
     void convertModel(IRDocument &mNet);
+    bool convertOperation(const Operation& operation);
+    bool buildSubgraph(VpuSubgraph& subgraph, size_t index);
+    std::string computeCacheKey(const VpuSubgraph& subgraph);
+    void loadNetwork(VpuSubgraph& subgraph, size_t numRequests);
 
     bool operationAdd(const Operation& operation);
     bool operationAveragePool2D(const Operation& operation);
@@ -159,7 +181,7 @@ private:
     bool operationTANH(const Operation& operation);
 
     void initializeInput(RunTimeOperandInfo* input);
-    void finalizeOutput(/*RunTimeOperandInfo* output*/);
+    void finalizeOutput(VpuSubgraph& subgraph);
 
     OutputPort handleFusion(const OutputPort &out, int32_t fusedOp);
     template<typename T>
@@ -182,10 +204,15 @@ private:
     Model mModel;
     std::vector<RunTimeOperandInfo> mOperands;
     std::vector<RunTimePoolInfo> mPoolInfos;
-    IRDocument mNet;
+    IRDocument* mNet;  // network of the subgraph being converted
     std::vector<OutputPort> mPorts;  //typedef std::shared_ptr<Data> DataPtr;
-    ExecuteNetwork* enginePtr;
+    std::vector<VpuSubgraph> mSubgraphs;  // in execution order
+    // layout of every tensor handed over between subgraphs, as produced
+    std::map<uint32_t, TensorDesc> mHandoffDescs;
 //    std::vector<InferenceEngine::DataPtr> mPorts;
+    std::shared_ptr<VpuWorkerPool> mWorkerPool;
+    std::shared_ptr<VpuBlobCache> mBlobCache;
+    std::unique_ptr<VpuPoolCache> mPoolCache;
 
 };
 
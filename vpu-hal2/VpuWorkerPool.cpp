@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VpuWorkerPool"
+
+#include <cutils/log.h>
+#include <exception>
+#include "VpuWorkerPool.h"
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+VpuWorkerPool::VpuWorkerPool(size_t numWorkers, size_t queueCapacity, OverflowPolicy policy)
+    : mCapacity(queueCapacity > 0 ? queueCapacity : 1), mPolicy(policy)
+{
+    if (numWorkers == 0) numWorkers = 1;
+
+    ALOGI("starting %zu workers, queue capacity %zu", numWorkers, mCapacity);
+    for (size_t i = 0; i < numWorkers; i++) {
+        mWorkers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+VpuWorkerPool::~VpuWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mNotEmpty.notify_all();
+    mNotFull.notify_all();
+
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+bool VpuWorkerPool::submit(Task task)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mQueue.size() >= mCapacity) {
+        if (mPolicy == kReject) {
+            mStats.rejected++;
+            ALOGW("execution queue full (%zu tasks), rejecting request", mQueue.size());
+            return false;
+        }
+        mNotFull.wait(lock, [this] { return mStopping || mQueue.size() < mCapacity; });
+    }
+
+    if (mStopping) {
+        mStats.rejected++;
+        return false;
+    }
+
+    mQueue.push_back({std::move(task), std::chrono::steady_clock::now()});
+
+    mStats.submitted++;
+    mStats.queueDepth = mQueue.size();
+    if (mStats.queueDepth > mStats.maxQueueDepth) {
+        mStats.maxQueueDepth = mStats.queueDepth;
+    }
+
+    lock.unlock();
+    mNotEmpty.notify_one();
+    return true;
+}
+
+VpuWorkerPoolStats VpuWorkerPool::getStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void VpuWorkerPool::workerLoop()
+{
+    for (;;) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mNotEmpty.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            // pending tasks are drained before the workers exit
+            if (mQueue.empty()) {
+                return;
+            }
+
+            entry = std::move(mQueue.front());
+            mQueue.pop_front();
+
+            uint64_t waitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - entry.enqueued).count();
+            mStats.queueDepth = mQueue.size();
+            mStats.totalWaitUs += waitUs;
+            if (waitUs > mStats.maxWaitUs) {
+                mStats.maxWaitUs = waitUs;
+            }
+        }
+        mNotFull.notify_one();
+
+        // a throwing task must not take the worker, and with it the
+        // service, down
+        try {
+            entry.task();
+        } catch (const std::exception& ex) {
+            ALOGE("task threw: %s", ex.what());
+        } catch (...) {
+            ALOGE("task threw an unknown exception");
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.completed++;
+    }
+}
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
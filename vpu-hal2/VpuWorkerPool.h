@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_ML_NN_VPU_WORKERPOOL_H
+#define ANDROID_ML_NN_VPU_WORKERPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace neuralnetworks {
+namespace V1_0 {
+namespace vpu_driver {
+
+// Counters describing the load on a VpuWorkerPool.
+struct VpuWorkerPoolStats {
+    size_t queueDepth;        // tasks currently waiting for a worker
+    size_t maxQueueDepth;     // high-water mark of queueDepth
+    uint64_t submitted;       // tasks accepted into the queue
+    uint64_t rejected;        // tasks refused because the queue was full
+    uint64_t completed;       // tasks run to completion
+    uint64_t totalWaitUs;     // sum of time tasks spent queued
+    uint64_t maxWaitUs;       // longest time a task spent queued
+};
+
+// Fixed-size set of worker threads fed by a bounded multi-producer,
+// multi-consumer queue. One pool is owned by VpuDriver and shared by every
+// prepared model it creates, so the number of execution threads does not
+// grow with the number of requests.
+class VpuWorkerPool {
+public:
+    typedef std::function<void()> Task;
+
+    // What submit() does when the queue already holds queueCapacity tasks.
+    enum OverflowPolicy {
+        kBlock,     // wait for a free slot
+        kReject,    // return false immediately
+    };
+
+    VpuWorkerPool(size_t numWorkers, size_t queueCapacity, OverflowPolicy policy = kBlock);
+    ~VpuWorkerPool();
+
+    // Queues a task for execution. Returns false if the task was not
+    // accepted, either because the queue is full under kReject or because
+    // the pool is shutting down. An exception thrown by the task is logged
+    // and dropped, so the task reports its own failures.
+    bool submit(Task task);
+
+    VpuWorkerPoolStats getStats();
+
+private:
+    struct Entry {
+        Task task;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread> mWorkers;
+    std::deque<Entry> mQueue;
+    size_t mCapacity;
+    OverflowPolicy mPolicy;
+    bool mStopping = false;
+
+    std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+
+    VpuWorkerPoolStats mStats = {};
+};
+
+}  // namespace vpu_driver
+}  // namespace V1_0
+}  // namespace neuralnetworks
+}  // namespace hardware
+}  // namespace android
+
+#endif // ANDROID_ML_NN_VPU_WORKERPOOL_H
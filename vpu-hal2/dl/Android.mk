@@ -3,4 +3,5 @@ LOCAL_PATH:= $(call my-dir)
 include $(LOCAL_PATH)/ie.mk
 include $(LOCAL_PATH)/graph-trans.mk
 include $(LOCAL_PATH)/myriad.mk
+include $(LOCAL_PATH)/mkldnn.mk
 #include $(LOCAL_PATH)/prebuild.mk
@@ -94,7 +94,11 @@ LOCAL_MULTILIB := both
 #LOCAL_MULTILIB := 64
 LOCAL_SRC_FILES := \
 	inference-engine/src/vpu/common/vpu_logger.cpp \
-	inference-engine/src/vpu/common/parsed_config.cpp
+	inference-engine/src/vpu/common/parsed_config.cpp \
+	inference-engine/src/vpu/common/blob_convert.cpp \
+	inference-engine/src/vpu/common/exported_network.cpp \
+	inference-engine/src/vpu/common/network_batch.cpp \
+	inference-engine/src/vpu/common/blob_compression.cpp
 
 
 LOCAL_C_INCLUDES += \
@@ -55,7 +55,7 @@ LOCAL_CFLAGS += -DENABLE_VPU -DENABLE_MYRIAD -DAKS -DNDEBUG -DIMPLEMENT_INFERENC
 #LOCAL_CFLAGS += -DAKS -DNNLOG
 
 LOCAL_SHARED_LIBRARIES := liblog
-LOCAL_STATIC_LIBRARIES := libpugixml libade
+LOCAL_STATIC_LIBRARIES := libpugixml libade libvpu_fp16
 
 include $(BUILD_SHARED_LIBRARY)
 ##########################################################################
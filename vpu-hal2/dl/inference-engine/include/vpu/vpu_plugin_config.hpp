@@ -56,5 +56,19 @@ DECLARE_VPU_CONFIG_KEY(INPUT_BIAS);
 */
 DECLARE_VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME);
 
+/**
+* @brief Flag for allocating the network on every available device of the same platform
+* and running each inference on the least loaded one.
+* This option should be used with values: CONFIG_VALUE(NO) (default) or CONFIG_VALUE(YES)
+*/
+DECLARE_VPU_CONFIG_KEY(MULTI_DEVICE);
+
+/**
+* @brief Number of inferences that can be queued on a device for one network at the same time.
+* This should be a positive integer, 4 by default. Should not be lower than the number of
+* infer requests started concurrently, or the extra requests wait for the device queue.
+*/
+DECLARE_VPU_CONFIG_KEY(FIFO_DEPTH);
+
 }  // namespace VPUConfigParams
 }  // namespace InferenceEngine
@@ -71,6 +71,34 @@ void Config::readProperties(const std::map<std::string, std::string> &prop) {
             else
                 THROW_IE_EXCEPTION << "Wrong value for property key " << PluginConfigParams::KEY_EXCLUSIVE_ASYNC_REQUESTS
                                    << ". Expected only YES/NO";
+        } else if (key == CPU_CONFIG_KEY_EDGE_MEMORY_REUSE) {
+            if (val == PluginConfigParams::YES) reuseEdgeMemory = true;
+            else if (val == PluginConfigParams::NO) reuseEdgeMemory = false;
+            else
+                THROW_IE_EXCEPTION << "Wrong value for property key " << CPU_CONFIG_KEY_EDGE_MEMORY_REUSE
+                                   << ". Expected only YES/NO";
+        } else if (key == CPU_CONFIG_KEY_THROUGHPUT_STREAMS) {
+            int val_i;
+            try {
+                val_i = std::stoi(val);
+            } catch (...) {
+                val_i = 0;
+            }
+            if (val_i < 1)
+                THROW_IE_EXCEPTION << "Wrong value for property key " << CPU_CONFIG_KEY_THROUGHPUT_STREAMS
+                                   << ". Expected a positive number of streams";
+            throughputStreams = val_i;
+        } else if (key == CPU_CONFIG_KEY_INTER_OP_THREADS) {
+            int val_i;
+            try {
+                val_i = std::stoi(val);
+            } catch (...) {
+                val_i = 0;
+            }
+            if (val_i < 1)
+                THROW_IE_EXCEPTION << "Wrong value for property key " << CPU_CONFIG_KEY_INTER_OP_THREADS
+                                   << ". Expected a positive number of threads";
+            interOpThreads = val_i;
         } else {
             THROW_IE_EXCEPTION << NOT_FOUND_str << "Unsupported property key [" << key << "] by CPU plugin";
 		
@@ -36,11 +36,30 @@
 
 namespace MKLDNNPlugin {
 
+/**
+ * @brief Lets intermediate edges with disjoint lifetimes share one memory arena (YES by default)
+ */
+#define CPU_CONFIG_KEY_EDGE_MEMORY_REUSE "CPU_EDGE_MEMORY_REUSE"
+
+/**
+ * @brief Number of graph instances (streams) inferring requests in parallel, 1 by default.
+ * Every stream runs on its own group of cores, streams share the weights.
+ */
+#define CPU_CONFIG_KEY_THROUGHPUT_STREAMS "CPU_THROUGHPUT_STREAMS"
+
+/**
+ * @brief Number of independent nodes of a graph executed at the same time, 1 (one by one) by default
+ */
+#define CPU_CONFIG_KEY_INTER_OP_THREADS "CPU_INTER_OP_THREADS"
+
 struct Config {
     bool useThreadBinding = true;
     bool collectPerfCounters = false;
     bool exclusiveAsyncRequests = false;
     int batchLimit = 0;
+    bool reuseEdgeMemory = true;
+    int throughputStreams = 1;
+    int interOpThreads = 1;
 
     void readProperties(const std::map<std::string, std::string> &config);
 };
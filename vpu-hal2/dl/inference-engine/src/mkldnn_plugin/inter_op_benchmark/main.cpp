@@ -0,0 +1,293 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+// Measures the latency of one inference of an inception-style network on the
+// CPU plugin with the nodes run one by one and with independent branches run
+// at the same time (CPU_INTER_OP_THREADS), and checks both give the same
+// result. The network is generated with random weights: a chain of blocks of
+// four branches (1x1, 1x1-3x3, 1x1-5x5 and pool-1x1 convolutions) joined by a
+// concat, on a small spatial size where a single convolution cannot keep all
+// the cores busy.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+using namespace InferenceEngine;
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  -d <path>     directory of the CPU plugin library, the library path by default\n"
+              << "  -t <threads>  CPU_INTER_OP_THREADS to compare with 1, 4 by default\n"
+              << "  -b <blocks>   number of inception blocks, 4 by default\n"
+              << "  -c <channels> channels of a block output, 256 by default\n"
+              << "  -s <size>     height and width of the feature maps, 14 by default\n"
+              << "  -n <count>    timed inferences per mode, 100 by default\n";
+}
+
+class InceptionBuilder {
+public:
+    InceptionBuilder(int channels, int size) : size(size) {
+        std::ostringstream layer;
+        layer << "<layer id=\"0\" name=\"data\" type=\"Input\" precision=\"FP32\">"
+              << "<output>" << port(1, channels) << "</output></layer>\n";
+        layers << layer.str();
+        nextId = 1;
+    }
+
+    // Returns the id of the block output layer; its output port is the last port
+    int block(int input, int inChannels, int outChannels) {
+        int branch = outChannels / 4;
+        int b0 = conv(input, inChannels, branch, 1);
+
+        int b1 = conv(conv(input, inChannels, branch / 2, 1), branch / 2, branch, 3);
+
+        int b2 = conv(conv(input, inChannels, branch / 4, 1), branch / 4, branch, 5);
+
+        int pool = nextId++;
+        layers << "<layer id=\"" << pool << "\" name=\"pool" << pool << "\" type=\"Pooling\" precision=\"FP32\">"
+               << "<data kernel-x=\"3\" kernel-y=\"3\" stride-x=\"1\" stride-y=\"1\" pad-x=\"1\" pad-y=\"1\""
+               << " pool-method=\"max\"/>"
+               << "<input>" << port(0, inChannels) << "</input>"
+               << "<output>" << port(1, inChannels) << "</output></layer>\n";
+        edge(input, pool, 0);
+        int b3 = conv(pool, inChannels, branch, 1);
+
+        int concat = nextId++;
+        layers << "<layer id=\"" << concat << "\" name=\"concat" << concat << "\" type=\"Concat\" precision=\"FP32\">"
+               << "<data axis=\"1\"/><input>";
+        for (int i = 0; i < 4; i++)
+            layers << port(i, branch);
+        layers << "</input><output>" << port(4, 4 * branch) << "</output></layer>\n";
+        int branches[] = {b0, b1, b2, b3};
+        for (int i = 0; i < 4; i++)
+            edge(branches[i], concat, i);
+        return concat;
+    }
+
+    std::string xml() const {
+        return "<net name=\"inception_benchmark\" version=\"2\" batch=\"1\">\n<layers>\n" + layers.str() +
+               "</layers>\n<edges>\n" + edges.str() + "</edges>\n</net>\n";
+    }
+
+    TBlob<uint8_t>::Ptr weightsBlob() const {
+        auto blob = make_shared_blob<uint8_t>(Precision::U8, C, {weights.size() * sizeof(float)});
+        blob->allocate();
+        std::copy(weights.begin(), weights.end(), blob->buffer().as<float *>());
+        return blob;
+    }
+
+private:
+    std::string port(int id, int channels) const {
+        std::ostringstream out;
+        out << "<port id=\"" << id << "\"><dim>1</dim><dim>" << channels << "</dim><dim>" << size
+            << "</dim><dim>" << size << "</dim></port>";
+        return out.str();
+    }
+
+    // A convolution followed by a ReLU, returns the id of the ReLU
+    int conv(int input, int inChannels, int outChannels, int kernel) {
+        int id = nextId++;
+        size_t weightsOffset = append(static_cast<size_t>(outChannels) * inChannels * kernel * kernel);
+        size_t biasesOffset = append(outChannels);
+        layers << "<layer id=\"" << id << "\" name=\"conv" << id << "\" type=\"Convolution\" precision=\"FP32\">"
+               << "<data kernel-x=\"" << kernel << "\" kernel-y=\"" << kernel << "\" stride-x=\"1\" stride-y=\"1\""
+               << " pad-x=\"" << kernel / 2 << "\" pad-y=\"" << kernel / 2 << "\" output=\"" << outChannels
+               << "\" group=\"1\"/>"
+               << "<input>" << port(0, inChannels) << "</input>"
+               << "<output>" << port(1, outChannels) << "</output>"
+               << "<blobs><weights offset=\"" << weightsOffset * sizeof(float) << "\" size=\""
+               << static_cast<size_t>(outChannels) * inChannels * kernel * kernel * sizeof(float) << "\"/>"
+               << "<biases offset=\"" << biasesOffset * sizeof(float) << "\" size=\""
+               << outChannels * sizeof(float) << "\"/></blobs></layer>\n";
+        edge(input, id, 0);
+
+        int relu = nextId++;
+        layers << "<layer id=\"" << relu << "\" name=\"relu" << relu << "\" type=\"ReLU\" precision=\"FP32\">"
+               << "<input>" << port(0, outChannels) << "</input>"
+               << "<output>" << port(1, outChannels) << "</output></layer>\n";
+        edge(id, relu, 0);
+        return relu;
+    }
+
+    void edge(int from, int to, int toPort) {
+        // every layer built here has a single output, numbered after its inputs
+        int fromPort = from == 0 ? 1 : outPorts[from];
+        edges << "<edge from-layer=\"" << from << "\" from-port=\"" << fromPort
+              << "\" to-layer=\"" << to << "\" to-port=\"" << toPort << "\"/>\n";
+        if (!outPorts.count(to))
+            outPorts[to] = 1;
+        else
+            outPorts[to] = std::max(outPorts[to], toPort + 1);
+    }
+
+    size_t append(size_t count) {
+        size_t offset = weights.size();
+        std::normal_distribution<float> dist(0.0f, 0.05f);
+        for (size_t i = 0; i < count; i++)
+            weights.push_back(dist(generator));
+        return offset;
+    }
+
+    int size;
+    int nextId;
+    std::ostringstream layers;
+    std::ostringstream edges;
+    std::map<int, int> outPorts;
+    std::vector<float> weights;
+    std::mt19937 generator{42};
+};
+
+struct Result {
+    double msPerInference;
+    std::vector<float> output;
+};
+
+Result measure(InferencePlugin &plugin, CNNNetwork &network, int interOpThreads, int count) {
+    std::map<std::string, std::string> config = {
+        {"CPU_INTER_OP_THREADS", std::to_string(interOpThreads)}
+    };
+    auto executable = plugin.LoadNetwork(network, config);
+    auto request = executable.CreateInferRequest();
+
+    std::string inputName = network.getInputsInfo().begin()->first;
+    std::string outputName = network.getOutputsInfo().begin()->first;
+
+    auto input = request.GetBlob(inputName);
+    float *inputData = input->buffer().as<float *>();
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (size_t i = 0; i < input->size(); i++)
+        inputData[i] = dist(generator);
+
+    for (int i = 0; i < 10; i++)
+        request.Infer();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+        request.Infer();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto output = request.GetBlob(outputName);
+    const float *outputData = output->buffer().as<float *>();
+    return {ms / count, std::vector<float>(outputData, outputData + output->size())};
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string pluginDir;
+    int interOpThreads = 4, blocks = 4, channels = 256, size = 14, count = 100;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-d") {
+            pluginDir = value;
+        } else if (arg == "-t") {
+            interOpThreads = std::atoi(value.c_str());
+        } else if (arg == "-b") {
+            blocks = std::atoi(value.c_str());
+        } else if (arg == "-c") {
+            channels = std::atoi(value.c_str());
+        } else if (arg == "-s") {
+            size = std::atoi(value.c_str());
+        } else if (arg == "-n") {
+            count = std::atoi(value.c_str());
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (interOpThreads < 1 || blocks < 1 || channels < 16 || channels % 16 || size < 1 || count < 1) {
+        std::cerr << "Expected positive values and a multiple of 16 channels\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        InceptionBuilder builder(channels, size);
+        int last = 0;
+        for (int b = 0; b < blocks; b++)
+            last = builder.block(last, channels, channels);
+
+        std::string xml = builder.xml();
+        CNNNetReader reader;
+        reader.ReadNetwork(xml.data(), xml.size());
+        reader.SetWeights(builder.weightsBlob());
+        CNNNetwork network = reader.getNetwork();
+
+        InferencePlugin plugin(PluginDispatcher({pluginDir, ""}).getPluginByDevice("CPU"));
+
+        std::cout << blocks << " inception blocks, " << channels << " channels of " << size << "x" << size << "\n";
+        Result sequential = measure(plugin, network, 1, count);
+        std::cout << "CPU_INTER_OP_THREADS=1: " << sequential.msPerInference << " ms per inference\n";
+        Result parallel = measure(plugin, network, interOpThreads, count);
+        std::cout << "CPU_INTER_OP_THREADS=" << interOpThreads << ": " << parallel.msPerInference
+                  << " ms per inference, " << sequential.msPerInference / parallel.msPerInference << "x\n";
+
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < sequential.output.size(); i++)
+            maxDiff = std::max(maxDiff, std::fabs(sequential.output[i] - parallel.output[i]));
+        std::cout << "max output difference: " << maxDiff << "\n";
+        if (maxDiff > 1e-4f) {
+            std::cerr << "Outputs differ\n";
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
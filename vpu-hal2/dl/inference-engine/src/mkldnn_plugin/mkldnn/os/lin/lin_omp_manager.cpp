@@ -31,6 +31,7 @@
 //
 #include "lin_omp_manager.h"
 
+#include <algorithm>
 #include <fstream>
 #include <set>
 #include <string>
@@ -331,6 +332,46 @@ void OpenMpManager::bindOpenMpThreads(int env_cores) {
     }
 }
 
+void OpenMpManager::bindOpenMpThreadsToCoreGroup(int group, int groups) {
+    OpenMpManager &openMpManager = getInstance();
+
+    int cores = openMpManager.getCoreNumber();
+    int coresPerGroup = std::max(1, cores / std::max(1, groups));
+    omp_set_num_threads(coresPerGroup);
+
+    if (!openMpManager.isThreadsBindAllowed())
+        return;
+
+    // Groups take consecutive physical cores, so a group stays on one socket
+    // as long as the socket has enough cores for it
+    int firstCore = (group * coresPerGroup) % cores;
+    #pragma omp parallel
+    {
+        unsigned logicalCoreId = (firstCore + omp_get_thread_num()) % cores;
+        openMpManager.bindCurrentThreadToLogicalCoreCpu(logicalCoreId);
+    }
+}
+
+void OpenMpManager::getOpenMpTeamCpuSet(cpu_set_t *set) {
+    CPU_ZERO(set);
+    #pragma omp parallel
+    {
+        cpu_set_t own;
+        if (sched_getaffinity(0, sizeof(own), &own) == 0) {
+            #pragma omp critical
+            CPU_OR(set, set, &own);
+        }
+    }
+    if (CPU_COUNT(set) == 0) {
+        OpenMpManager &openMpManager = getInstance();
+        CPU_OR(set, set, &openMpManager.currentCpuSet);
+    }
+}
+
+void OpenMpManager::bindCurrentThreadToCpuSet(const cpu_set_t *set) {
+    sched_setaffinity(0, sizeof(*set), set);
+}
+
 int OpenMpManager::getOpenMpThreadNumber() {
     OpenMpManager &openMpManager = getInstance();
 
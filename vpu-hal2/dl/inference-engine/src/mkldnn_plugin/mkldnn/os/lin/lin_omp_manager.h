@@ -158,6 +158,16 @@ public:
 
     static void bindOpenMpThreads(int env_cores = 0);
 
+    // Limits the OpenMP team of the calling thread to the cores of one of
+    // `groups` equal parts of the available cores and binds the team to them
+    static void bindOpenMpThreadsToCoreGroup(int group, int groups);
+
+    // Collects the CPUs the OpenMP team of the calling thread may run on
+    static void getOpenMpTeamCpuSet(cpu_set_t *set);
+
+    // Lets the calling thread run on any CPU of the set
+    static void bindCurrentThreadToCpuSet(const cpu_set_t *set);
+
     static int getOpenMpThreadNumber();
 
     static void printVerboseInformation();
@@ -113,7 +113,7 @@ int MKLDNNPlugin::MKLDNNEdge::getOutputNum() {
     return -1;
 }
 
-void MKLDNNPlugin::MKLDNNEdge::allocate() {
+void MKLDNNPlugin::MKLDNNEdge::allocate(const void* mem_ptr) {
     if (status != Status::NeedAllocation)
         return;
 
@@ -129,7 +129,7 @@ void MKLDNNPlugin::MKLDNNEdge::allocate() {
 
     auto parentPtr = getParent();
     memoryPtr.reset(new MKLDNNMemory(parentPtr->getSelectedPrimitiveDescriptor()->getEngine()));
-    memoryPtr->Create(inputDesc);
+    memoryPtr->Create(inputDesc, mem_ptr);
     status = Status::Allocated;
 }
 
@@ -63,7 +63,7 @@ public:
 
     void changeStatus(Status state);
 
-    virtual void allocate();
+    virtual void allocate(const void* mem_ptr = nullptr);
     virtual void validate();
 
     const std::shared_ptr<MKLDNNNode> getParent() const;
@@ -35,6 +35,7 @@
 #include <map>
 #include <vector>
 #include <fstream>
+#include <set>
 #include <caseless.hpp>
 
 #include "mkldnn_graph.h"
@@ -46,11 +47,15 @@
 #include "mkldnn_extension_mngr.h"
 #include "mkldnn/omp_manager.h"
 #include <omp.h>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
 #include <graph_tools.hpp>
 #include <cpp_interfaces/ie_executor_manager.hpp>
 #include "ie_algorithm.hpp"
 #include "mkldnn_infer_request.h"
 #include "mkldnn_async_infer_request.h"
+#include "mkldnn_memory_solver.h"
 // #define DEBUG_DUMP_PATH "/home/user/HDD/gna-mkldnn/"
 // #define DEBUG_DUMP_NEW_FOLDER_PER_INFER
 #ifdef DEBUG_DUMP_PATH
@@ -65,6 +70,19 @@ using namespace MKLDNNPlugin::cpu;
 using namespace InferenceEngine;
 using namespace InferenceEngine::MKLDNNPlugin;
 
+// Spreads the cores between the streams of a network. Called in the executor
+// thread of the stream, the OpenMP team of that thread is then used by every
+// inference of the stream.
+static void BindStreamThreads(int stream, int streams, bool bind) {
+#if !(defined(__APPLE__) || defined(_WIN32))
+    if (bind) {
+        OpenMpManager::bindOpenMpThreadsToCoreGroup(stream, streams);
+        return;
+    }
+#endif
+    omp_set_num_threads(std::max(1, OpenMpManager::getOpenMpThreadNumber() / streams));
+}
+
 void BindThreads(mkldnn::engine eng) {
     static bool alreadyBind = false;
     if (!alreadyBind) {
@@ -88,12 +106,15 @@ void BindThreads(mkldnn::engine eng) {
     }
 }
 
-void MKLDNNGraph::CreateGraph(ICNNNetwork &network, const MKLDNNExtensionManager::Ptr& extMgr) {
+void MKLDNNGraph::CreateGraph(ICNNNetwork &network, const MKLDNNExtensionManager::Ptr& extMgr,
+                              const MKLDNNWeightsSharing::Ptr& w_cache) {
     if (IsReady()) {
         ForgetGraphData();
     }
+    weightsCache = w_cache;
 
-    if (config.useThreadBinding) BindThreads(eng);
+    // Streams bind the threads of their executors to their own cores
+    if (config.useThreadBinding && config.throughputStreams <= 1) BindThreads(eng);
 
     // go over the inputs and create input primitives
     InputsDataMap inputs;
@@ -205,6 +226,9 @@ void MKLDNNGraph::CreateGraph(ICNNNetwork &network, const MKLDNNExtensionManager
         graphNode->execute(stream);
     }
 
+    if (config.interOpThreads > 1)
+        CreateInterOpScheduler();
+
     status = Ready;
 }
 
@@ -334,13 +358,129 @@ void MKLDNNGraph::InitEdges() {
     }
 }
 
+static size_t getMaxRssKb() {
+#if !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<size_t>(usage.ru_maxrss);
+#endif
+    return 0;
+}
+
+// Returns the edge that owns the memory of the given one
+static MKLDNNEdgePtr getRootEdge(MKLDNNEdgePtr edge) {
+    while (edge->getStatus() == MKLDNNEdge::Status::NotAllocated)
+        edge = edge->getSharedEdge();
+    return edge;
+}
+
+void MKLDNNGraph::AllocateWithReuse() {
+    std::map<MKLDNNNode*, int> nodeIdx;
+    std::set<MKLDNNNode*> constNodes;
+    for (size_t i = 0; i < graphNodes.size(); i++) {
+        nodeIdx[graphNodes[i].get()] = static_cast<int>(i);
+        if (graphNodes[i]->isConstant(false))
+            constNodes.insert(graphNodes[i].get());
+    }
+
+    // Edges sharing one memory form a group that lives from the first node writing
+    // into it till the last node reading from it.
+    struct Group {
+        MKLDNNEdgePtr root;
+        int start;
+        int finish;
+        bool reusable;
+    };
+    std::vector<Group> groups;
+    std::map<MKLDNNEdge*, size_t> groupIdx;
+    for (auto& edge : graphEdges) {
+        auto root = getRootEdge(edge);
+        if (root->getStatus() != MKLDNNEdge::Status::NeedAllocation)
+            continue;
+        auto it = groupIdx.find(root.get());
+        if (it == groupIdx.end()) {
+            it = groupIdx.insert({root.get(), groups.size()}).first;
+            groups.push_back({root, static_cast<int>(graphNodes.size()), -1, true});
+        }
+        Group& group = groups[it->second];
+
+        auto parent = edge->getParent();
+        auto child = edge->getChild();
+        group.start = std::min(group.start, nodeIdx[parent.get()]);
+        group.finish = std::max(group.finish, nodeIdx[child.get()]);
+
+        // Memory seen by the user (swapped for the blob pointers by the infer requests),
+        // kept between inferences or filled once at load time needs its own allocation.
+        if (parent->getType() == Input || parent->getType() == MemoryInput ||
+                child->getType() == Output || child->getType() == MemoryOutput ||
+                constNodes.count(parent.get()))
+            group.reusable = false;
+    }
+
+    std::vector<MKLDNNMemorySolver::Box> boxes;
+    std::vector<size_t> boxGroup;
+    size_t separateSize = 0;
+    size_t ownSize = 0;
+    for (size_t i = 0; i < groups.size(); i++) {
+        Group& group = groups[i];
+        mkldnn::memory::desc desc = group.root->getInputDesc();
+        size_t size = mkldnn::memory::primitive_desc(desc, eng).get_size();
+        separateSize += size;
+
+        // Padded areas have to stay zero, while a shared buffer keeps whatever
+        // the previous owner wrote there.
+        size_t dense = MKLDNNExtensionUtils::sizeOfDataType(mkldnn::memory::data_type(desc.data.data_type));
+        for (int d = 0; d < desc.data.ndims; d++)
+            dense *= desc.data.dims[d];
+        if (dense != size)
+            group.reusable = false;
+
+        if (!group.reusable || group.finish < group.start) {
+            ownSize += size;
+            group.root->allocate();
+            continue;
+        }
+        boxes.push_back({group.start, group.finish, size, 0});
+        boxGroup.push_back(i);
+    }
+
+    const size_t alignment = 64;
+    size_t arenaSize = MKLDNNMemorySolver::solve(boxes, alignment);
+    memoryArena.assign(arenaSize + alignment - 1, 0);
+    auto arenaPtr = reinterpret_cast<uintptr_t>(memoryArena.data());
+    auto* arenaBase = memoryArena.data() + (alignment - arenaPtr % alignment) % alignment;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        groups[boxGroup[i]].root->allocate(arenaBase + boxes[i].offset);
+    }
+
+    if (config.collectPerfCounters) {
+        LogInfo("Edge memory: %zu bytes in separate buffers, %zu bytes with reuse "
+                "(arena of %zu bytes for %zu of %zu buffers). "
+                "The graph is shared by all infer requests of the network.",
+                separateSize, ownSize + arenaSize, arenaSize, boxes.size(), groups.size());
+    }
+}
+
 void MKLDNNGraph::Allocate() {
     for (auto& node : graphNodes) {
         node->initEdges();
     }
-    for (auto& edge : graphEdges) {
-        edge->allocate();
+
+    size_t rssBefore = getMaxRssKb();
+    // The arena lifetimes follow the sequential order of the nodes, sharing
+    // memory between branches would serialize them again
+    if (config.reuseEdgeMemory && config.interOpThreads <= 1) {
+        AllocateWithReuse();
+    } else {
+        for (auto& edge : graphEdges) {
+            edge->allocate();
+        }
+    }
+    if (config.collectPerfCounters) {
+        LogInfo("Peak RSS: %zu KB before edge allocation, %zu KB after (edge memory reuse %s)",
+                rssBefore, getMaxRssKb(), config.reuseEdgeMemory && config.interOpThreads <= 1 ? "on" : "off");
     }
+
     for (auto& node : graphNodes) {
         node->resolveNotAllocatedEdges();
     }
@@ -351,11 +491,102 @@ void MKLDNNGraph::Allocate() {
 
 void MKLDNNGraph::CreatePrimitives() {
     for (auto& node : graphNodes) {
+        node->weightCache = weightsCache;
         node->createPrimitive();
     }
 }
 
-void MKLDNNGraph::PushInputData(const std::string& name, const InferenceEngine::Blob::Ptr &in) {
+// Number of bytes from the data handle a memory may touch, views of a bigger
+// buffer included
+static size_t getMemoryExtent(const MKLDNNMemory& memory) {
+    auto desc = memory.GetDescriptor().data;
+    const auto& blocking = desc.layout_desc.blocking;
+    size_t extent = 0;
+    for (int d = 0; d < desc.ndims; d++) {
+        size_t block = blocking.block_dims[d];
+        if (block == 0)
+            continue;
+        extent = std::max(extent, static_cast<size_t>(blocking.padding_dims[d] / block * blocking.strides[0][d]));
+        if (block > 1)
+            extent = std::max(extent, static_cast<size_t>(block * blocking.strides[1][d]));
+    }
+    size_t itemSize = MKLDNNExtensionUtils::sizeOfDataType(mkldnn::memory::data_type(desc.data_type));
+    return std::max((extent + blocking.offset_padding) * itemSize, memory.GetSize());
+}
+
+void MKLDNNGraph::CreateInterOpScheduler() {
+    std::map<MKLDNNNode*, size_t> nodeIdx;
+    for (size_t i = 0; i < graphNodes.size(); i++)
+        nodeIdx[graphNodes[i].get()] = i;
+
+    // Edges are not the only ordering between nodes: in-place nodes overwrite
+    // the memory of their inputs, and memory may be shared in other ways, so
+    // every access to overlapping bytes keeps the order of the sorted graph
+    // unless both of them only read.
+    struct Access {
+        size_t node;
+        const uint8_t* begin;
+        const uint8_t* end;
+        bool write;
+    };
+    auto accessOf = [](size_t node, const MKLDNNEdgePtr& edge, bool write) {
+        auto& memory = edge->getMemory();
+        auto* begin = static_cast<const uint8_t*>(memory.GetData());
+        return Access{node, begin, begin + getMemoryExtent(memory), write};
+    };
+
+    std::vector<std::vector<size_t>> preds(graphNodes.size());
+    std::vector<Access> accesses;
+    size_t barrier = graphNodes.size();
+    for (size_t i = 0; i < graphNodes.size(); i++) {
+        auto& node = graphNodes[i];
+        std::set<size_t> deps;
+
+        // Memory outputs write the memory of their input twin behind the graph's back
+        if (node->getType() == MemoryOutput) {
+            for (size_t j = 0; j < i; j++)
+                deps.insert(j);
+            barrier = i;
+        } else if (barrier < i) {
+            deps.insert(barrier);
+        }
+
+        std::vector<Access> own;
+        for (size_t p = 0; p < node->getParentEdges().size(); p++) {
+            auto edge = node->getParentEdgeAt(p);
+            deps.insert(nodeIdx[edge->getParent().get()]);
+            own.push_back(accessOf(i, edge, false));
+        }
+        for (size_t c = 0; c < node->getChildEdges().size(); c++)
+            own.push_back(accessOf(i, node->getChildEdgeAt(c), true));
+
+        for (auto& a : own) {
+            for (auto& b : accesses) {
+                if ((a.write || b.write) && a.begin < b.end && b.begin < a.end)
+                    deps.insert(b.node);
+            }
+        }
+        accesses.insert(accesses.end(), own.begin(), own.end());
+
+        deps.erase(i);
+        preds[i].assign(deps.begin(), deps.end());
+    }
+
+    // Pool threads inherit the affinity of this thread, which binding has
+    // pinned to a single core. They get back every CPU of the team of this
+    // thread (the process or the stream), and so do their own OpenMP teams.
+    std::function<void()> workerInit;
+#if !(defined(__APPLE__) || defined(_WIN32))
+    if (config.useThreadBinding) {
+        cpu_set_t teamCpus;
+        OpenMpManager::getOpenMpTeamCpuSet(&teamCpus);
+        workerInit = [teamCpus] { OpenMpManager::bindCurrentThreadToCpuSet(&teamCpus); };
+    }
+#endif
+    interOpScheduler.reset(new MKLDNNInterOpScheduler(preds, config.interOpThreads, workerInit));
+}
+
+void MKLDNNGraph::PushInputData(const std::string& name, const InferenceEngine::Blob::Ptr &in, size_t &copiedBytes) {
     if (!IsReady()) THROW_IE_EXCEPTION<< "Wrong state. Topology not ready.";
 
     auto input = inputNodes.find(name);
@@ -365,9 +596,11 @@ void MKLDNNGraph::PushInputData(const std::string& name, const InferenceEngine::
         const void *ext_data_ptr = in->cbuffer();
         void *inter_data_ptr = input->second->getChildEdgeAt(0)->getMemory().GetData();
 
-        if (ext_data_ptr != inter_data_ptr)
-        input->second->getChildEdgeAt(0)->getMemory().SetData(MKLDNNExtensionUtils::IEPrecisionToDataType(in->getTensorDesc().getPrecision()),
-                MKLDNNMemory::GetPlainFormat(outDims), ext_data_ptr, in->byteSize(), false);
+        if (ext_data_ptr != inter_data_ptr) {
+            input->second->getChildEdgeAt(0)->getMemory().SetData(MKLDNNExtensionUtils::IEPrecisionToDataType(in->getTensorDesc().getPrecision()),
+                    MKLDNNMemory::GetPlainFormat(outDims), ext_data_ptr, in->byteSize(), false);
+            copiedBytes += in->byteSize();
+        }
 
         // todo: make sure 'name' exists in this map...
         if (_meanImages.find(name) != _meanImages.end()) {
@@ -382,7 +615,7 @@ void MKLDNNGraph::PushInputData(const std::string& name, const InferenceEngine::
     }
 }
 
-void MKLDNNGraph::PullOutputData(BlobMap &out) {
+void MKLDNNGraph::PullOutputData(BlobMap &out, size_t &copiedBytes) {
     if (!IsReady())
         THROW_IE_EXCEPTION << "Wrong state. Topology not ready.";
 
@@ -425,6 +658,7 @@ void MKLDNNGraph::PullOutputData(BlobMap &out) {
         size_t size_to_copy = intr_blob.GetSize() * MB_to_process / MB;
 
         memcpy(ext_blob_ptr, intr_blob_ptr, size_to_copy);
+        copiedBytes += size_to_copy;
     }
 }
 
@@ -563,6 +797,11 @@ void MKLDNNGraph::Infer() {
         THROW_IE_EXCEPTION << "Wrong state. Topology is not ready.";
     }
 
+    if (interOpScheduler) {
+        InferInterOp();
+        return;
+    }
+
     mkldnn::stream stream = mkldnn::stream(stream::kind::eager);
 
 #ifdef DEBUG_DUMP_NEW_FOLDER_PER_INFER
@@ -675,6 +914,28 @@ void MKLDNNGraph::Infer() {
     }
 }
 
+void MKLDNNGraph::InferInterOp() {
+    // OpenMP limits are per thread, so every worker sets the budget of its node
+    // and the caller gets its own limit back at the end
+    int totalThreads = omp_get_max_threads();
+
+    interOpScheduler->run([&](size_t i, int threads) {
+        auto& node = graphNodes[i];
+        PERF(node);
+        node->setDynamicBatchLim(config.batchLimit);
+        if (node->isConstant(true))
+            return;
+
+        omp_set_num_threads(threads);
+        // eager streams are not thread safe, each node gets its own
+        mkldnn::stream stream = mkldnn::stream(stream::kind::eager);
+        IE_PROFILING_AUTO_SCOPE_STRING(node->name.c_str())
+        node->execute(stream);
+    }, totalThreads);
+
+    omp_set_num_threads(totalThreads);
+}
+
 MKLDNNNodePtr MKLDNNGraph::FindNodeWithName(const std::string& name) const {
     if (inputNodes.empty()) {
         return std::shared_ptr<MKLDNNNode>();
@@ -761,6 +1022,17 @@ void MKLDNNGraph::GetPerfData(std::map<std::string, InferenceEngine::InferenceEn
     for (int i = 1; i < graphNodes.size(); i++) {
         getPerfMapFor(perfMap, graphNodes[i]);
     }
+
+    // One entry per fusion pass, exec_type tells how many nodes it folded away
+    for (auto& pass : fusionStats) {
+        InferenceEngine::InferenceEngineProfileInfo &pc = perfMap["fusion_" + pass.first];
+        pc.cpu_uSec = pc.realTime_uSec = 0;
+        pc.status = InferenceEngine::InferenceEngineProfileInfo::OPTIMIZED_OUT;
+        std::string execType = "fused_nodes_" + std::to_string(pass.second);
+        execType.copy(pc.exec_type, sizeof(pc.exec_type) / sizeof(pc.exec_type[0]), 0);
+        std::string layerType = "Fusion";
+        layerType.copy(pc.layer_type, sizeof(pc.layer_type) / sizeof(pc.layer_type[0]), 0);
+    }
 }
 
 void MKLDNNGraph::setConfig(const Config &cfg) {
@@ -804,36 +1076,62 @@ MKLDNNExecNetwork::CreateInferRequestImpl(InferenceEngine::InputsDataMap network
 
 MKLDNNExecNetwork::MKLDNNExecNetwork(InferenceEngine::ICNNNetwork &network,
                                      const Config &cfg,
-                                     const MKLDNNExtensionManager::Ptr& extMgr) : extensionManager(extMgr) {
-    graph.reset(new MKLDNNGraph());
-    graph->setConfig(cfg);
-
-    if (graph->getProperty().exclusiveAsyncRequests) {
+                                     const MKLDNNExtensionManager::Ptr& extMgr) : nextStream(0), extensionManager(extMgr) {
+    Config streamCfg = cfg;
+    if (streamCfg.exclusiveAsyncRequests) {
         ExecutorManager *executorManager = ExecutorManager::getInstance();
         _taskExecutor = executorManager->getExecutor(TargetDeviceInfo::name(TargetDevice::eCPU));
+        // all the networks share one executor, so a single stream is all it can run
+        streamCfg.throughputStreams = 1;
     }
 
-    // initialization in taskExecutor thread
-    auto task = std::make_shared<InferenceEngine::Task>([&]() {
-        graph->CreateGraph(network, extensionManager);
-    });
+    int streams = streamCfg.throughputStreams;
+    MKLDNNWeightsSharing::Ptr weightsCache;
+    if (streams > 1) {
+        weightsCache = std::make_shared<MKLDNNWeightsSharing>();
+    }
 
-    _taskExecutor->startTask(task);
-    Task::Status sts = task->wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
+    for (int s = 0; s < streams; s++) {
+        if (s == 0) {
+            streamExecutors.push_back(_taskExecutor);
+            streamSynchronizers.push_back(_taskSynchronizer);
+        } else {
+            streamExecutors.push_back(std::make_shared<TaskExecutor>("MKLDNNStream" + std::to_string(s)));
+            streamSynchronizers.push_back(std::make_shared<TaskSynchronizer>());
+        }
 
-    if (sts == Task::TS_ERROR) task->checkException();
+        MKLDNNGraph::Ptr graph(new MKLDNNGraph());
+        graph->setConfig(streamCfg);
+        graphs.push_back(graph);
+
+        // initialization in taskExecutor thread
+        auto task = std::make_shared<InferenceEngine::Task>([&, s]() {
+            if (streams > 1)
+                BindStreamThreads(s, streams, streamCfg.useThreadBinding);
+            graph->CreateGraph(network, extensionManager, weightsCache);
+        });
+
+        streamExecutors[s]->startTask(task);
+        Task::Status sts = task->wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
+
+        if (sts == Task::TS_ERROR) task->checkException();
+    }
 }
 
 void MKLDNNExecNetwork::setProperty(const std::map<std::string, std::string> &properties) {
-    if (graph)  // TODO: graph field cannot be empty
+    for (auto& graph : graphs)
         graph->setProperty(properties);
 }
 
 void MKLDNNExecNetwork::CreateInferRequest(InferenceEngine::IInferRequest::Ptr &asyncRequest) {
+    // Requests are spread over the streams round-robin, so the streams are busy
+    // as long as the application keeps at least as many requests in flight
+    size_t stream = nextStream++ % graphs.size();
+
     auto syncRequestImpl = CreateInferRequestImpl(_networkInputs, _networkOutputs);
     syncRequestImpl->setPointerToExecutableNetworkInternal(shared_from_this());
-    auto asyncRequestImpl = std::make_shared<MKLDNNAsyncInferRequest>(syncRequestImpl, _taskExecutor,
-                                                                      _taskSynchronizer, _callbackExecutor);
+    auto asyncRequestImpl = std::make_shared<MKLDNNAsyncInferRequest>(syncRequestImpl, streamExecutors[stream],
+                                                                      streamSynchronizers[stream], _callbackExecutor);
     asyncRequest.reset(new InferRequestBase<MKLDNNAsyncInferRequest>(asyncRequestImpl),
                        [](IInferRequest *p) { p->Release(); });
 
@@ -842,10 +1140,10 @@ void MKLDNNExecNetwork::CreateInferRequest(InferenceEngine::IInferRequest::Ptr &
     auto mkldnnSyncRequest = dynamic_cast<MKLDNNInferRequest *>(syncRequestImpl.get());
     if (!mkldnnSyncRequest)
         THROW_IE_EXCEPTION << " Cannot get mkldnn sync request.";
-    mkldnnSyncRequest->SetGraph(graph);
+    mkldnnSyncRequest->SetGraph(graphs[stream]);
 }
 
 MKLDNNExecNetwork::~MKLDNNExecNetwork() {
-    graph.reset();
+    graphs.clear();
     extensionManager.reset();
 }
@@ -35,6 +35,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 #include <cpp_interfaces/impl/ie_executable_network_thread_safe_default.hpp>
 
 #include "mkldnn_memory.h"
@@ -45,6 +46,8 @@
 #include "mkldnn_node.h"
 #include "mkldnn_edge.h"
 #include "mkldnn_extension_utils.h"
+#include "mkldnn_weights_cache.h"
+#include "mkldnn_inter_op_scheduler.h"
 
 namespace MKLDNNPlugin {
 
@@ -74,14 +77,18 @@ public:
     void getInputBlobs(InferenceEngine::BlobMap &in_map);
     void getOutputBlobs(InferenceEngine::BlobMap &out_map);
 
-    void CreateGraph(InferenceEngine::ICNNNetwork &network, const MKLDNNExtensionManager::Ptr& extMgr);
+    void CreateGraph(InferenceEngine::ICNNNetwork &network, const MKLDNNExtensionManager::Ptr& extMgr,
+                     const MKLDNNWeightsSharing::Ptr& w_cache = nullptr);
 
     bool hasMeanImageFor(const std::string& name) {
         return _meanImages.find(name) != _meanImages.end();
     }
 
-    void PushInputData(const std::string& name, const InferenceEngine::Blob::Ptr &in);
-    void PullOutputData(InferenceEngine::BlobMap &out);
+    // Both add the bytes they copy between user blobs and graph memory to
+    // copiedBytes, which belongs to the infer request as the graph is shared
+    // by all the requests of a stream
+    void PushInputData(const std::string& name, const InferenceEngine::Blob::Ptr &in, size_t &copiedBytes);
+    void PullOutputData(InferenceEngine::BlobMap &out, size_t &copiedBytes);
 
     void Infer();
 
@@ -101,6 +108,10 @@ public:
         return eng;
     }
 
+    std::map<std::string, int>& GetFusionStats() {
+        return fusionStats;
+    }
+
     void GetPerfData(std::map<std::string, InferenceEngine::InferenceEngineProfileInfo> &perfMap) const;
 
 protected:
@@ -113,6 +124,7 @@ protected:
 
     void ForgetGraphData() {
         status = NotReady;
+        interOpScheduler.reset();
         eng = mkldnn::engine(mkldnn::engine::kind::cpu, 0);
 
         inputNodes.clear();
@@ -120,6 +132,9 @@ protected:
         graphNodes.clear();
         graphEdges.clear();
         _meanImages.clear();
+        std::vector<uint8_t>().swap(memoryArena);
+        weightsCache.reset();
+        fusionStats.clear();
     }
     Status status;
     Config config;
@@ -129,6 +144,18 @@ protected:
     std::vector<MKLDNNNodePtr> graphNodes;
     std::vector<MKLDNNEdgePtr> graphEdges;
 
+    // Weights shared with the other streams of the network, if any
+    MKLDNNWeightsSharing::Ptr weightsCache;
+
+    // Runs independent nodes at the same time if CPU_INTER_OP_THREADS is above 1
+    std::unique_ptr<MKLDNNInterOpScheduler> interOpScheduler;
+
+    // Number of nodes folded away by each fusion pass of MKLDNNGraphOptimizer
+    std::map<std::string, int> fusionStats;
+
+    // Backs the intermediate edges placed by AllocateWithReuse()
+    std::vector<uint8_t> memoryArena;
+
     std::map<std::string, MeanImage> _meanImages;
 
     mkldnn::engine eng;
@@ -137,7 +164,10 @@ protected:
     void SelectOptimalPrimitiveDescriptors();
     void InitEdges();
     void Allocate();
+    void AllocateWithReuse();
     void CreatePrimitives();
+    void CreateInterOpScheduler();
+    void InferInterOp();
 
     friend class MKLDNNInferRequest;
 };
@@ -160,7 +190,12 @@ public:
     void setProperty(const std::map<std::string, std::string> &properties);
 
 protected:
-    MKLDNNGraph::Ptr graph;
+    // One graph per stream, graphs[0] is the only one unless CPU_THROUGHPUT_STREAMS is set
+    std::vector<MKLDNNGraph::Ptr> graphs;
+    // Executor and synchronizer of every stream, stream 0 uses the ones of the network
+    std::vector<InferenceEngine::ITaskExecutor::Ptr> streamExecutors;
+    std::vector<InferenceEngine::TaskSynchronizer::Ptr> streamSynchronizers;
+    std::atomic<size_t> nextStream;
     MKLDNNExtensionManager::Ptr extensionManager;
 };
 
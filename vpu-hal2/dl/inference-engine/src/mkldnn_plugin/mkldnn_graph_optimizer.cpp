@@ -29,6 +29,7 @@
 // this notice or any other notice embedded in Materials by Intel or Intel's
 // suppliers or licensors in any way.
 //
+#include <algorithm>
 #include <string>
 #include <list>
 #include <memory>
@@ -47,6 +48,9 @@ void MKLDNNGraphOptimizer::Optimize(MKLDNNGraph &graph) {
     MergeGroupConvolution(graph);
     RemoveDropped(graph);
 
+    FuseConvolutionAndScaleShift(graph);
+    RemoveDropped(graph);
+
     FuseConvolutionAndActivation(graph);
     RemoveDropped(graph);
 
@@ -59,10 +63,41 @@ void MKLDNNGraphOptimizer::Optimize(MKLDNNGraph &graph) {
     FuseConvolutionSumAndConvolutionSumActivation(graph);
     RemoveDropped(graph);
 
+    FuseFullyConnectedAndActivation(graph);
+    FusePoolingAndActivation(graph);
+    FuseEltwiseAndActivation(graph);
+    RemoveDropped(graph);
+
     RemoveDroppedEdges(graph);
 }
 
+void MKLDNNGraphOptimizer::ApplyFusion(MKLDNNGraph &graph, const FusionPattern &pattern) {
+    int &fusedNodes = graph.GetFusionStats()[pattern.name];
+    auto& graphNodes = graph.GetNodes();
+
+    for (size_t i = 0; i < graphNodes.size(); i++) {
+        std::vector<MKLDNNNodePtr> chain = {graphNodes[i]};
+        if (chain[0]->isDropped() || !pattern.chain[0](chain[0]))
+            continue;
+
+        bool matched = true;
+        for (size_t j = 1; matched && j < pattern.chain.size(); j++) {
+            if (chain.back()->getChildEdges().size() != 1) {
+                matched = false;
+                break;
+            }
+            auto next = chain.back()->getChildEdgeAt(0)->getChild();
+            matched = next->getParentEdges().size() == 1 && pattern.chain[j](next);
+            chain.push_back(next);
+        }
+
+        if (matched)
+            fusedNodes += pattern.fuse(graph, chain);
+    }
+}
+
 void MKLDNNGraphOptimizer::MergeGroupConvolution(MKLDNNGraph &graph) {
+    int &fusedNodes = graph.GetFusionStats()["GroupConvolution"];
     for (auto node : graph.GetNodes()) {
         // Split with at least 2 Convolutions
         if (!IsOneOf(node->getType(), {Split}) || node->getChildEdges().size() < 2 ||
@@ -107,43 +142,133 @@ void MKLDNNGraphOptimizer::MergeGroupConvolution(MKLDNNGraph &graph) {
             convInDims[1] += (peerInEdge->getDims())[1];
             convOutDims[1] += (peer->getChildEdgeAt(0)->getDims())[1];
             peer->remove();
+            fusedNodes++;
         }
         conv->inDims[0] = convInDims;
         conv->outDims[0] = convOutDims;
 
         DropNode(graph, split);
         DropNode(graph, concat);
+        fusedNodes += 2;
     }
 }
 
+void MKLDNNGraphOptimizer::FuseConvolutionAndScaleShift(MKLDNNGraph &graph) {
+    auto isFoldableConvolution = [](const MKLDNNNodePtr& node) {
+        auto * convLayer = dynamic_cast<ConvolutionLayer *>(node->getCnnLayer().get());
+        return node->getType() == Convolution && node->getMergeWith().empty() && node->fusedWith.empty() &&
+               convLayer != nullptr && convLayer->_out_depth != 0 &&
+               convLayer->_weights != nullptr && convLayer->_weights->precision() == Precision::FP32 &&
+               convLayer->_weights->size() % convLayer->_out_depth == 0 &&
+               (convLayer->_biases == nullptr || convLayer->_biases->size() == 0 ||
+                (convLayer->_biases->precision() == Precision::FP32 &&
+                 convLayer->_biases->size() == convLayer->_out_depth));
+    };
+
+    // y = scale * x + shift with one scale and shift per channel or for the whole tensor
+    auto isLinear = [](const MKLDNNNodePtr& node) {
+        if (node->getType() == Power) {
+            auto * powerLayer = dynamic_cast<PowerLayer *>(node->getCnnLayer().get());
+            return powerLayer != nullptr && powerLayer->power == 1.0f;
+        }
+        if (node->getType() == ScaleShift) {
+            auto * scaleShiftLayer = dynamic_cast<ScaleShiftLayer *>(node->getCnnLayer().get());
+            return scaleShiftLayer != nullptr &&
+                   (scaleShiftLayer->_weights == nullptr || scaleShiftLayer->_weights->precision() == Precision::FP32) &&
+                   (scaleShiftLayer->_biases == nullptr || scaleShiftLayer->_biases->precision() == Precision::FP32);
+        }
+        return false;
+    };
+
+    auto fold = [&](MKLDNNGraph& graph, std::vector<MKLDNNNodePtr>& chain) {
+        auto conv = chain[0];
+        auto linear = chain[1];
+        auto * convLayer = dynamic_cast<ConvolutionLayer *>(conv->getCnnLayer().get());
+        size_t channels = convLayer->_out_depth;
+
+        std::vector<float> scales(channels, 1.0f);
+        std::vector<float> shifts(channels, 0.0f);
+        if (linear->getType() == Power) {
+            auto * powerLayer = dynamic_cast<PowerLayer *>(linear->getCnnLayer().get());
+            std::fill(scales.begin(), scales.end(), powerLayer->scale);
+            std::fill(shifts.begin(), shifts.end(), powerLayer->offset);
+        } else {
+            auto * scaleShiftLayer = dynamic_cast<ScaleShiftLayer *>(linear->getCnnLayer().get());
+            auto read = [channels](const Blob::Ptr& blob, std::vector<float>& values) {
+                if (blob == nullptr)
+                    return true;
+                if (blob->size() != 1 && blob->size() != channels)
+                    return false;
+                const float *data = blob->cbuffer().as<const float *>();
+                for (size_t c = 0; c < channels; c++)
+                    values[c] = data[blob->size() == 1 ? 0 : c];
+                return true;
+            };
+            if (!read(scaleShiftLayer->_weights, scales) || !read(scaleShiftLayer->_biases, shifts))
+                return 0;
+        }
+
+        // The layers still belong to the caller's network: fold into a copy of the convolution
+        auto weights = make_shared_blob<float>(convLayer->_weights->getTensorDesc());
+        weights->allocate();
+        const float *srcWeights = convLayer->_weights->cbuffer().as<const float *>();
+        float *dstWeights = weights->buffer().as<float *>();
+        size_t perChannel = weights->size() / channels;
+        for (size_t c = 0; c < channels; c++)
+            for (size_t i = 0; i < perChannel; i++)
+                dstWeights[c * perChannel + i] = srcWeights[c * perChannel + i] * scales[c];
+
+        auto biases = make_shared_blob<float>(TensorDesc(Precision::FP32, {channels}, Layout::C));
+        biases->allocate();
+        const float *srcBiases = convLayer->_biases != nullptr && convLayer->_biases->size() == channels ?
+                                 convLayer->_biases->cbuffer().as<const float *>() : nullptr;
+        float *dstBiases = biases->buffer().as<float *>();
+        for (size_t c = 0; c < channels; c++)
+            dstBiases[c] = (srcBiases ? srcBiases[c] : 0.0f) * scales[c] + shifts[c];
+
+        auto foldedLayer = std::make_shared<ConvolutionLayer>(*convLayer);
+        foldedLayer->_weights = weights;
+        foldedLayer->_biases = biases;
+        foldedLayer->blobs["weights"] = weights;
+        foldedLayer->blobs["biases"] = biases;
+        conv->cnnLayer = foldedLayer;
+
+        conv->fuseWith(linear);
+        DropNode(graph, linear);
+        return 1;
+    };
+
+    ApplyFusion(graph, {"ConvolutionScaleShift", {isFoldableConvolution, isLinear}, fold});
+}
+
 void MKLDNNGraphOptimizer::FuseBatchNormWithScale(MKLDNNGraph &graph) {
-    auto &graphNodes = graph.GetNodes();
-
-    for (int i = 0; i < graphNodes.size(); i++) {
-        const auto& bn = graphNodes[i];
-        if (bn->getType() == BatchNormalization) {
-            const auto& outputNodes = graph.GetOutputNodes();
-            const std::string node_name = bn->getName();
-            // Check that the node is not output node
-            if (std::find_if(outputNodes.begin(), outputNodes.end(),
+    auto isBatchNorm = [&](const MKLDNNNodePtr& node) {
+        const auto& outputNodes = graph.GetOutputNodes();
+        const std::string node_name = node->getName();
+        // Check that the node is not output node
+        return node->getType() == BatchNormalization &&
+               std::find_if(outputNodes.begin(), outputNodes.end(),
                             [&node_name](const MKLDNNNodePtr& x) {
-                                return x->getName() == node_name;}) == outputNodes.end()) {
-                if (bn->getChildEdges().size() == 1) {
-                    auto child = bn->getChildEdgeAt(0)->getChild();
-                    if (child->type == ScaleShift) {
-                        bn->fuseWith(child);
-                        DropNode(graph, child);
-                    }
-                }
-            }
-        }
-    }
+                                return x->getName() == node_name;}) == outputNodes.end();
+    };
+    auto isScaleShift = [](const MKLDNNNodePtr& node) {
+        return node->type == ScaleShift;
+    };
+
+    ApplyFusion(graph, {"BatchNormScaleShift", {isBatchNorm, isScaleShift},
+                        [&](MKLDNNGraph& graph, std::vector<MKLDNNNodePtr>& chain) {
+        chain[0]->fuseWith(chain[1]);
+        DropNode(graph, chain[1]);
+        return 1;
+    }});
 }
 
 void MKLDNNGraphOptimizer::FuseConvolutionAndActivation(MKLDNNGraph &graph) {
-    auto& graphNodes = graph.GetNodes();
+    auto isConvolution = [](const MKLDNNNodePtr& node) {
+        return node->getType() == Convolution;
+    };
 
-    auto isFusingSupported = [&](MKLDNNNodePtr node) {
+    auto isFusingSupported = [&](const MKLDNNNodePtr& node) {
         if (!node->getCnnLayer())
             return false;
 
@@ -151,38 +276,24 @@ void MKLDNNGraphOptimizer::FuseConvolutionAndActivation(MKLDNNGraph &graph) {
                 (node->getCnnLayer()->type == "ReLU" || node->getCnnLayer()->type == "ELU");
     };
 
-    for (int i = 0; i < graphNodes.size(); i++) {
-        if (graphNodes[i]->getType() == Convolution) {
-            auto conv = graphNodes[i];
+    // ReLU and ELU are monotonic, so they commute with a max pooling
+    auto isMaxPooling = [](const MKLDNNNodePtr& node) {
+        if (node->type != Pooling)
+            return false;
+        return dynamic_cast<PoolingLayer *>(node->getCnnLayer().get())->_type == PoolingLayer::PoolType::MAX;
+    };
 
-            auto fuse = [&] (MKLDNNNodePtr relu) {
-                conv->setType(Convolution_Activation);
-                conv->fuseWith(relu);
-                DropNode(graph, relu);
-            };
+    auto fuse = [&](MKLDNNGraph& graph, std::vector<MKLDNNNodePtr>& chain) {
+        auto conv = chain.front();
+        auto relu = chain.back();
+        conv->setType(Convolution_Activation);
+        conv->fuseWith(relu);
+        DropNode(graph, relu);
+        return 1;
+    };
 
-            if (conv->getChildEdges().size() == 1) {
-                auto ch1 = conv->getChildEdgeAt(0)->getChild();
-
-                if (isFusingSupported(ch1)) {
-                    fuse(ch1);
-                } else {
-                    if (ch1->type == Pooling) {
-                        auto pool = ch1;
-                        bool is_max_pool =
-                                dynamic_cast<PoolingLayer *>(pool->getCnnLayer().get())->_type ==
-                                PoolingLayer::PoolType::MAX;
-
-                        if (is_max_pool && pool->getChildEdges().size() == 1) {
-                            auto ch2 = pool->getChildEdgeAt(0)->getChild();
-                            if (isFusingSupported(ch2))
-                                fuse(ch2);
-                        }
-                    }
-                }
-            }
-        }
-    }
+    ApplyFusion(graph, {"ConvolutionActivation", {isConvolution, isFusingSupported}, fuse});
+    ApplyFusion(graph, {"ConvolutionActivation", {isConvolution, isMaxPooling, isFusingSupported}, fuse});
 }
 
 /**
@@ -253,6 +364,7 @@ static bool is_data_dependency(const std::shared_ptr<MKLDNNNode> &parent,
 
 void MKLDNNGraphOptimizer::FuseConvolutionSumAndConvolutionSumActivation(MKLDNNGraph &graph) {
     std::vector<MKLDNNNodePtr> &graphNodes = graph.GetNodes();
+    int &fusedNodes = graph.GetFusionStats()["ConvolutionSum"];
 
     auto isFusingSupported = [&](MKLDNNNodePtr node) {
         if (!node->getCnnLayer())
@@ -337,11 +449,52 @@ void MKLDNNGraphOptimizer::FuseConvolutionSumAndConvolutionSumActivation(MKLDNNG
 
         if (lastNode != sum) {
             lastNode->remove();
+            fusedNodes++;
         }
         sum->remove();
+        fusedNodes++;
     }
 }
 
+/*
+ *  The primitives of these nodes take no post-ops: the fused activation runs
+ *  as a separate eltwise primitive, but in place on the node output, which
+ *  saves the intermediate buffer and a node dispatch.
+ */
+static bool isActivation(const MKLDNNNodePtr& node) {
+    return node->getType() == Activation && node->getCnnLayer();
+}
+
+void MKLDNNGraphOptimizer::FuseFullyConnectedAndActivation(MKLDNNGraph &graph) {
+    ApplyFusion(graph, {"FullyConnectedActivation", {
+        [](const MKLDNNNodePtr& node) { return node->getType() == FullyConnected; }, isActivation
+    }, [&](MKLDNNGraph& graph, std::vector<MKLDNNNodePtr>& chain) {
+        chain[0]->fuseWith(chain[1]);
+        DropNode(graph, chain[1]);
+        return 1;
+    }});
+}
+
+void MKLDNNGraphOptimizer::FusePoolingAndActivation(MKLDNNGraph &graph) {
+    ApplyFusion(graph, {"PoolingActivation", {
+        [](const MKLDNNNodePtr& node) { return node->getType() == Pooling; }, isActivation
+    }, [&](MKLDNNGraph& graph, std::vector<MKLDNNNodePtr>& chain) {
+        chain[0]->fuseWith(chain[1]);
+        DropNode(graph, chain[1]);
+        return 1;
+    }});
+}
+
+void MKLDNNGraphOptimizer::FuseEltwiseAndActivation(MKLDNNGraph &graph) {
+    ApplyFusion(graph, {"EltwiseActivation", {
+        [](const MKLDNNNodePtr& node) { return node->getType() == Eltwise; }, isActivation
+    }, [&](MKLDNNGraph& graph, std::vector<MKLDNNNodePtr>& chain) {
+        chain[0]->fuseWith(chain[1]);
+        DropNode(graph, chain[1]);
+        return 1;
+    }});
+}
+
 
 void MKLDNNGraphOptimizer::RemoveIdentityOperator(MKLDNNGraph &graph) {
     for (MKLDNNNodePtr& node : graph.GetNodes()) {
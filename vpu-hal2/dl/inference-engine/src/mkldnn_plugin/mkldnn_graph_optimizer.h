@@ -32,6 +32,8 @@
 #pragma once
 
 #include "mkldnn_graph.h"
+#include <functional>
+#include <string>
 #include <vector>
 
 namespace MKLDNNPlugin {
@@ -44,10 +46,29 @@ public:
     void Optimize(MKLDNNGraph& graph);
 
 private:
+    typedef std::function<bool(const MKLDNNNodePtr&)> NodePredicate;
+
+    /**
+     * A chain of nodes to fuse: every predicate matches one node, and each node
+     * but the first is the only consumer of the previous one and has no other input.
+     * fuse rewrites a matched chain and returns the number of nodes it folded away.
+     */
+    struct FusionPattern {
+        std::string name;
+        std::vector<NodePredicate> chain;
+        std::function<int(MKLDNNGraph&, std::vector<MKLDNNNodePtr>&)> fuse;
+    };
+
+    void ApplyFusion(MKLDNNGraph& graph, const FusionPattern& pattern);
+
     void MergeGroupConvolution(MKLDNNGraph& graph);
+    void FuseConvolutionAndScaleShift(MKLDNNGraph &graph);
     void FuseConvolutionAndActivation(MKLDNNGraph &graph);
     void FuseBatchNormWithScale(MKLDNNGraph& graph);
     void FuseConvolutionSumAndConvolutionSumActivation(MKLDNNGraph &graph);
+    void FuseFullyConnectedAndActivation(MKLDNNGraph &graph);
+    void FusePoolingAndActivation(MKLDNNGraph &graph);
+    void FuseEltwiseAndActivation(MKLDNNGraph &graph);
     void RemoveIdentityOperator(MKLDNNGraph& graph);
     void RemoveDropped(MKLDNNGraph& graph);
     void RemoveDroppedEdges(MKLDNNGraph& graph);
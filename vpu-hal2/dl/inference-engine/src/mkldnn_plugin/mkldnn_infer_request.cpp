@@ -55,7 +55,7 @@ template <typename T> void MKLDNNPlugin::MKLDNNInferRequest::pushInput(const std
         THROW_IE_EXCEPTION << "Input data was not allocated.";
     }
 
-    graph->PushInputData(inputName, inputBlob);
+    graph->PushInputData(inputName, inputBlob, copiedBytes);
 }
 
 void MKLDNNPlugin::MKLDNNInferRequest::Infer() {
@@ -64,6 +64,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::Infer() {
     if (!graph || !graph->IsReady()) {
         THROW_IE_EXCEPTION << "Network not loaded.";
     }
+    copiedBytes = 0;
     changeDefaultPtr();
     // need to retain converted blobs until infer finish
     std::vector<InferenceEngine::Blob::Ptr> convertedInputs;
@@ -96,6 +97,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::Infer() {
                 iconv->allocate();
                 in_f = dynamic_cast<InferenceEngine::TBlob<float> *>(iconv.get());
                 InferenceEngine::copyToFloat<uint16_t>(in_f->data(), input.second.get());
+                copiedBytes += iconv->byteSize();
                 pushInput<float>(input.first, iconv);
                 break;
             case InferenceEngine::Precision::I16:
@@ -107,6 +109,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::Infer() {
                     iconv->allocate();
                     in_f = dynamic_cast<InferenceEngine::TBlob<float> *>(iconv.get());
                     InferenceEngine::copyToFloat<int16_t>(in_f->data(), input.second.get());
+                    copiedBytes += iconv->byteSize();
                     pushInput<float>(input.first, iconv);
                 } else {
                     // Instead we can send I16 directly
@@ -122,6 +125,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::Infer() {
                     iconv->allocate();
                     in_f = dynamic_cast<InferenceEngine::TBlob<float> *>(iconv.get());
                     InferenceEngine::copyToFloat<uint8_t>(in_f->data(), input.second.get());
+                    copiedBytes += iconv->byteSize();
                     pushInput<float>(input.first, iconv);
                 } else {
                     // Instead we can send I8 directly
@@ -133,7 +137,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::Infer() {
         }
     }
     graph->Infer();
-    graph->PullOutputData(_outputs);
+    graph->PullOutputData(_outputs, copiedBytes);
     resetDefaultPtr();
 }
 
@@ -142,6 +146,16 @@ void MKLDNNPlugin::MKLDNNInferRequest::GetPerformanceCounts(
     if (!graph || !graph->IsReady())
         THROW_IE_EXCEPTION << "Graph is not ready!";
     graph->GetPerfData(perfMap);
+
+    // 0 if all the blobs were bound to graph memory directly
+    InferenceEngine::InferenceEngineProfileInfo &copy = perfMap["io_copy"];
+    copy.cpu_uSec = copy.realTime_uSec = 0;
+    copy.status = copiedBytes ? InferenceEngine::InferenceEngineProfileInfo::EXECUTED
+                              : InferenceEngine::InferenceEngineProfileInfo::OPTIMIZED_OUT;
+    std::string copyExecType = "copied_bytes_" + std::to_string(copiedBytes);
+    copyExecType.copy(copy.exec_type, sizeof(copy.exec_type) / sizeof(copy.exec_type[0]), 0);
+    std::string copyLayerType = "Copy";
+    copyLayerType.copy(copy.layer_type, sizeof(copy.layer_type) / sizeof(copy.layer_type[0]), 0);
 }
 
 void MKLDNNPlugin::MKLDNNInferRequest::GetBlob(const char *name, InferenceEngine::Blob::Ptr &data) {
@@ -165,8 +179,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::GetBlob(const char *name, InferenceEngine
 
         _inputs[name] = make_blob_with_precision(desc);
         _inputs[name]->allocate();
-        if (desc.getPrecision() == InferenceEngine::Precision::FP32 &&
-                graph->_meanImages.find(name) == graph->_meanImages.end() && !graph->getProperty().batchLimit) {
+        if (canBindExternal(name, desc)) {
             externalPtr[name] = _inputs[name]->buffer();
         }
         data = _inputs[name];
@@ -183,8 +196,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::GetBlob(const char *name, InferenceEngine
 
         _outputs[name] = make_blob_with_precision(blobs[name]->getTensorDesc());
         _outputs[name]->allocate();
-        if (blobs[name]->getTensorDesc().getPrecision() == InferenceEngine::Precision::FP32 &&
-                !graph->getProperty().batchLimit) {
+        if (canBindExternal(name, blobs[name]->getTensorDesc())) {
             externalPtr[name] = _outputs[name]->buffer();
         }
         data = _outputs[name];
@@ -224,8 +236,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::SetBlob(const char *name, const Inference
             THROW_IE_EXCEPTION << PARAMETER_MISMATCH_str << "Failed to set Blob with precision " << data->precision();
         }
 
-        if (data->getTensorDesc().getPrecision() == InferenceEngine::Precision::FP32 &&
-                graph->_meanImages.find(name) == graph->_meanImages.end() && !graph->getProperty().batchLimit) {
+        if (canBindExternal(name, data->getTensorDesc())) {
             externalPtr[name] = data->buffer();
         } else if (externalPtr.find(name) != externalPtr.end()) {
             externalPtr.erase(name);
@@ -241,8 +252,7 @@ void MKLDNNPlugin::MKLDNNInferRequest::SetBlob(const char *name, const Inference
             THROW_IE_EXCEPTION << PARAMETER_MISMATCH_str
                                << "Failed to set Blob with precision not corresponding user output precision";
         }
-        if (data->getTensorDesc().getPrecision() == InferenceEngine::Precision::FP32 &&
-                !graph->getProperty().batchLimit) {
+        if (canBindExternal(name, data->getTensorDesc())) {
             externalPtr[name] = data->buffer();
         } else if (externalPtr.find(name) != externalPtr.end()) {
             externalPtr.erase(name);
@@ -251,6 +261,38 @@ void MKLDNNPlugin::MKLDNNInferRequest::SetBlob(const char *name, const Inference
     }
 }
 
+bool MKLDNNPlugin::MKLDNNInferRequest::canBindExternal(const std::string& name,
+                                                       const InferenceEngine::TensorDesc& desc) {
+    if (graph->getProperty().batchLimit)
+        return false;
+
+    const MKLDNNMemory* memory = nullptr;
+    auto input = graph->inputNodes.find(name);
+    if (input != graph->inputNodes.end()) {
+        // The mean image is subtracted in place, that must not change the user's data
+        if (graph->hasMeanImageFor(name))
+            return false;
+        memory = &input->second->getChildEdgeAt(0)->getMemory();
+    } else {
+        for (auto& out : graph->outputNodes) {
+            if (out->getName() == "out_" + name) {
+                memory = &out->getParentEdgeAt(0)->getMemory();
+                break;
+            }
+        }
+    }
+    if (memory == nullptr)
+        return false;
+
+    // The blob can replace the edge memory only if it holds the same data type, dims and layout;
+    // otherwise PushInputData and PullOutputData copy or reorder it
+    try {
+        return MKLDNNMemoryDesc(desc) == MKLDNNMemoryDesc(memory->GetDescriptor());
+    } catch (...) {
+        return false;
+    }
+}
+
 void MKLDNNPlugin::MKLDNNInferRequest::changeDefaultPtr() {
     for (auto& it : externalPtr) {
         auto input = graph->inputNodes.find(it.first);
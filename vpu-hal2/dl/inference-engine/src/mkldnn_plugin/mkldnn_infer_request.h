@@ -69,11 +69,15 @@ public:
 private:
     template <typename T> void pushInput(const std::string& inputName, InferenceEngine::Blob::Ptr& inputBlob);
 
+    bool canBindExternal(const std::string& name, const InferenceEngine::TensorDesc& desc);
     void changeAllPtrs(void *oldPtr, void *newPtr);
     void changeDefaultPtr();
     void resetDefaultPtr();
     MKLDNNGraph::Ptr graph;
     std::map<std::string, void*> externalPtr;
     std::map<std::string, void*> defaultPtr;
+    // Bytes the last inference of this request copied between user blobs
+    // and graph memory, reported as the "io_copy" performance counter
+    size_t copiedBytes = 0;
 };
 }  // namespace MKLDNNPlugin
@@ -0,0 +1,206 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+#include "mkldnn_inter_op_scheduler.h"
+
+#include <algorithm>
+
+using namespace MKLDNNPlugin;
+
+MKLDNNInterOpScheduler::MKLDNNInterOpScheduler(const std::vector<std::vector<size_t>>& preds, int workers,
+                                               const std::function<void()>& workerInit)
+        : succs(preds.size()), predCount(preds.size()), pending(new std::atomic<size_t>[preds.size()]),
+          workerInit(workerInit), queued(0), running(0), remaining(0), failed(false) {
+    for (size_t i = 0; i < preds.size(); i++) {
+        predCount[i] = preds[i].size();
+        if (preds[i].empty())
+            roots.push_back(i);
+        for (size_t p : preds[i])
+            succs[p].push_back(i);
+    }
+
+    workers = std::max(workers, 1);
+    for (int w = 0; w < workers; w++)
+        queues.emplace_back(new Queue());
+    // worker 0 is the thread calling run()
+    for (int w = 1; w < workers; w++)
+        threads.emplace_back(&MKLDNNInterOpScheduler::workerThread, this, static_cast<size_t>(w));
+}
+
+MKLDNNInterOpScheduler::~MKLDNNInterOpScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    poolCv.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void MKLDNNInterOpScheduler::run(const std::function<void(size_t, int)>& task, int totalThreads) {
+    if (succs.empty())
+        return;
+
+    for (size_t i = 0; i < predCount.size(); i++)
+        pending[i] = predCount[i];
+    remaining = succs.size();
+    failed = false;
+    failure = nullptr;
+    this->task = &task;
+    this->totalThreads = std::max(totalThreads, 1);
+
+    // spread the roots so that the pool threads do not have to steal them one by one
+    for (size_t i = 0; i < roots.size(); i++)
+        push(i % queues.size(), roots[i]);
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        generation++;
+        busyWorkers = threads.size();
+    }
+    poolCv.notify_all();
+
+    work(0);
+
+    {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        doneCv.wait(lock, [&] { return busyWorkers == 0; });
+    }
+    this->task = nullptr;
+
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+void MKLDNNInterOpScheduler::workerThread(size_t worker) {
+    if (workerInit)
+        workerInit();
+
+    size_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            poolCv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        work(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            busyWorkers--;
+        }
+        doneCv.notify_all();
+    }
+}
+
+void MKLDNNInterOpScheduler::work(size_t worker) {
+    for (;;) {
+        size_t node;
+        if (take(worker, node)) {
+            execute(worker, node);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(poolMutex);
+        poolCv.wait(lock, [&] { return queued > 0 || remaining == 0; });
+        if (remaining == 0)
+            return;
+    }
+}
+
+bool MKLDNNInterOpScheduler::take(size_t worker, size_t& node) {
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.guard);
+        if (!own.nodes.empty()) {
+            node = own.nodes.back();
+            own.nodes.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue& other = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.guard);
+        if (!other.nodes.empty()) {
+            node = other.nodes.front();
+            other.nodes.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MKLDNNInterOpScheduler::push(size_t worker, size_t node) {
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.guard);
+        own.nodes.push_back(node);
+        queued++;
+    }
+    // an idle worker checks `queued` under poolMutex, so it either sees the node or gets the notification
+    { std::lock_guard<std::mutex> lock(poolMutex); }
+    poolCv.notify_all();
+}
+
+void MKLDNNInterOpScheduler::execute(size_t worker, size_t node) {
+    size_t active = ++running + queued;
+    size_t sharing = std::min(std::max<size_t>(active, 1), queues.size());
+    int threads = std::max(1, static_cast<int>(totalThreads / sharing));
+
+    if (!failed) {
+        try {
+            (*task)(node, threads);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure)
+                failure = std::current_exception();
+            failed = true;
+        }
+    }
+    running--;
+
+    // Successors of a failed node are released as well, they skip their task
+    // above, so that the run still ends.
+    for (size_t succ : succs[node]) {
+        if (--pending[succ] == 0)
+            push(worker, succ);
+    }
+
+    if (--remaining == 0) {
+        { std::lock_guard<std::mutex> lock(poolMutex); }
+        poolCv.notify_all();
+    }
+}
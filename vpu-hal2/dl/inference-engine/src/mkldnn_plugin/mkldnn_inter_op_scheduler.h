@@ -0,0 +1,115 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MKLDNNPlugin {
+
+/**
+ * Runs the nodes of a graph concurrently as soon as the nodes they depend on
+ * have finished.
+ *
+ * The thread calling run() and workers - 1 pool threads take ready nodes from
+ * their own queues and steal from the queues of the others when theirs are
+ * empty. Every node gets a share of the OpenMP threads of the caller, split
+ * between the nodes that are ready or running when it starts, so a chain of
+ * nodes still uses all of them.
+ */
+class MKLDNNInterOpScheduler {
+public:
+    /**
+     * @param preds preds[i] lists the nodes that have to finish before node i starts
+     * @param workers number of nodes that may run at the same time
+     * @param workerInit called first in every pool thread, e.g. to set its affinity
+     */
+    MKLDNNInterOpScheduler(const std::vector<std::vector<size_t>>& preds, int workers,
+                           const std::function<void()>& workerInit = nullptr);
+    ~MKLDNNInterOpScheduler();
+
+    /**
+     * Calls task(node, threads) once for every node and returns when all of them
+     * have finished. Rethrows the first exception thrown by a task, the nodes
+     * depending on the failed one are skipped.
+     */
+    void run(const std::function<void(size_t, int)>& task, int totalThreads);
+
+private:
+    struct Queue {
+        std::mutex guard;
+        std::deque<size_t> nodes;
+    };
+
+    void workerThread(size_t worker);
+    void work(size_t worker);
+    bool take(size_t worker, size_t& node);
+    void push(size_t worker, size_t node);
+    void execute(size_t worker, size_t node);
+
+    std::vector<std::vector<size_t>> succs;
+    std::vector<size_t> predCount;
+    std::vector<size_t> roots;
+    std::unique_ptr<std::atomic<size_t>[]> pending;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::function<void()> workerInit;
+
+    std::mutex poolMutex;
+    std::condition_variable poolCv;
+    std::condition_variable doneCv;
+    size_t generation = 0;
+    size_t busyWorkers = 0;
+    bool stopping = false;
+
+    std::atomic<size_t> queued;
+    std::atomic<size_t> running;
+    std::atomic<size_t> remaining;
+
+    const std::function<void(size_t, int)>* task = nullptr;
+    int totalThreads = 1;
+
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    std::atomic<bool> failed;
+};
+
+}  // namespace MKLDNNPlugin
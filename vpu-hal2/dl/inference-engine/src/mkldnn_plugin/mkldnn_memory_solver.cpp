@@ -0,0 +1,76 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+#include "mkldnn_memory_solver.h"
+
+#include <algorithm>
+
+using namespace MKLDNNPlugin;
+
+size_t MKLDNNMemorySolver::solve(std::vector<Box>& boxes, size_t alignment) {
+    std::vector<size_t> order(boxes.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return boxes[a].size > boxes[b].size;
+    });
+
+    auto alignUp = [alignment](size_t value) {
+        return (value + alignment - 1) / alignment * alignment;
+    };
+
+    size_t total = 0;
+    std::vector<const Box*> placed;
+    for (size_t i : order) {
+        Box& box = boxes[i];
+
+        // Byte ranges taken by already placed boxes that are live at the same time
+        std::vector<std::pair<size_t, size_t>> busy;
+        for (auto other : placed) {
+            if (other->finish < box.start || box.finish < other->start)
+                continue;
+            busy.emplace_back(other->offset, other->offset + other->size);
+        }
+        std::sort(busy.begin(), busy.end());
+
+        size_t offset = 0;
+        for (auto& range : busy) {
+            if (offset + box.size <= range.first)
+                break;
+            offset = std::max(offset, alignUp(range.second));
+        }
+
+        box.offset = offset;
+        placed.push_back(&box);
+        total = std::max(total, offset + box.size);
+    }
+    return total;
+}
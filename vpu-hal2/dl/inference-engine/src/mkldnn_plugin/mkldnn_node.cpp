@@ -457,6 +457,31 @@ void MKLDNNNode::execute(mkldnn::stream strm) {
     if (prim) {
         strm.submit({*prim});
     }
+    executeFusedActivations(strm);
+}
+
+void MKLDNNNode::createFusedActivations() {
+    if (!fusedActivations.empty())
+        return;
+
+    auto& dstMemory = getChildEdgeAt(0)->getMemory();
+    for (auto &node : fusedWith) {
+        auto * activationNode = dynamic_cast<MKLDNNActivationNode *>(node.get());
+        if (!activationNode)
+            continue;
+
+        eltwise_forward::desc desc(prop_kind::forward_scoring, activationNode->getAlgorithm(),
+                                   dstMemory.GetDescriptor(), activationNode->getAlpha(), activationNode->getBeta());
+        eltwise_forward::primitive_desc prim_desc(desc, getSelectedPrimitiveDescriptor()->getEngine());
+        fusedActivations.emplace_back(new eltwise_forward(prim_desc, dstMemory.GetPrimitive(),
+                                                          dstMemory.GetPrimitive()));
+    }
+}
+
+void MKLDNNNode::executeFusedActivations(mkldnn::stream strm) {
+    for (auto &activation : fusedActivations) {
+        strm.submit({*activation});
+    }
 }
 
 void MKLDNNNode::initSupportedPrimitiveDescriptors(const mkldnn::engine &engine) {
@@ -543,6 +568,18 @@ void MKLDNNNode::prepareMemory(const MKLDNNPrimitiveDescInfo *selected_pd) {
 
     internalBlobMemory.clear();
     for (size_t i = 0; i < internalBlobs.size(); i++) {
+        std::string cacheKey;
+        if (weightCache) {
+            cacheKey = getName() + "_" + std::to_string(i) + "_" +
+                       std::to_string(static_cast<int>(selected_pd->getInternalDescs()[i].getFormat())) + "_" +
+                       std::to_string(static_cast<int>(getInputDataType()));
+            auto cached = weightCache->find(cacheKey);
+            if (cached) {
+                internalBlobMemory.push_back(cached);
+                continue;
+            }
+        }
+
         auto& internalBlob = internalBlobs[i];
         internalBlobMemory.push_back(MKLDNNMemoryPtr(new MKLDNNMemory(getSelectedPrimitiveDescriptor()->getEngine())));
         MKLDNNDims blobDims = MKLDNNDims(internalBlob->getTensorDesc().getDims());
@@ -614,6 +651,9 @@ void MKLDNNNode::prepareMemory(const MKLDNNPrimitiveDescInfo *selected_pd) {
             internalBlobMemory[i]->Create(real_dims, getInputDataType(), selected_pd->getInternalDescs()[i].getFormat());
             internalBlobMemory[i]->SetData(getInputDataType(), format, tmp_wght->buffer(), tmp_wght->byteSize());
         }
+
+        if (weightCache)
+            weightCache->add(cacheKey, internalBlobMemory[i]);
     }
 }
 
@@ -45,6 +45,7 @@
 #include "mkldnn_descriptor.h"
 #include "mkldnn/iml_type_mapper.h"
 #include "mkldnn_extension_mngr.h"
+#include "mkldnn_weights_cache.h"
 
 namespace MKLDNNPlugin {
 
@@ -467,8 +468,11 @@ protected:
     bool constant;
     std::vector<InferenceEngine::Blob::Ptr> internalBlobs;
     std::vector<MKLDNNMemoryPtr> internalBlobMemory;
+    MKLDNNWeightsSharing::Ptr weightCache;
     std::vector<MKLDNNPrimitiveDescInfo> supportedPrimitiveDescriptors;
     std::shared_ptr<mkldnn::primitive> prim;
+    // Activations fused into a node whose primitive takes no post-ops, run in place on its output
+    std::vector<std::shared_ptr<mkldnn::primitive>> fusedActivations;
     std::vector<MKLDNNDescriptor> descs;
 
     friend class MKLDNNEdge;
@@ -487,6 +491,9 @@ protected:
 
     InferenceEngine::Blob::Ptr createInternalBlob(InferenceEngine::SizeVector dims, bool weights);
 
+    void createFusedActivations();
+    void executeFusedActivations(mkldnn::stream strm);
+
     template<typename To>
     class Register {
     public:
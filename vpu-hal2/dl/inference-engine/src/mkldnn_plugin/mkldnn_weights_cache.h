@@ -0,0 +1,69 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "mkldnn_memory.h"
+
+namespace MKLDNNPlugin {
+
+/**
+ * Weights of the graph instances built from one network. Graphs of the same
+ * network and config select the same primitives, so a node finds the memory
+ * its twin in another graph has already prepared by its name.
+ */
+class MKLDNNWeightsSharing {
+public:
+    typedef std::shared_ptr<MKLDNNWeightsSharing> Ptr;
+
+    // Returns nullptr if no graph has prepared the weights yet
+    MKLDNNMemoryPtr find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(guard);
+        auto found = sharedWeights.find(key);
+        return found == sharedWeights.end() ? nullptr : found->second;
+    }
+
+    void add(const std::string& key, const MKLDNNMemoryPtr& memory) {
+        std::lock_guard<std::mutex> lock(guard);
+        sharedWeights[key] = memory;
+    }
+
+private:
+    std::mutex guard;
+    std::map<std::string, MKLDNNMemoryPtr> sharedWeights;
+};
+
+}  // namespace MKLDNNPlugin
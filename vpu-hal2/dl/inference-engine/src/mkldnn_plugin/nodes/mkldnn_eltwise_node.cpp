@@ -151,6 +151,7 @@ void MKLDNNEltwiseNode::createPrimitive() {
         auto primitive_desc = sum::primitive_desc(dstMemPtr->GetDescriptor(), sum_scales, srcs_pd);
         prim = std::shared_ptr<sum>(new sum(primitive_desc, srcs_p, dstMemPtr->GetPrimitive()));
     }
+    createFusedActivations();
 }
 
 void MKLDNNEltwiseNode::execute(mkldnn::stream strm) {
@@ -197,6 +198,7 @@ void MKLDNNEltwiseNode::execute(mkldnn::stream strm) {
             }
         }
     }
+    executeFusedActivations(strm);
 }
 
 bool MKLDNNEltwiseNode::created() {
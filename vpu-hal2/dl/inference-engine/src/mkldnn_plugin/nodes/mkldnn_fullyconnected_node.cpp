@@ -147,6 +147,7 @@ void MKLDNNFullyConnectedNode::createPrimitive() {
                                              internalBlobMemory[0]->GetPrimitive(),
                                              getChildEdgeAt(0)->getMemory().GetPrimitive()));
     }
+    createFusedActivations();
 }
 
 bool MKLDNNFullyConnectedNode::created() {
@@ -134,6 +134,7 @@ void MKLDNNPoolingNode::createPrimitive() {
 
     prim.reset(new pooling_forward(prim_desc, getParentEdgeAt(0)->getMemory().GetPrimitive(),
                                    getChildEdgeAt(0)->getMemory().GetPrimitive()));
+    createFusedActivations();
 }
 
 bool MKLDNNPoolingNode::created() {
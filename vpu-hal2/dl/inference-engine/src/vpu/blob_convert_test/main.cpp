@@ -0,0 +1,204 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+// Checks VPU::Common::ConvertBlob, the host side layout and precision
+// conversion of the Myriad plugin I/O, against a per-element reference for
+// every supported precision pair, both NCHW <-> NHWC directions and sizes
+// that do and do not fill its transpose tiles. Exits with 1 on a mismatch.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ie_common.h>
+#include <precision_utils.h>
+#include <blob_convert.h>
+
+using namespace InferenceEngine;
+using namespace VPU::Common;
+
+namespace {
+
+// Offset of element (n, c, h, w) in a blob of the given dims and layout
+size_t offsetOf(Layout layout, const SizeVector &dims, size_t n, size_t c, size_t h, size_t w) {
+    size_t C = dims[1], H = dims[2], W = dims[3];
+    return layout == NHWC ? ((n * H + h) * W + w) * C + c
+                          : ((n * C + c) * H + h) * W + w;
+}
+
+float load(const std::vector<uint8_t> &blob, Precision precision, size_t offset) {
+    switch (precision) {
+    case Precision::FP32: {
+        float value;
+        memcpy(&value, &blob[offset * sizeof(float)], sizeof(value));
+        return value;
+    }
+    case Precision::FP16: {
+        ie_fp16 value;
+        memcpy(&value, &blob[offset * sizeof(ie_fp16)], sizeof(value));
+        return PrecisionUtils::f16tof32(value);
+    }
+    default:
+        return blob[offset];
+    }
+}
+
+// The bytes ConvertBlob is expected to write for one element
+std::vector<uint8_t> expected(float value, Precision srcPrecision, Precision dstPrecision,
+                              float scale, float bias) {
+    std::vector<uint8_t> bytes(dstPrecision.size());
+    if (srcPrecision != dstPrecision) {
+        value = value * scale + bias;
+    }
+    switch (dstPrecision) {
+    case Precision::FP32:
+        memcpy(bytes.data(), &value, sizeof(value));
+        break;
+    case Precision::FP16: {
+        ie_fp16 half = PrecisionUtils::f32tof16(value);
+        memcpy(bytes.data(), &half, sizeof(half));
+        break;
+    }
+    default:
+        bytes[0] = static_cast<uint8_t>(value);
+    }
+    return bytes;
+}
+
+std::vector<uint8_t> randomBlob(Precision precision, size_t count, std::mt19937 &generator) {
+    std::vector<uint8_t> blob(count * precision.size());
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    for (size_t i = 0; i < count; i++) {
+        if (precision == Precision::FP32) {
+            float value = dist(generator);
+            memcpy(&blob[i * sizeof(float)], &value, sizeof(value));
+        } else if (precision == Precision::FP16) {
+            ie_fp16 value = PrecisionUtils::f32tof16(dist(generator));
+            memcpy(&blob[i * sizeof(ie_fp16)], &value, sizeof(value));
+        } else {
+            blob[i] = static_cast<uint8_t>(generator());
+        }
+    }
+    return blob;
+}
+
+// Returns the number of mismatching elements
+size_t check(const SizeVector &dims, Precision srcPrecision, Layout srcLayout,
+             Precision dstPrecision, Layout dstLayout, float scale, float bias, std::mt19937 &generator) {
+    size_t count = dims[0] * dims[1] * dims[2] * dims[3];
+    auto src = randomBlob(srcPrecision, count, generator);
+    std::vector<uint8_t> dst(count * dstPrecision.size());
+
+    ConvertBlob(src.data(), srcPrecision, srcLayout, dst.data(), dstPrecision, dstLayout, dims, scale, bias);
+
+    size_t mismatches = 0;
+    for (size_t n = 0; n < dims[0]; n++)
+    for (size_t c = 0; c < dims[1]; c++)
+    for (size_t h = 0; h < dims[2]; h++)
+    for (size_t w = 0; w < dims[3]; w++) {
+        float value = load(src, srcPrecision, offsetOf(srcLayout, dims, n, c, h, w));
+        auto bytes = expected(value, srcPrecision, dstPrecision, scale, bias);
+        size_t offset = offsetOf(dstLayout, dims, n, c, h, w) * dstPrecision.size();
+        if (memcmp(bytes.data(), &dst[offset], bytes.size()) != 0) {
+            if (mismatches == 0) {
+                std::cerr << "first mismatch at (" << n << ", " << c << ", " << h << ", " << w << ")\n";
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+}  // namespace
+
+int main() {
+    const std::vector<SizeVector> shapes = {
+        {1, 3, 224, 224}, {2, 64, 7, 7}, {1, 33, 5, 31}, {3, 1, 1, 1}, {1, 1000, 1, 1}, {2, 32, 8, 4}
+    };
+    const std::vector<std::pair<Precision, Precision>> precisions = {
+        {Precision::FP32, Precision::FP16}, {Precision::FP16, Precision::FP32},
+        {Precision::FP32, Precision::FP32}, {Precision::FP16, Precision::FP16}, {Precision::U8, Precision::U8}
+    };
+    const std::vector<std::pair<Layout, Layout>> layouts = {
+        {NCHW, NHWC}, {NHWC, NCHW}, {NCHW, NCHW}, {NHWC, NHWC}
+    };
+
+    std::mt19937 generator(42);
+    size_t cases = 0, failed = 0;
+    try {
+        for (const auto &dims : shapes) {
+            for (const auto &precision : precisions) {
+                for (const auto &layout : layouts) {
+                    // scale and bias only apply when the precision changes
+                    bool converts = precision.first != precision.second;
+                    float scale = converts ? 0.5f : 1.f;
+                    float bias = converts ? 3.f : 0.f;
+
+                    size_t mismatches = check(dims, precision.first, layout.first, precision.second, layout.second,
+                                              scale, bias, generator);
+                    cases++;
+                    if (mismatches != 0) {
+                        failed++;
+                        std::cerr << precision.first << " " << layout.first << " -> " << precision.second << " "
+                                  << layout.second << " [" << dims[0] << ", " << dims[1] << ", " << dims[2] << ", "
+                                  << dims[3] << "]: " << mismatches << " mismatches\n";
+                    }
+                }
+            }
+        }
+
+        // a same precision copy must not silently drop the scale
+        float value = 1.f, result = 0.f;
+        bool threw = false;
+        try {
+            ConvertBlob(&value, Precision::FP32, NCHW, &result, Precision::FP32, NCHW, {1, 1, 1, 1}, 2.f);
+        } catch (const details::InferenceEngineException &) {
+            threw = true;
+        }
+        cases++;
+        if (!threw) {
+            failed++;
+            std::cerr << "scale on a same precision copy was accepted\n";
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << cases - failed << " of " << cases << " cases passed\n";
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
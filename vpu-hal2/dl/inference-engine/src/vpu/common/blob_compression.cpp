@@ -0,0 +1,184 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+
+#include "blob_compression.h"
+#include <ie_common.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Layout of a compressed blob:
+//   header : CompressedBlobHeader
+//   prefix : decoded bytes [0, dataOffset)
+//   coded  : codedSize bytes decoding to [dataOffset, dataOffset + dataSize)
+//   suffix : decoded bytes [dataOffset + dataSize, blobSize)
+// Bump COMPRESSION_FORMAT_VERSION whenever this layout or the coding changes.
+#define COMPRESSION_MAGIC           0x5a42564dU  // "MVBZ"
+#define COMPRESSION_FORMAT_VERSION  1U
+
+namespace {
+
+struct CompressedBlobHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blobSize;
+    uint32_t dataOffset;
+    uint32_t dataSize;
+    uint32_t codedSize;
+};
+
+const size_t BLOCK_VALUES = 16;
+const size_t BLOCK_BYTES = BLOCK_VALUES * sizeof(uint16_t);
+
+void appendBytes(std::vector<char> &out, const void *data, size_t size) {
+    auto bytes = static_cast<const char *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+CompressedBlobHeader readHeader(const std::vector<char> &blob) {
+    CompressedBlobHeader header;
+    std::memcpy(&header, blob.data(), sizeof(header));
+    return header;
+}
+
+}  // namespace
+
+bool VPU::Common::compressBlobWeights(std::vector<char> &blob, size_t dataOffset, size_t dataSize) {
+    // a tail shorter than a block stays in the suffix
+    dataSize -= dataSize % BLOCK_BYTES;
+    if (dataSize == 0 || dataOffset + dataSize > blob.size() || blob.size() > UINT32_MAX) {
+        return false;
+    }
+
+    std::vector<char> coded;
+    coded.reserve(dataSize);
+    for (size_t offset = dataOffset; offset < dataOffset + dataSize; offset += BLOCK_BYTES) {
+        uint16_t values[BLOCK_VALUES];
+        std::memcpy(values, &blob[offset], BLOCK_BYTES);
+
+        uint16_t mask = 0;
+        for (size_t i = 0; i < BLOCK_VALUES; i++) {
+            if (values[i] != 0) {
+                mask |= 1 << i;
+            }
+        }
+        appendBytes(coded, &mask, sizeof(mask));
+        for (size_t i = 0; i < BLOCK_VALUES; i++) {
+            if (values[i] != 0) {
+                appendBytes(coded, &values[i], sizeof(values[i]));
+            }
+        }
+
+        // the coding only grows, so it is already known to be no gain
+        if (sizeof(CompressedBlobHeader) + coded.size() >= dataSize) {
+            return false;
+        }
+    }
+
+    CompressedBlobHeader header = {};
+    header.magic = COMPRESSION_MAGIC;
+    header.version = COMPRESSION_FORMAT_VERSION;
+    header.blobSize = blob.size();
+    header.dataOffset = dataOffset;
+    header.dataSize = dataSize;
+    header.codedSize = coded.size();
+
+    std::vector<char> compressed;
+    compressed.reserve(sizeof(header) + blob.size() - dataSize + coded.size());
+    appendBytes(compressed, &header, sizeof(header));
+    compressed.insert(compressed.end(), blob.begin(), blob.begin() + dataOffset);
+    compressed.insert(compressed.end(), coded.begin(), coded.end());
+    compressed.insert(compressed.end(), blob.begin() + dataOffset + dataSize, blob.end());
+
+    blob.swap(compressed);
+    return true;
+}
+
+bool VPU::Common::isCompressedBlob(const std::vector<char> &blob) {
+    return blob.size() >= sizeof(CompressedBlobHeader) && readHeader(blob).magic == COMPRESSION_MAGIC;
+}
+
+size_t VPU::Common::decompressedBlobSize(const std::vector<char> &blob) {
+    return isCompressedBlob(blob) ? readHeader(blob).blobSize : blob.size();
+}
+
+void VPU::Common::decompressBlob(const std::vector<char> &blob, std::vector<char> &decoded) {
+    if (!isCompressedBlob(blob)) {
+        decoded = blob;
+        return;
+    }
+
+    auto header = readHeader(blob);
+    if (header.version != COMPRESSION_FORMAT_VERSION) {
+        THROW_IE_EXCEPTION << "[VPU] Compressed graph blob version " << header.version
+                           << " is not supported, expected " << COMPRESSION_FORMAT_VERSION;
+    }
+
+    // sizes are checked in 64 bits so that corrupted fields cannot wrap around
+    uint64_t codedEnd = sizeof(header) + uint64_t(header.dataOffset) + header.codedSize;
+    uint64_t dataEnd = uint64_t(header.dataOffset) + header.dataSize;
+    if (header.dataSize % BLOCK_BYTES != 0 || dataEnd > header.blobSize || codedEnd > blob.size() ||
+        blob.size() - codedEnd != header.blobSize - dataEnd) {
+        THROW_IE_EXCEPTION << "[VPU] Compressed graph blob is corrupted";
+    }
+
+    decoded.assign(header.blobSize, 0);
+
+    auto coded = blob.data() + sizeof(header) + header.dataOffset;
+    std::memcpy(decoded.data(), blob.data() + sizeof(header), header.dataOffset);
+    std::memcpy(decoded.data() + dataEnd, blob.data() + codedEnd, header.blobSize - dataEnd);
+
+    size_t pos = 0;
+    for (size_t offset = header.dataOffset; offset < dataEnd; offset += BLOCK_BYTES) {
+        uint16_t mask;
+        if (pos + sizeof(mask) > header.codedSize) {
+            THROW_IE_EXCEPTION << "[VPU] Compressed graph blob is corrupted";
+        }
+        std::memcpy(&mask, coded + pos, sizeof(mask));
+        pos += sizeof(mask);
+
+        for (size_t i = 0; i < BLOCK_VALUES; i++) {
+            if ((mask >> i) & 1) {
+                if (pos + sizeof(uint16_t) > header.codedSize) {
+                    THROW_IE_EXCEPTION << "[VPU] Compressed graph blob is corrupted";
+                }
+                std::memcpy(&decoded[offset + i * sizeof(uint16_t)], coded + pos, sizeof(uint16_t));
+                pos += sizeof(uint16_t);
+            }
+        }
+    }
+    if (pos != header.codedSize) {
+        THROW_IE_EXCEPTION << "[VPU] Compressed graph blob is corrupted";
+    }
+}
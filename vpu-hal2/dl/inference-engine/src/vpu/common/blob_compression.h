@@ -0,0 +1,66 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace VPU {
+namespace Common {
+
+// Lossless block-sparse coding of the weights of a graph blob, so networks
+// are cached, exported and loaded in fewer bytes. The firmware only takes
+// plain graph blobs, so a compressed blob is decoded on the host before
+// ncGraphAllocate.
+//
+// A compressed blob is a header followed by the blob with one byte range
+// (the buffer section holding the weights) replaced by its coding. The range
+// is coded in blocks of 16 FP16 values: a 16-bit mask of the values that are
+// not +0.0, then those values in order. Zero padding of HW weights and pruned
+// weights shrink to the mask, dense weights grow by 1/16.
+
+// Replaces [dataOffset, dataOffset + dataSize) of the blob with its coding.
+// Returns false and leaves the blob as it is when that would not make it smaller.
+bool compressBlobWeights(std::vector<char> &blob, size_t dataOffset, size_t dataSize);
+
+bool isCompressedBlob(const std::vector<char> &blob);
+
+// Size of the blob once decoded, blob.size() for a plain blob
+size_t decompressedBlobSize(const std::vector<char> &blob);
+
+// throw exception if the blob is corrupted
+void decompressBlob(const std::vector<char> &blob, std::vector<char> &decoded);
+
+}  // namespace Common
+}  // namespace VPU
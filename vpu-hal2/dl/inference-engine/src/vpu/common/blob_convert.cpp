@@ -0,0 +1,139 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2017 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+#include "blob_convert.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include "precision_utils.h"
+#include "details/ie_exception.hpp"
+
+using namespace InferenceEngine;
+
+namespace {
+
+// Transposes are done in square tiles so that both the strided reads and
+// the contiguous writes of a tile stay in L1.
+const size_t TILE = 32;
+
+void convertRow(const void* src, Precision srcPrecision, void* dst, Precision dstPrecision,
+                size_t count, float scale, float bias) {
+    if (srcPrecision == dstPrecision) {
+        if (scale != 1.f || bias != 0.f) {
+            THROW_IE_EXCEPTION << "Scale and bias are only applied when converting precision";
+        }
+        memcpy(dst, src, count * srcPrecision.size());
+    } else if (srcPrecision == Precision::FP32 && dstPrecision == Precision::FP16) {
+        PrecisionUtils::f32tof16Arrays(static_cast<ie_fp16*>(dst), static_cast<const float*>(src), count, scale, bias);
+    } else if (srcPrecision == Precision::FP16 && dstPrecision == Precision::FP32) {
+        PrecisionUtils::f16tof32Arrays(static_cast<float*>(dst), static_cast<const ie_fp16*>(src), count, scale, bias);
+    } else {
+        THROW_IE_EXCEPTION << "Unsupported blob conversion from " << srcPrecision << " to " << dstPrecision;
+    }
+}
+
+// Gathers column k of rows [r0, r0 + count) of a row-major matrix with the
+// given number of columns into a contiguous buffer.
+template <typename T>
+void gatherColumn(const void* src, size_t cols, size_t r0, size_t k, size_t count, void* buf) {
+    const T* s = static_cast<const T*>(src) + r0 * cols + k;
+    T* d = static_cast<T*>(buf);
+    for (size_t i = 0; i < count; i++) {
+        d[i] = s[i * cols];
+    }
+}
+
+// Writes the transpose of a rows x cols matrix, converting the precision of
+// each output row as it is gathered.
+void transpose(const uint8_t* src, Precision srcPrecision, uint8_t* dst, Precision dstPrecision,
+               size_t rows, size_t cols, float scale, float bias) {
+    size_t srcSize = srcPrecision.size();
+    size_t dstSize = dstPrecision.size();
+    uint8_t buf[TILE * sizeof(float)];
+
+    for (size_t r0 = 0; r0 < rows; r0 += TILE) {
+        size_t count = std::min(TILE, rows - r0);
+        for (size_t k0 = 0; k0 < cols; k0 += TILE) {
+            size_t kEnd = std::min(k0 + TILE, cols);
+            for (size_t k = k0; k < kEnd; k++) {
+                switch (srcSize) {
+                case 1:
+                    gatherColumn<uint8_t>(src, cols, r0, k, count, buf);
+                    break;
+                case 2:
+                    gatherColumn<uint16_t>(src, cols, r0, k, count, buf);
+                    break;
+                case 4:
+                    gatherColumn<uint32_t>(src, cols, r0, k, count, buf);
+                    break;
+                default:
+                    THROW_IE_EXCEPTION << "Unsupported blob precision " << srcPrecision;
+                }
+                convertRow(buf, srcPrecision, dst + (k * rows + r0) * dstSize, dstPrecision, count, scale, bias);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void VPU::Common::ConvertBlob(const void* src, Precision srcPrecision, Layout srcLayout,
+                              void* dst, Precision dstPrecision, Layout dstLayout,
+                              const SizeVector& dims, float scale, float bias) {
+    size_t total = 1;
+    for (auto dim : dims) {
+        total *= dim;
+    }
+
+    bool permute = srcLayout != dstLayout && dims.size() == 4 &&
+                   (srcLayout == NCHW || srcLayout == NHWC) &&
+                   (dstLayout == NCHW || dstLayout == NHWC);
+    if (!permute || total == 0) {
+        convertRow(src, srcPrecision, dst, dstPrecision, total, scale, bias);
+        return;
+    }
+
+    // Per image, NCHW is a [C][HW] matrix and NHWC is its [HW][C] transpose.
+    size_t C = dims[1];
+    size_t HW = dims[2] * dims[3];
+    size_t rows = srcLayout == NCHW ? C : HW;
+    size_t cols = srcLayout == NCHW ? HW : C;
+
+    auto s = static_cast<const uint8_t*>(src);
+    auto d = static_cast<uint8_t*>(dst);
+    for (size_t n = 0; n < dims[0]; n++) {
+        transpose(s + n * C * HW * srcPrecision.size(), srcPrecision,
+                  d + n * C * HW * dstPrecision.size(), dstPrecision,
+                  rows, cols, scale, bias);
+    }
+}
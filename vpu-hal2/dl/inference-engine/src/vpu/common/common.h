@@ -62,6 +62,9 @@ void GetPerformanceCounts(const std::vector<BlobMetaData> &blobMetaData,
     for (auto currentMetaData = blobMetaData.begin();
          currentMetaData != blobMetaData.end() && timeIndex < graphElementsCount;
          currentMetaData++) {
+        if (currentMetaData->status == InferenceEngine::InferenceEngineProfileInfo::NOT_RUN)
+            continue;
+
         InferenceEngine::InferenceEngineProfileInfo &pc = perfMap[currentMetaData->name];
         float timeMS = 0;
         if (currentMetaData->status != InferenceEngine::InferenceEngineProfileInfo::OPTIMIZED_OUT) {
@@ -88,6 +91,19 @@ void GetPerformanceCounts(const std::vector<BlobMetaData> &blobMetaData,
         THROW_IE_EXCEPTION << "Inconsistent profile info per layers: number of times (" << graphElementsCount
                            << ") != number of non-optimized out layers (" << timeIndex << ")";
     }
+
+    // graph transformer passes, reported with their compile time
+    for (const auto &meta : blobMetaData) {
+        if (meta.status != InferenceEngine::InferenceEngineProfileInfo::NOT_RUN)
+            continue;
+
+        InferenceEngine::InferenceEngineProfileInfo &pc = perfMap[meta.name];
+        pc.cpu_uSec = pc.realTime_uSec = meta.compileTime_uSec;
+        meta.exec_type.copy(pc.exec_type, sizeof(pc.exec_type) / sizeof(pc.exec_type[0]), 0);
+        meta.layer_type.copy(pc.layer_type, sizeof(pc.layer_type) / sizeof(pc.layer_type[0]), 0);
+        pc.status = meta.status;
+        pc.execution_index = 0;
+    }
 }
 
 template<typename T>
@@ -49,6 +49,9 @@ struct Environment {
     }
 
     std::vector<BlobMetaData> blobMetaData;
+    // the graph is compiled for batch 1 and each request runs it once per
+    // item of the network batch
+    size_t batchSize = 1;
 
     ParsedConfig parsedConfig;
     unsigned int platform;
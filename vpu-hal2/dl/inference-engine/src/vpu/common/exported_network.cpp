@@ -0,0 +1,206 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+#include "exported_network.h"
+#include <ie_common.h>
+#include <string>
+#include <vector>
+
+using namespace InferenceEngine;
+using namespace VPU::Common;
+
+// Layout of an exported network:
+//   header   : magic, format version, platform, hw optimization flag,
+//              host I/O conversion flag, input scale and bias
+//   network  : name, number of stages, batch size
+//   blob     : size followed by the graph blob bytes, weights compressed or not
+//   metadata : count followed by BlobMetaData entries
+//   inputs   : count followed by name and tensor descriptor of each input
+//   outputs  : count followed by name and tensor descriptor of each output
+// Bump EXPORT_FORMAT_VERSION whenever this layout or the blob format changes,
+// so stale exports are refused rather than loaded onto the device.
+#define EXPORT_MAGIC            0x4342564dU  // "MVBC"
+#define EXPORT_FORMAT_VERSION   7U
+
+namespace {
+
+template<typename T>
+void writeValue(std::ostream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void writeString(std::ostream &out, const std::string &str) {
+    writeValue<uint32_t>(out, str.size());
+    out.write(str.data(), str.size());
+}
+
+void writeTensorDesc(std::ostream &out, const TensorDesc &desc) {
+    writeValue<uint8_t>(out, static_cast<Precision::ePrecision>(desc.getPrecision()));
+    writeValue<uint8_t>(out, desc.getLayout());
+    const SizeVector &dims = desc.getDims();
+    writeValue<uint32_t>(out, dims.size());
+    for (auto dim : dims) {
+        writeValue<uint64_t>(out, dim);
+    }
+}
+
+template<typename T>
+T readValue(std::istream &in) {
+    T value;
+    if (!in.read(reinterpret_cast<char *>(&value), sizeof(value))) {
+        THROW_IE_EXCEPTION << "[VPU] Unexpected end of exported network";
+    }
+    return value;
+}
+
+std::string readString(std::istream &in) {
+    auto size = readValue<uint32_t>(in);
+    std::string str(size, '\0');
+    if (size != 0 && !in.read(&str[0], size)) {
+        THROW_IE_EXCEPTION << "[VPU] Unexpected end of exported network";
+    }
+    return str;
+}
+
+TensorDesc readTensorDesc(std::istream &in) {
+    auto precision = static_cast<Precision::ePrecision>(readValue<uint8_t>(in));
+    auto layout = static_cast<Layout>(readValue<uint8_t>(in));
+    SizeVector dims(readValue<uint32_t>(in));
+    for (auto &dim : dims) {
+        dim = readValue<uint64_t>(in);
+    }
+    return TensorDesc(precision, dims, layout);
+}
+
+}  // namespace
+
+void VPU::Common::writeExportedNetwork(std::ostream &out, const ExportedNetwork &network, const std::string &fileName) {
+    writeValue<uint32_t>(out, EXPORT_MAGIC);
+    writeValue<uint32_t>(out, EXPORT_FORMAT_VERSION);
+    writeValue<uint32_t>(out, network.platform);
+    writeValue<uint8_t>(out, network.hwOptimization ? 1 : 0);
+    writeValue<uint8_t>(out, network.hostIoConversion ? 1 : 0);
+    writeValue<float>(out, network.inputScale);
+    writeValue<float>(out, network.inputBias);
+
+    writeString(out, network.name);
+    writeValue<uint64_t>(out, network.numStages);
+    writeValue<uint64_t>(out, network.batchSize);
+
+    writeValue<uint64_t>(out, network.graphBlob.size());
+    out.write(network.graphBlob.data(), network.graphBlob.size());
+
+    writeValue<uint32_t>(out, network.blobMetaData.size());
+    for (const auto &meta : network.blobMetaData) {
+        writeString(out, meta.name);
+        writeString(out, meta.exec_type);
+        writeString(out, meta.layer_type);
+        writeValue<uint32_t>(out, meta.status);
+        writeValue<int64_t>(out, meta.compileTime_uSec);
+        writeValue<uint32_t>(out, meta.hwDescriptors);
+        writeValue<uint32_t>(out, meta.hwComputeCost);
+        writeValue<uint32_t>(out, meta.hwOutputPixels);
+    }
+
+    writeValue<uint32_t>(out, network.inputs.size());
+    for (const auto &input : network.inputs) {
+        writeString(out, input.first);
+        writeTensorDesc(out, input.second);
+    }
+
+    writeValue<uint32_t>(out, network.outputs.size());
+    for (const auto &output : network.outputs) {
+        writeString(out, output.first);
+        writeTensorDesc(out, output.second);
+    }
+
+    if (!out.good()) {
+        THROW_IE_EXCEPTION << "[VPU] Failed to write exported network to " << fileName;
+    }
+}
+
+ExportedNetwork VPU::Common::readExportedNetwork(std::istream &in, const std::string &fileName) {
+    ExportedNetwork network;
+
+    if (readValue<uint32_t>(in) != EXPORT_MAGIC) {
+        THROW_IE_EXCEPTION << "[VPU] " << fileName << " is not an exported MYRIAD network";
+    }
+    auto version = readValue<uint32_t>(in);
+    if (version != EXPORT_FORMAT_VERSION) {
+        THROW_IE_EXCEPTION << "[VPU] Exported network version " << version
+                           << " is not supported, expected " << EXPORT_FORMAT_VERSION;
+    }
+    network.platform = readValue<uint32_t>(in);
+    network.hwOptimization = readValue<uint8_t>(in) != 0;
+    network.hostIoConversion = readValue<uint8_t>(in) != 0;
+    network.inputScale = readValue<float>(in);
+    network.inputBias = readValue<float>(in);
+
+    network.name = readString(in);
+    network.numStages = readValue<uint64_t>(in);
+    network.batchSize = readValue<uint64_t>(in);
+    if (network.batchSize == 0) {
+        THROW_IE_EXCEPTION << "[VPU] Exported network " << fileName << " has batch size 0";
+    }
+
+    network.graphBlob.resize(readValue<uint64_t>(in));
+    if (!in.read(network.graphBlob.data(), network.graphBlob.size())) {
+        THROW_IE_EXCEPTION << "[VPU] Unexpected end of exported network";
+    }
+
+    network.blobMetaData.resize(readValue<uint32_t>(in));
+    for (auto &meta : network.blobMetaData) {
+        meta.name = readString(in);
+        meta.exec_type = readString(in);
+        meta.layer_type = readString(in);
+        meta.status = static_cast<InferenceEngineProfileInfo::LayerStatus>(readValue<uint32_t>(in));
+        meta.compileTime_uSec = readValue<int64_t>(in);
+        meta.hwDescriptors = readValue<uint32_t>(in);
+        meta.hwComputeCost = readValue<uint32_t>(in);
+        meta.hwOutputPixels = readValue<uint32_t>(in);
+    }
+
+    auto numInputs = readValue<uint32_t>(in);
+    for (uint32_t i = 0; i < numInputs; i++) {
+        auto name = readString(in);
+        network.inputs.emplace_back(name, readTensorDesc(in));
+    }
+
+    auto numOutputs = readValue<uint32_t>(in);
+    for (uint32_t i = 0; i < numOutputs; i++) {
+        auto name = readString(in);
+        network.outputs.emplace_back(name, readTensorDesc(in));
+    }
+
+    return network;
+}
@@ -0,0 +1,73 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ie_layouts.h>
+#include <graph_transformer.hpp>
+
+namespace VPU {
+namespace Common {
+
+// Everything needed to run a compiled network without the graph transformer.
+// Written by ExecutableNetwork::Export() and the offline compiler, read back
+// by ImportNetwork.
+struct ExportedNetwork {
+    uint32_t platform = 0;
+    bool hwOptimization = false;
+    bool hostIoConversion = false;
+    float inputScale = 1.f;
+    float inputBias = 0.f;
+
+    std::string name;
+    uint64_t numStages = 0;
+    // items of the inputs and outputs, the graph runs one inference per item
+    uint64_t batchSize = 1;
+    std::vector<char> graphBlob;
+    std::vector<BlobMetaData> blobMetaData;
+
+    std::vector<std::pair<std::string, InferenceEngine::TensorDesc>> inputs;
+    std::vector<std::pair<std::string, InferenceEngine::TensorDesc>> outputs;
+};
+
+// throw exception in the case of error, fileName is used in the messages only
+void writeExportedNetwork(std::ostream &out, const ExportedNetwork &network, const std::string &fileName);
+ExportedNetwork readExportedNetwork(std::istream &in, const std::string &fileName);
+
+}  // namespace Common
+}  // namespace VPU
@@ -0,0 +1,118 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+#include "network_batch.h"
+#include <set>
+#include <vector>
+#include <ie_util_internal.hpp>
+
+using namespace InferenceEngine;
+
+namespace {
+
+// layouts with the batch as their outermost dimension
+bool isBatchLayout(Layout layout) {
+    return layout == NCHW || layout == NHWC || layout == NC;
+}
+
+}  // namespace
+
+details::CNNNetworkImplPtr VPU::Common::cloneNetwork(ICNNNetwork &network) {
+    auto clone = cloneNet(network);
+
+    char networkName[1024] = {};
+    network.getName(networkName, sizeof(networkName));
+    clone->setName(networkName);
+    clone->setPrecision(network.getPrecision());
+    return clone;
+}
+
+size_t VPU::Common::getNetworkBatch(const InputsDataMap &inputs, const OutputsDataMap &outputs) {
+    if (inputs.empty()) {
+        return 1;
+    }
+
+    const auto &firstDesc = inputs.begin()->second->getTensorDesc();
+    if (!isBatchLayout(firstDesc.getLayout())) {
+        return 1;
+    }
+    size_t batch = firstDesc.getDims()[0];
+
+    // the results of one item must be a slice of every output
+    for (const auto &input : inputs) {
+        const auto &desc = input.second->getTensorDesc();
+        if (!isBatchLayout(desc.getLayout()) || desc.getDims()[0] != batch) {
+            return 1;
+        }
+    }
+    for (const auto &output : outputs) {
+        const auto &desc = output.second->getTensorDesc();
+        if (!isBatchLayout(desc.getLayout()) || desc.getDims()[0] != batch) {
+            return 1;
+        }
+    }
+    return batch;
+}
+
+void VPU::Common::removeNetworkBatch(ICNNNetwork &network, size_t batch) {
+    InputsDataMap inputs;
+    network.getInputsInfo(inputs);
+
+    std::vector<DataPtr> dataToVisit;
+    for (const auto &input : inputs) {
+        dataToVisit.push_back(input.second->getInputData());
+    }
+
+    std::set<DataPtr> visitedData;
+    while (!dataToVisit.empty()) {
+        auto data = dataToVisit.back();
+        dataToVisit.pop_back();
+        if (!visitedData.insert(data).second) {
+            continue;
+        }
+
+        // tensors not batched this way are left to the graph transformer to reject
+        const auto &desc = data->getTensorDesc();
+        if (isBatchLayout(desc.getLayout()) && desc.getDims()[0] == batch) {
+            auto dims = desc.getDims();
+            dims[0] = 1;
+            data->setDims(dims);
+        }
+
+        for (const auto &consumer : data->getInputTo()) {
+            for (const auto &output : consumer.second->outData) {
+                dataToVisit.push_back(output);
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+#pragma once
+
+#include <ie_icnn_network.hpp>
+#include <ie_input_info.hpp>
+#include <cnn_network_impl.hpp>
+
+namespace VPU {
+namespace Common {
+
+// Copies the layers of the network along with its name and precision.
+InferenceEngine::details::CNNNetworkImplPtr cloneNetwork(InferenceEngine::ICNNNetwork &network);
+
+// The batch of the network: the outermost dimension shared by all its
+// inputs and outputs, or 1 if they do not share one.
+size_t getNetworkBatch(const InferenceEngine::InputsDataMap &inputs,
+                       const InferenceEngine::OutputsDataMap &outputs);
+
+// Sets the batch of every tensor of the network that has the given batch to 1.
+// A batched network is compiled this way for one item of the batch and runs
+// one inference per item.
+void removeNetworkBatch(InferenceEngine::ICNNNetwork &network, size_t batch);
+
+}  // namespace Common
+}  // namespace VPU
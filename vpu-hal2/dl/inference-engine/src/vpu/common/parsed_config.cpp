@@ -100,7 +100,13 @@ ParsedConfig::ParsedConfig(const int platform, const std::map<std::string, std::
     blobConfig.ignoreUnknownLayers = parseOptimizationOption(config[VPU_CONFIG_KEY(IGNORE_UNKNOWN_LAYERS)]);
     blobConfig.hwOptimization = parseOptimizationOption(config[VPU_CONFIG_KEY(HW_STAGES_OPTIMIZATION)]);
     blobConfig.useCmxBuffers = parseOptimizationOption(config[VPU_CONFIG_KEY(USE_CMX_BUFFERS)]);
+    blobConfig.hostIoConversion = parseOptimizationOption(config[VPU_CONFIG_KEY(HOST_IO_CONVERSION)]);
+    blobConfig.compilationStats = parseOptimizationOption(config[VPU_CONFIG_KEY(COMPILATION_STATS)]);
+    blobConfig.weightsCompression = parseOptimizationOption(config[VPU_CONFIG_KEY(WEIGHTS_COMPRESSION)]);
     exclusiveAsyncRequests = parseOptimizationOption(config[CONFIG_KEY(EXCLUSIVE_ASYNC_REQUESTS)]);
+    multiDevice = parseOptimizationOption(config[VPU_CONFIG_KEY(MULTI_DEVICE)]);
+    partitionDeviceResources = parseOptimizationOption(config[VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES)]);
+    fifoDepth = stoi(config[VPU_CONFIG_KEY(FIFO_DEPTH)]);
     printReceiveTensorTime = parseOptimizationOption(config[VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME)]);
 
     blobConfig.cmxBufferStart = stoi(config[VPU_CONFIG_KEY(CMX_BUFFER_START)]);
@@ -109,6 +115,7 @@ ParsedConfig::ParsedConfig(const int platform, const std::map<std::string, std::
     parseStringList(config[VPU_CONFIG_KEY(NONE_LAYERS)], blobConfig.NoneLayers);
     parseStringList(config[VPU_CONFIG_KEY(HW_WHITE_LIST)], blobConfig.hwWhiteList);
     parseStringList(config[VPU_CONFIG_KEY(HW_BLACK_LIST)], blobConfig.hwBlackList);
+    blobConfig.hwConvCostModel = config[VPU_CONFIG_KEY(HW_CONV_COST_MODEL)];
 
     float norm = stof(config[VPU_CONFIG_KEY(INPUT_NORM)]);
     blobConfig.inputScale = 1.f / norm;
@@ -166,8 +173,13 @@ void ParsedConfig::validate(const std::map<std::string, std::string> &_config, c
             !isOptimizationOption(config[VPU_CONFIG_KEY(IGNORE_UNKNOWN_LAYERS)]) ||
             !isOptimizationOption(config[VPU_CONFIG_KEY(HW_STAGES_OPTIMIZATION)]) ||
             !isOptimizationOption(config[VPU_CONFIG_KEY(USE_CMX_BUFFERS)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(HOST_IO_CONVERSION)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(COMPILATION_STATS)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(WEIGHTS_COMPRESSION)]) ||
             !isOptimizationOption(config[CONFIG_KEY(PERF_COUNT)]) ||
-            !isOptimizationOption(config[CONFIG_KEY(EXCLUSIVE_ASYNC_REQUESTS)])) {
+            !isOptimizationOption(config[CONFIG_KEY(EXCLUSIVE_ASYNC_REQUESTS)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(MULTI_DEVICE)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES)])) {
             THROW_IE_EXCEPTION << "Incorrect value for optimization option";
         }
     } else {  // MYRIAD_2 or UNKNOWN
@@ -175,8 +187,13 @@ void ParsedConfig::validate(const std::map<std::string, std::string> &_config, c
             !isOptimizationOption(config[VPU_CONFIG_KEY(RESHAPE_OPTIMIZATION)]) ||
             !isOptimizationOption(config[VPU_CONFIG_KEY(MEMORY_OPTIMIZATION)]) ||
             !isOptimizationOption(config[VPU_CONFIG_KEY(IGNORE_UNKNOWN_LAYERS)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(HOST_IO_CONVERSION)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(COMPILATION_STATS)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(WEIGHTS_COMPRESSION)]) ||
             !isOptimizationOption(config[CONFIG_KEY(PERF_COUNT)]) ||
-            !isOptimizationOption(config[CONFIG_KEY(EXCLUSIVE_ASYNC_REQUESTS)])) {
+            !isOptimizationOption(config[CONFIG_KEY(EXCLUSIVE_ASYNC_REQUESTS)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(MULTI_DEVICE)]) ||
+            !isOptimizationOption(config[VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES)])) {
            THROW_IE_EXCEPTION << "Incorrect value for optimization option";
        }
     }
@@ -194,6 +211,11 @@ void ParsedConfig::validate(const std::map<std::string, std::string> &_config, c
     if (norm == 0.0f) {
         THROW_IE_EXCEPTION << "Incorrect zero value for KEY_VPU_INPUT_NORM option";
     }
+
+    int fifoDepth = stoi(config[VPU_CONFIG_KEY(FIFO_DEPTH)]);
+    if (fifoDepth < 1) {
+        THROW_IE_EXCEPTION << "Incorrect value for KEY_VPU_FIFO_DEPTH option";
+    }
 }
 
 std::map<std::string, std::string> ParsedConfig::getDefaultConfig(const int platform) {
@@ -217,9 +239,16 @@ std::map<std::string, std::string> ParsedConfig::getDefaultConfig(const int plat
                 {VPU_CONFIG_KEY(USE_CMX_BUFFERS),        CONFIG_VALUE(YES)},
                 {VPU_CONFIG_KEY(HW_WHITE_LIST),    ""},
                 {VPU_CONFIG_KEY(HW_BLACK_LIST),    ""},
+                {VPU_CONFIG_KEY(HW_CONV_COST_MODEL), ""},
                 {VPU_CONFIG_KEY(CMX_BUFFER_START), "0"},
                 {VPU_CONFIG_KEY(CMX_BUFFER_SIZE),  "1048576"},
-                {VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME),    CONFIG_VALUE(NO)}
+                {VPU_CONFIG_KEY(HOST_IO_CONVERSION),     CONFIG_VALUE(YES)},
+                {VPU_CONFIG_KEY(MULTI_DEVICE),           CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES), CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(FIFO_DEPTH),       "4"},
+                {VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME),    CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(COMPILATION_STATS),      CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(WEIGHTS_COMPRESSION),    CONFIG_VALUE(NO)}
         };
     } else if (platform == MYRIAD_2) {
         return {{VPU_CONFIG_KEY(FIRST_SHAVE),      "0"},
@@ -241,9 +270,16 @@ std::map<std::string, std::string> ParsedConfig::getDefaultConfig(const int plat
                 {VPU_CONFIG_KEY(USE_CMX_BUFFERS),        CONFIG_VALUE(NO)},
                 {VPU_CONFIG_KEY(HW_WHITE_LIST),    ""},
                 {VPU_CONFIG_KEY(HW_BLACK_LIST),    ""},
+                {VPU_CONFIG_KEY(HW_CONV_COST_MODEL), ""},
                 {VPU_CONFIG_KEY(CMX_BUFFER_START), "0"},
                 {VPU_CONFIG_KEY(CMX_BUFFER_SIZE),  "0"},
-                {VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME),    CONFIG_VALUE(NO)}
+                {VPU_CONFIG_KEY(HOST_IO_CONVERSION),     CONFIG_VALUE(YES)},
+                {VPU_CONFIG_KEY(MULTI_DEVICE),           CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES), CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(FIFO_DEPTH),       "4"},
+                {VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME),    CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(COMPILATION_STATS),      CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(WEIGHTS_COMPRESSION),    CONFIG_VALUE(NO)}
         };
     } else {
         return {{CONFIG_KEY(EXCLUSIVE_ASYNC_REQUESTS),   CONFIG_VALUE(NO)},
@@ -259,7 +295,13 @@ std::map<std::string, std::string> ParsedConfig::getDefaultConfig(const int plat
                 {VPU_CONFIG_KEY(INPUT_BIAS),       "0.0"},
                 {VPU_CONFIG_KEY(IGNORE_UNKNOWN_LAYERS),  CONFIG_VALUE(NO)},
                 {VPU_CONFIG_KEY(NONE_LAYERS),      ""},
-                {VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME),    CONFIG_VALUE(NO)}
+                {VPU_CONFIG_KEY(HOST_IO_CONVERSION),     CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(MULTI_DEVICE),           CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES), CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(FIFO_DEPTH),       "4"},
+                {VPU_CONFIG_KEY(PRINT_RECEIVE_TENSOR_TIME),    CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(COMPILATION_STATS),      CONFIG_VALUE(NO)},
+                {VPU_CONFIG_KEY(WEIGHTS_COMPRESSION),    CONFIG_VALUE(NO)}
         };
     }
 }
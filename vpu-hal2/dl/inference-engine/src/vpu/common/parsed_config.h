@@ -52,6 +52,9 @@ struct ParsedConfig {
 
     bool printReceiveTensorTime = false;
     bool exclusiveAsyncRequests = false;
+    bool multiDevice = false;
+    bool partitionDeviceResources = false;
+    int fifoDepth = 4;
 
     static LogLevel parseLogLevel(const std::string &option);
 
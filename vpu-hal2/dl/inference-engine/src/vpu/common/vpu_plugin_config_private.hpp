@@ -41,5 +41,22 @@ DECLARE_VPU_CONFIG_KEY(CMX_BUFFER_SIZE);
 DECLARE_VPU_CONFIG_KEY(HW_WHITE_LIST);
 DECLARE_VPU_CONFIG_KEY(HW_BLACK_LIST);
 
+// Cost model used to pick HW convolution tiling: empty for fewest descriptors first,
+// or "<descriptor_us>,<compute_us>" to estimate time from calibrated coefficients
+DECLARE_VPU_CONFIG_KEY(HW_CONV_COST_MODEL);
+
+DECLARE_VPU_CONFIG_KEY(HOST_IO_CONVERSION);
+
+DECLARE_VPU_CONFIG_KEY(COMPILATION_STATS);
+
+// Store the weights of compiled networks block-sparse coded, so they are cached,
+// exported and imported in fewer bytes; decoded on the host before loading
+DECLARE_VPU_CONFIG_KEY(WEIGHTS_COMPRESSION);
+
+// Split the SHAVEs and CMX of a device between the graphs allocated on it,
+// recompiling them when another graph joins the device. Off by default, as
+// a network then keeps a copy of itself, weights included, to recompile
+DECLARE_VPU_CONFIG_KEY(PARTITION_DEVICE_RESOURCES);
+
 }  // namespace VPUConfigParams
 }  // namespace InferenceEngine
@@ -0,0 +1,259 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+// Measures the finalize pass of the graph transformer, which writes the
+// weights into the blob, with the data writers run one by one and in
+// parallel (IE_VPU_DATA_WRITER_THREADS), and checks both give the same blob.
+// The network is generated with random weights: a chain of 3x3 and 1x1
+// convolutions on a small feature map, ~105M parameters by default, so the
+// time is spent in the writers rather than in the other passes.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <inference_engine.hpp>
+#include <precision_utils.h>
+#include <parsed_config.h>
+#include <graph_transformer.hpp>
+
+using namespace InferenceEngine;
+using namespace VPU;
+using namespace VPU::Common;
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  -p <2450|2480>  target platform, 2450 (MYRIAD_2) by default\n"
+              << "  -t <threads>    IE_VPU_DATA_WRITER_THREADS to compare with 1, all cores by default\n"
+              << "  -b <blocks>     number of 3x3 + 1x1 convolution pairs, 10 by default\n"
+              << "  -c <channels>   channels of every convolution, 1024 by default\n"
+              << "  -s <size>       height and width of the feature maps, 7 by default\n"
+              << "  -n <count>      compilations per mode, the fastest is reported, 3 by default\n";
+}
+
+class ConvChainBuilder {
+public:
+    ConvChainBuilder(int channels, int size) : channels(channels), size(size) {
+        layers << "<layer id=\"0\" name=\"data\" type=\"Input\" precision=\"FP16\">"
+               << "<output>" << port(0) << "</output></layer>\n";
+    }
+
+    void conv(int kernel) {
+        int id = nextId++;
+        size_t weightsCount = static_cast<size_t>(channels) * channels * kernel * kernel;
+        size_t weightsOffset = append(weightsCount);
+        size_t biasesOffset = append(channels);
+        layers << "<layer id=\"" << id << "\" name=\"conv" << id << "\" type=\"Convolution\" precision=\"FP16\">"
+               << "<data kernel-x=\"" << kernel << "\" kernel-y=\"" << kernel << "\" stride-x=\"1\" stride-y=\"1\""
+               << " pad-x=\"" << kernel / 2 << "\" pad-y=\"" << kernel / 2 << "\" output=\"" << channels
+               << "\" group=\"1\"/>"
+               << "<input>" << port(0) << "</input>"
+               << "<output>" << port(1) << "</output>"
+               << "<blobs><weights offset=\"" << weightsOffset * sizeof(ie_fp16) << "\" size=\""
+               << weightsCount * sizeof(ie_fp16) << "\"/>"
+               << "<biases offset=\"" << biasesOffset * sizeof(ie_fp16) << "\" size=\""
+               << channels * sizeof(ie_fp16) << "\"/></blobs></layer>\n";
+        edges << "<edge from-layer=\"" << id - 1 << "\" from-port=\"" << (id == 1 ? 0 : 1)
+              << "\" to-layer=\"" << id << "\" to-port=\"0\"/>\n";
+    }
+
+    size_t parameters() const {
+        return weights.size();
+    }
+
+    std::string xml() const {
+        return "<net name=\"data_writer_benchmark\" version=\"2\" batch=\"1\">\n<layers>\n" + layers.str() +
+               "</layers>\n<edges>\n" + edges.str() + "</edges>\n</net>\n";
+    }
+
+    TBlob<uint8_t>::Ptr weightsBlob() const {
+        auto blob = make_shared_blob<uint8_t>(Precision::U8, C, {weights.size() * sizeof(ie_fp16)});
+        blob->allocate();
+        std::copy(weights.begin(), weights.end(), blob->buffer().as<ie_fp16 *>());
+        return blob;
+    }
+
+private:
+    std::string port(int id) const {
+        std::ostringstream out;
+        out << "<port id=\"" << id << "\"><dim>1</dim><dim>" << channels << "</dim><dim>" << size
+            << "</dim><dim>" << size << "</dim></port>";
+        return out.str();
+    }
+
+    size_t append(size_t count) {
+        size_t offset = weights.size();
+        std::normal_distribution<float> dist(0.0f, 0.05f);
+        for (size_t i = 0; i < count; i++)
+            weights.push_back(PrecisionUtils::f32tof16(dist(generator)));
+        return offset;
+    }
+
+    int channels;
+    int size;
+    int nextId = 1;
+    std::ostringstream layers;
+    std::ostringstream edges;
+    std::vector<ie_fp16> weights;
+    std::mt19937 generator{42};
+};
+
+void setWriterThreads(int threads) {
+    std::string value = std::to_string(threads);
+#ifdef _WIN32
+    _putenv_s("IE_VPU_DATA_WRITER_THREADS", value.c_str());
+#else
+    setenv("IE_VPU_DATA_WRITER_THREADS", value.c_str(), 1);
+#endif
+}
+
+struct Result {
+    double finalizeMs;
+    std::vector<char> blob;
+};
+
+Result measure(CNNNetwork &network, int platform, int threads, int count) {
+    std::map<std::string, std::string> config = {
+        {VPU_CONFIG_KEY(COMPILATION_STATS), CONFIG_VALUE(YES)}
+    };
+    ParsedConfig parsedConfig(platform, config);
+    if (platform == MYRIAD_2) {
+        parsedConfig.blobConfig.hwOptimization = false;
+    }
+    auto log = std::make_shared<Logger>();
+    setWriterThreads(threads);
+
+    Result result = {std::numeric_limits<double>::max(), {}};
+    for (int i = 0; i < count; i++) {
+        std::vector<BlobMetaData> metadata;
+        size_t numStages = 0;
+        createGraphTransformer(parsedConfig.blobConfig, log)->generate(network, result.blob, metadata, numStages);
+
+        auto finalize = std::find_if(metadata.begin(), metadata.end(), [](const BlobMetaData &meta) {
+            return meta.name == "Compile-finalize";
+        });
+        if (finalize == metadata.end()) {
+            THROW_IE_EXCEPTION << "The graph transformer did not report the finalize pass";
+        }
+        result.finalizeMs = std::min(result.finalizeMs, finalize->compileTime_uSec / 1000.0);
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int platform = MYRIAD_2, blocks = 10, channels = 1024, size = 7, count = 3;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-p") {
+            platform = std::atoi(value.c_str());
+            if (platform != MYRIAD_X && platform != MYRIAD_2) {
+                std::cerr << "Unsupported platform " << value << ", expected 2450 or 2480\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "-t") {
+            threads = std::atoi(value.c_str());
+        } else if (arg == "-b") {
+            blocks = std::atoi(value.c_str());
+        } else if (arg == "-c") {
+            channels = std::atoi(value.c_str());
+        } else if (arg == "-s") {
+            size = std::atoi(value.c_str());
+        } else if (arg == "-n") {
+            count = std::atoi(value.c_str());
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (threads < 1 || blocks < 1 || channels < 1 || size < 1 || count < 1) {
+        std::cerr << "Expected positive values\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        ConvChainBuilder builder(channels, size);
+        for (int b = 0; b < blocks; b++) {
+            builder.conv(3);
+            builder.conv(1);
+        }
+
+        std::string xml = builder.xml();
+        CNNNetReader reader;
+        reader.ReadNetwork(xml.data(), xml.size());
+        reader.SetWeights(builder.weightsBlob());
+        CNNNetwork network = reader.getNetwork();
+
+        std::cout << 2 * blocks << " convolutions, " << channels << " channels of " << size << "x" << size
+                  << ", " << builder.parameters() << " parameters\n";
+        Result serial = measure(network, platform, 1, count);
+        std::cout << "IE_VPU_DATA_WRITER_THREADS=1: finalize " << serial.finalizeMs << " ms, blob "
+                  << serial.blob.size() << " bytes\n";
+        Result parallel = measure(network, platform, threads, count);
+        std::cout << "IE_VPU_DATA_WRITER_THREADS=" << threads << ": finalize " << parallel.finalizeMs
+                  << " ms, " << serial.finalizeMs / parallel.finalizeMs << "x\n";
+
+        if (serial.blob != parallel.blob) {
+            std::cerr << "Blobs differ\n";
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
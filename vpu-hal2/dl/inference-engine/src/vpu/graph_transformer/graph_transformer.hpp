@@ -33,6 +33,7 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -46,6 +47,15 @@ struct BlobMetaData {
     std::string exec_type;
     std::string layer_type;
     InferenceEngine::InferenceEngineProfileInfo::LayerStatus status;
+    // Wall time of a graph transformer pass; passes are NOT_RUN entries
+    // placed after the stages and the transfers
+    long long compileTime_uSec = 0;
+    // Tiling of a HW convolution stage as its cost model sees it: number of
+    // descriptors, their total compute cost per output pixel and the output
+    // X * Y pixels; 0 for other stages
+    uint32_t hwDescriptors = 0;
+    uint32_t hwComputeCost = 0;
+    uint32_t hwOutputPixels = 0;
 };
 
 struct BlobConfig {
@@ -54,10 +64,19 @@ struct BlobConfig {
     bool copyOptimization, reshapeOptimization;
     uint32_t cmxBufferStart, cmxBufferSize;
     float inputScale, inputBias;
+    // FP32 network inputs and outputs are sent to the device as FP16 and
+    // converted on the host, input scale and bias included
+    bool hostIoConversion;
     std::vector<std::string> NoneLayers;
     std::vector<std::string> hwWhiteList;
     std::vector<std::string> hwBlackList;
+    // see KEY_VPU_HW_CONV_COST_MODEL
+    std::string hwConvCostModel;
     bool ignoreUnknownLayers;
+    // report wall time and graph statistics of every graph transformer pass
+    bool compilationStats;
+    // code the weights of the blob, see blob_compression.h
+    bool weightsCompression;
 };
 
 class IGraphTransformer {
@@ -73,4 +92,13 @@ public:
 std::shared_ptr<IGraphTransformer> createGraphTransformer(const BlobConfig& blobConfig,
                                                           const Common::LoggerPtr& log);
 
+// Fits the time per descriptor and per unit of compute cost and output pixel
+// of the HW convolutions to their measured stage times, perfCounts of the
+// network the metadata was compiled for. Returns them as a
+// KEY_VPU_HW_CONV_COST_MODEL value; throws if the network has no timed HW
+// convolution.
+std::string calibrateHwConvCostModel(
+        const std::vector<BlobMetaData>& metadata,
+        const std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>& perfCounts);
+
 }  // namespace VPU
@@ -43,8 +43,18 @@
 #include <fstream>
 #include <utility>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <iomanip>
+#include <sstream>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <precision_utils.h>
 #include <caseless.hpp>
+#include <blob_compression.h>
 
 #ifdef NNLOG
 #include <android/log.h>
@@ -247,6 +257,12 @@ VpuDataType iePrecisionToVpu(const Precision& precision) {
     }
 }
 
+VpuDataType ioPrecisionToVpu(const Precision& precision, const BlobConfig& blobConfig) {
+    if (precision == Precision::FP32 && blobConfig.hostIoConversion)
+        return VpuDataType::FP16;
+    return iePrecisionToVpu(precision);
+}
+
 VpuDims ieDimsToVpu(const SizeVector& ieDims) {
     VpuDims vpuDims(4);
 
@@ -534,8 +550,185 @@ private:
 };
 #endif
 
+// Below that size threads cost more than they save
+const size_t PARALLEL_WRITE_MIN_BYTES = 1024 * 1024;
+
+// Runs the writers of the blob data. Their destination ranges were assigned
+// by packMemory and do not overlap, so the writers run in parallel, the
+// largest first, and the blob stays the same as with serial writing.
+// IE_VPU_DATA_WRITER_THREADS caps the number of threads, 1 writes serially;
+// data_writer_benchmark compares the two.
+void runDataWriters(std::vector<std::pair<DataWriterPtr, char*>>& jobs) {
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const std::pair<DataWriterPtr, char*>& a, const std::pair<DataWriterPtr, char*>& b) {
+                         return a.first->byteSize() > b.first->byteSize();
+                     });
+
+    size_t totalBytes = 0;
+    for (const auto& job : jobs) {
+        totalBytes += job.first->byteSize();
+    }
+
+    size_t numThreads = std::min<size_t>(std::thread::hardware_concurrency(), jobs.size());
+    if (auto maxThreads = std::getenv("IE_VPU_DATA_WRITER_THREADS")) {
+        numThreads = std::min<size_t>(numThreads, std::max(std::atoi(maxThreads), 1));
+    }
+    if (numThreads < 2 || totalBytes < PARALLEL_WRITE_MIN_BYTES) {
+        for (const auto& job : jobs) {
+            job.first->write(job.second);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextJob(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            try {
+                jobs[i].first->write(jobs[i].second);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+size_t countActiveStages(const std::list<VpuStagePtr>& stages) {
+    size_t count = 0;
+    for (const auto& stage : stages) {
+        if (!stage->optimized)
+            ++count;
+    }
+    return count;
+}
+
 }  // namespace
 
+template <class Pass>
+void GraphTransformerImpl::runPass(const char* name, const Pass& pass) {
+    if (!_collectPassStats) {
+        pass();
+        return;
+    }
+
+    PassStats stats;
+    stats.name = name;
+    stats.stagesBefore = countActiveStages(_stages);
+    stats.datasBefore = _datas.size();
+
+    // passes insert and remove data anywhere in the list, so the new ones
+    // are told apart by identity rather than by position
+    std::unordered_set<const VpuData*> datasBefore;
+    for (const auto& data : _datas) {
+        datasBefore.insert(data.get());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pass();
+    auto end = std::chrono::steady_clock::now();
+
+    stats.time_uSec = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    stats.stagesAfter = countActiveStages(_stages);
+    stats.datasAfter = _datas.size();
+
+    stats.weightsBytes = 0;
+    stats.totalWeightsBytes = 0;
+    for (const auto& data : _datas) {
+        if (data->index != IndexBlob || data->writer == nullptr)
+            continue;
+        stats.totalWeightsBytes += data->writer->byteSize();
+        if (datasBefore.count(data.get()) == 0)
+            stats.weightsBytes += data->writer->byteSize();
+    }
+
+    stats.cmxMemSize = _cmxMemSize;
+    stats.bssMemSize = _bssMemSize;
+
+    LOG_INFO("[VPU] GraphTransformer : pass %s took %lld us, stages %u -> %u, datas %u -> %u, weights %u bytes",
+             name, stats.time_uSec,
+             static_cast<uint32_t>(stats.stagesBefore), static_cast<uint32_t>(stats.stagesAfter),
+             static_cast<uint32_t>(stats.datasBefore), static_cast<uint32_t>(stats.datasAfter),
+             static_cast<uint32_t>(stats.weightsBytes));
+
+    _passStats.push_back(stats);
+}
+
+namespace {
+
+std::string escapeJson(const std::string& str) {
+    std::ostringstream out;
+    for (char c : str) {
+        switch (c) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                    << std::dec;
+            } else {
+                out << c;
+            }
+        }
+    }
+    return out.str();
+}
+
+}  // namespace
+
+void GraphTransformerImpl::dumpPassStatsToJson(const std::string& fileName) const {
+    std::ofstream file(fileName);
+    if (!file.is_open()) {
+        THROW_IE_EXCEPTION << "[VPU] Cannot open file " << fileName << " for writing";
+    }
+
+    file << "{\n";
+    file << "  \"network\": \"" << escapeJson(_networkName) << "\",\n";
+    file << "  \"post_ops\": {"
+         << "\"fused_stages\": " << _postOpStats.fusedStages() << ", "
+         << "\"bias_activations\": " << _postOpStats.biasActivations << ", "
+         << "\"hw_post_ops\": " << _postOpStats.hwPostOps << ", "
+         << "\"in_place_post_ops\": " << _postOpStats.inPlacePostOps << ", "
+         << "\"eltwise_activations\": " << _postOpStats.eltwiseActivations
+         << "},\n";
+    file << "  \"passes\": [\n";
+    for (size_t i = 0; i < _passStats.size(); ++i) {
+        const auto& stats = _passStats[i];
+        file << "    {"
+             << "\"name\": \"" << escapeJson(stats.name) << "\", "
+             << "\"time_us\": " << stats.time_uSec << ", "
+             << "\"stages_before\": " << stats.stagesBefore << ", "
+             << "\"stages_after\": " << stats.stagesAfter << ", "
+             << "\"datas_before\": " << stats.datasBefore << ", "
+             << "\"datas_after\": " << stats.datasAfter << ", "
+             << "\"weights_bytes\": " << stats.weightsBytes << ", "
+             << "\"total_weights_bytes\": " << stats.totalWeightsBytes << ", "
+             << "\"cmx_bytes\": " << stats.cmxMemSize << ", "
+             << "\"bss_bytes\": " << stats.bssMemSize
+             << "}" << (i + 1 < _passStats.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+}
+
 void GraphTransformerImpl::generate(ICNNNetwork& network,
                                     std::vector<char>& blob,
                                     std::vector<BlobMetaData>& metaData,
@@ -545,38 +738,51 @@ void GraphTransformerImpl::generate(ICNNNetwork& network,
     (void)autoDumper;
 #endif
 
-    parseNetwork(network);
+    auto statsFileName = std::getenv("IE_VPU_DUMP_PASS_STATS_FILE_NAME");
+    _collectPassStats = _blobConfig.compilationStats || statsFileName != nullptr;
+    _passStats.clear();
+    _postOpStats = PostOpStats();
+
+    runPass("parseNetwork", [&]() { parseNetwork(network); });
 
-    parseInputAndOutputData();
-    addInputConvertStages();
-    addPreProcessStages();
+    runPass("parseInputAndOutputData", [this]() { parseInputAndOutputData(); });
+    runPass("addInputConvertStages", [this]() { addInputConvertStages(); });
+    runPass("addPreProcessStages", [this]() { addPreProcessStages(); });
 
-    generateStages();
+    runPass("generateStages", [this]() { generateStages(); });
 
-    addOutputConvertStages();
+    runPass("addOutputConvertStages", [this]() { addOutputConvertStages(); });
 
-    packPostOps();
+    runPass("packPostOps", [this]() { packPostOps(); });
     // this optimization must be before addConvertOrderStages();
     // because it can wrap reshape with additional convert order stages
     if (_blobConfig.reshapeOptimization) {
-        eliminateReshapeStages();
+        runPass("eliminateReshapeStages", [this]() { eliminateReshapeStages(); });
     }
     if (_blobConfig.hwOptimization) {
-        addHWStages();
+        runPass("addHWStages", [this]() { addHWStages(); });
         if (_blobConfig.copyOptimization) {
-            packHWConcat();
+            runPass("packHWConcat", [this]() { packHWConcat(); });
         }
     }
-    addConvertOrderStages();
+    runPass("addConvertOrderStages", [this]() { addConvertOrderStages(); });
     if (_blobConfig.copyOptimization) {
-        eliminateCopyStages();
+        runPass("eliminateCopyStages", [this]() { eliminateCopyStages(); });
     }
     if (_blobConfig.hwOptimization) {
-        fillHWDescriptors();
+        runPass("fillHWDescriptors", [this]() { fillHWDescriptors(); });
     }
-    packMemory();
+    runPass("packMemory", [this]() { packMemory(); });
 
-    finalize(blob);
+    runPass("finalize", [&]() { finalize(blob); });
+
+    LOG_INFO("[VPU] GraphTransformer : %u stages fused (%u Bias+activation, %u HW post-ops), "
+             "%u post-ops in-place (%u after Eltwise)",
+             static_cast<uint32_t>(_postOpStats.fusedStages()),
+             static_cast<uint32_t>(_postOpStats.biasActivations),
+             static_cast<uint32_t>(_postOpStats.hwPostOps),
+             static_cast<uint32_t>(_postOpStats.inPlacePostOps),
+             static_cast<uint32_t>(_postOpStats.eltwiseActivations));
 
 #ifndef NDEBUG
     if (auto dumpFileName = std::getenv("IE_VPU_DUMP_BLOB_FILE_NAME")) {
@@ -588,14 +794,13 @@ void GraphTransformerImpl::generate(ICNNNetwork& network,
     }
 #endif
 
+    if (statsFileName != nullptr) {
+        dumpPassStatsToJson(statsFileName);
+    }
 
     getMetaData(metaData);
     LOG_INFO("[VPU] GraphTransformer : getMetaData done");
-    numStages = 0;
-    for (const auto& stage : _stages) {
-        if (!stage->optimized)
-            ++numStages;
-    }
+    numStages = countActiveStages(_stages);
 }
 
 void GraphTransformerImpl::generateStages() {
@@ -929,15 +1134,17 @@ void GraphTransformerImpl::finalize(std::vector<char>& blob) {
     std::copy_n(&bufSecHdr, 1, reinterpret_cast<mv_buffer_section_header*>(&blob[curBlobOffset]));
     curBlobOffset += sizeof(bufSecHdr);
 
+    std::vector<std::pair<DataWriterPtr, char*>> writeJobs;
     for (const auto& data : _datas) {
         assert(data != nullptr);
 
         if (data->index == IndexBlob) {
             if (data->writer != nullptr) {
-                data->writer->write(&blob[curBlobOffset] + data->offset);
+                writeJobs.push_back({data->writer, &blob[curBlobOffset] + data->offset});
             }
         }
     }
+    runDataWriters(writeJobs);
     curBlobOffset += _blobTotalDataSize;
 
     std::copy_n(&mvRelocSecHdr, 1, reinterpret_cast<mv_relocation_section_header*>(&blob[curBlobOffset]));
@@ -955,6 +1162,16 @@ void GraphTransformerImpl::finalize(std::vector<char>& blob) {
     std::copy(stagesWriter.stagesData.begin(), stagesWriter.stagesData.end(), &blob[curBlobOffset]);
     curBlobOffset += stagesWriter.stagesData.size();
 
+    if (_blobConfig.weightsCompression) {
+        auto plainSize = blob.size();
+        if (Common::compressBlobWeights(blob, dataSecOffset + sizeof(bufSecHdr), _blobTotalDataSize)) {
+            LOG_INFO("[VPU] GraphTransformer : weights compressed, blob %u -> %u bytes",
+                     static_cast<uint32_t>(plainSize), static_cast<uint32_t>(blob.size()));
+        } else {
+            LOG_INFO("[VPU] GraphTransformer : weights left plain, compression would not shrink them");
+        }
+    }
+
     LOG_INFO("[VPU] GraphTransformer : blobSize=%u", static_cast<uint32_t>(sizeof(char) * blob.size()));
     #ifdef NNLOG
     ALOGI("[VPU] GraphTransformer : blobSize=%u", static_cast<uint32_t>(sizeof(char) * blob.size()));
@@ -974,6 +1191,11 @@ void GraphTransformerImpl::getMetaData(std::vector<BlobMetaData>& metaData) {
         meta.layer_type = meta.exec_type;
         meta.status = stage->optimized ? InferenceEngineProfileInfo::OPTIMIZED_OUT
                                        : InferenceEngineProfileInfo::EXECUTED;
+        if (auto hwStage = std::dynamic_pointer_cast<VpuMyriadXHwConvolutionStage>(stage)) {
+            meta.hwDescriptors = static_cast<uint32_t>(hwStage->tiles.size());
+            meta.hwComputeCost = hwStage->tilingCost;
+            meta.hwOutputPixels = hwStage->tilingOutputPixels;
+        }
         metaData.push_back(meta);
     }
 
@@ -999,6 +1221,16 @@ void GraphTransformerImpl::getMetaData(std::vector<BlobMetaData>& metaData) {
     saveUsbTransferMeta.name = "GetOutput";
     saveUsbTransferMeta.status = InferenceEngineProfileInfo::EXECUTED;
     metaData.push_back(saveUsbTransferMeta);
+
+    for (const auto& stats : _passStats) {
+        BlobMetaData passMeta;
+        passMeta.name = "Compile-" + stats.name;
+        passMeta.exec_type = "Compile-Pass";
+        passMeta.layer_type = "Compile-Pass";
+        passMeta.status = InferenceEngineProfileInfo::NOT_RUN;
+        passMeta.compileTime_uSec = stats.time_uSec;
+        metaData.push_back(passMeta);
+    }
 }
 
 VpuDataHandle GraphTransformerImpl::getVpuData(const DataPtr& ieData) {
@@ -85,6 +85,9 @@ enum class VpuDataType {
 
 uint32_t getDataTypeSize(VpuDataType type);
 VpuDataType iePrecisionToVpu(const Precision& precision);
+// Type of a network input or output in device memory, which differs from
+// its IE precision when the host converts FP32 to FP16.
+VpuDataType ioPrecisionToVpu(const Precision& precision, const BlobConfig& blobConfig);
 
 std::string mvTensorOpTypeToStr(t_MvTensorOpType type);
 std::string mvTensorStorageOrderToStr(t_MvTensorStorageOrder order);
@@ -330,6 +333,8 @@ using VpuStagePtr = std::shared_ptr<VpuStage>;
 using VpuStageHandle = Handle<VpuStage>;
 using VpuStageHandleHash = HandleHash<VpuStage>;
 
+class HwConvCostModel;
+
 //
 // Blob write helpers
 //
@@ -426,6 +431,7 @@ struct VpuStage {
     std::vector<t_MvTensorStorageOrder> requiredOutputOrder;
     std::vector<size_t> requiredOutputAlignment;
 
+    // A stage has at most one in-place post-op, the IR has no post-op chains
     VpuStageHandle parentOp;
     VpuStageHandle postOp;
 
@@ -722,6 +728,10 @@ struct VpuMyriadXHwConvolutionStage : VpuStage {
     uint32_t newInputDimZ = 0;
     uint32_t newOutputDimZ = 0;
     Tiles tiles;
+    // compute cost per output pixel of the chosen tiling and the output
+    // pixels, pair the stage time with the cost model
+    uint32_t tilingCost = 0;
+    uint32_t tilingOutputPixels = 0;
 
     bool hasRelu = false;
 
@@ -870,6 +880,43 @@ private:
 
     void getMetaData(std::vector<BlobMetaData>& metaData);
 
+    // Compilation statistics, collected only if enabled by the config
+    // or by IE_VPU_DUMP_PASS_STATS_FILE_NAME
+    struct PassStats {
+        std::string name;
+        long long time_uSec;
+        size_t stagesBefore, stagesAfter;
+        size_t datasBefore, datasAfter;
+        // size of the weights created by the pass, e.g. repacked for HW,
+        // and of all the weights once it ran
+        size_t weightsBytes;
+        size_t totalWeightsBytes;
+        uint32_t cmxMemSize, bssMemSize;
+    };
+
+    template <class Pass>
+    void runPass(const char* name, const Pass& pass);
+
+    void dumpPassStatsToJson(const std::string& fileName) const;
+
+    // Post-ops of the compiled model, always collected. Only the Bias merged
+    // into an activation and the HW post-ops stop being stages; in-place
+    // post-ops still run as SHAVE stages, they only save a buffer.
+    struct PostOpStats {
+        // Bias merged into the following ReLU/LeakyReLU kernel
+        size_t biasActivations = 0;
+        // post-ops running in place on the output of their main stage
+        size_t inPlacePostOps = 0;
+        // of them, activations of an Eltwise stage
+        size_t eltwiseActivations = 0;
+        // post-ops done by the descriptors of a HW stage
+        size_t hwPostOps = 0;
+
+        size_t fusedStages() const {
+            return biasActivations + hwPostOps;
+        }
+    };
+
 private:
     using DataId = const void*;
 
@@ -932,6 +979,7 @@ private:
     using PostOpInfo = std::tuple<VpuStageHandle, VpuDataHandle, std::string>;
     PostOpInfo getPostOpInfoForHW(const VpuStagePtr& mainStage);
 
+    void chooseTopParentOrders(std::unordered_set<VpuDataHandle, VpuDataHandleHash>& topParentVisited);
     VpuDataHandle findOrCreateConvertedData(
             std::unordered_map<VpuDataHandle, std::list<VpuDataHandle>, VpuDataHandleHash>& convertedDataMap,
             const VpuDataHandle& orig,
@@ -968,6 +1016,13 @@ private:
 
     uint32_t _blobTotalDataSize = 0;
     uint32_t _bssMemSize = 0;
+    uint32_t _cmxMemSize = 0;
+
+    std::shared_ptr<const HwConvCostModel> _hwConvCostModel;
+
+    bool _collectPassStats = false;
+    std::vector<PassStats> _passStats;
+    PostOpStats _postOpStats;
 };
 
 typedef void (GraphTransformerImpl::*parser_t)(const CNNLayerPtr& layer,
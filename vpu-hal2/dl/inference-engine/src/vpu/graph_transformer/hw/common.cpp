@@ -37,6 +37,9 @@
 #include <limits>
 #include <string>
 #include <utility>
+#include <cmath>
+#include <memory>
+#include <sstream>
 
 HwPaddingInfo getPadding(const VpuDims& inDims, const VpuDims& outDims,
                          uint32_t kernelDimX, uint32_t kernelDimY,
@@ -190,11 +193,9 @@ int maximizeOutput(int inputSize, int kernelSize, int stride,
     return outputEndIndex + extraLines + !isValid(totalOutputSlice, maxOutputSliceLines, outputEndIndex, outputSize);
 }
 
-}  // namespace
-
-std::vector<TileSoH> heightSolution(int inputSize, int kernelSize, int stride,
-                                    const std::tuple<int, int>& pad,
-                                    int maxOutputLines) {
+std::vector<TileSoH> calcHeightSolution(int inputSize, int kernelSize, int stride,
+                                        const std::tuple<int, int>& pad,
+                                        int maxOutputLines) {
     std::vector<TileSoH> heightSol;
 
     int outputSize = calcOutputSize(inputSize, kernelSize, stride, pad);
@@ -250,9 +251,9 @@ std::vector<TileSoH> heightSolution(int inputSize, int kernelSize, int stride,
     return heightSol;
 }
 
-std::vector<TileSoH> heightSolutionWithPooling(int inputSize, int kernelSize, int stride,
-                                               int pad,
-                                               int maxOutputLines) {
+std::vector<TileSoH> calcHeightSolutionWithPooling(int inputSize, int kernelSize, int stride,
+                                                   int pad,
+                                                   int maxOutputLines) {
     std::vector<TileSoH> heightSol;
 
     // This is very specific case for 3x3p1s1 convlution, followed by 2x2s2 pooling with even height
@@ -302,6 +303,147 @@ std::vector<TileSoH> heightSolutionWithPooling(int inputSize, int kernelSize, in
     return heightSol;
 }
 
+using HeightSolutionKey = std::tuple<int, int, int, int, int, int>;
+
+HwTilingCache<HeightSolutionKey, std::vector<TileSoH>> heightSolutionCache;
+HwTilingCache<HeightSolutionKey, std::vector<TileSoH>> heightSolutionWithPoolingCache;
+
+}  // namespace
+
+std::vector<TileSoH> heightSolution(int inputSize, int kernelSize, int stride,
+                                    const std::tuple<int, int>& pad,
+                                    int maxOutputLines) {
+    auto key = std::make_tuple(inputSize, kernelSize, stride, std::get<0>(pad), std::get<1>(pad), maxOutputLines);
+
+    std::vector<TileSoH> heightSol;
+    if (!heightSolutionCache.find(key, heightSol)) {
+        heightSol = calcHeightSolution(inputSize, kernelSize, stride, pad, maxOutputLines);
+        heightSolutionCache.insert(key, heightSol);
+    }
+
+    return heightSol;
+}
+
+std::vector<TileSoH> heightSolutionWithPooling(int inputSize, int kernelSize, int stride,
+                                               int pad,
+                                               int maxOutputLines) {
+    auto key = std::make_tuple(inputSize, kernelSize, stride, pad, pad, maxOutputLines);
+
+    std::vector<TileSoH> heightSol;
+    if (!heightSolutionWithPoolingCache.find(key, heightSol)) {
+        heightSol = calcHeightSolutionWithPooling(inputSize, kernelSize, stride, pad, maxOutputLines);
+        heightSolutionWithPoolingCache.insert(key, heightSol);
+    }
+
+    return heightSol;
+}
+
+double DefaultHwConvCostModel::cost(uint32_t numDescriptors, uint32_t computeCost, uint32_t) const {
+    // Exact in double, so the descriptor count always dominates. The output
+    // size is the same for all the tilings of a convolution.
+    return static_cast<double>(numDescriptors) * 4294967296.0 + computeCost;
+}
+
+std::string DefaultHwConvCostModel::name() const {
+    return "default";
+}
+
+LinearHwConvCostModel LinearHwConvCostModel::fit(const std::vector<HwConvTimingSample>& samples) {
+    if (samples.empty()) {
+        THROW_IE_EXCEPTION << "[VPU] No samples to fit HW convolution cost model";
+    }
+
+    // Normal equations of time = a * numDescriptors + b * computeCost * outputPixels
+    double sdd = 0, sdc = 0, scc = 0, sdt = 0, sct = 0;
+    for (const auto& sample : samples) {
+        double d = sample.numDescriptors;
+        double c = static_cast<double>(sample.computeCost) * sample.outputPixels;
+        sdd += d * d;
+        sdc += d * c;
+        scc += c * c;
+        sdt += d * sample.time_uSec;
+        sct += c * sample.time_uSec;
+    }
+
+    double det = sdd * scc - sdc * sdc;
+    if (std::fabs(det) > 1e-9 * sdd * scc) {
+        double a = (sdt * scc - sct * sdc) / det;
+        double b = (sct * sdd - sdt * sdc) / det;
+        if (a >= 0 && b >= 0) {
+            return LinearHwConvCostModel(a, b);
+        }
+    }
+
+    // Samples do not separate the two terms, keep the one that explains them better
+    double a = sdd > 0 ? std::max(sdt / sdd, 0.0) : 0.0;
+    double b = scc > 0 ? std::max(sct / scc, 0.0) : 0.0;
+
+    double errA = 0, errB = 0;
+    for (const auto& sample : samples) {
+        double ea = sample.time_uSec - a * sample.numDescriptors;
+        double eb = sample.time_uSec - b * sample.computeCost * static_cast<double>(sample.outputPixels);
+        errA += ea * ea;
+        errB += eb * eb;
+    }
+
+    return errA <= errB ? LinearHwConvCostModel(a, 0.0) : LinearHwConvCostModel(0.0, b);
+}
+
+double LinearHwConvCostModel::cost(uint32_t numDescriptors, uint32_t computeCost, uint32_t outputPixels) const {
+    return _descriptor_uSec * numDescriptors + _compute_uSec * computeCost * static_cast<double>(outputPixels);
+}
+
+std::string LinearHwConvCostModel::name() const {
+    std::ostringstream name;
+    name.precision(17);
+    name << "linear:" << _descriptor_uSec << "," << _compute_uSec;
+    return name.str();
+}
+
+std::shared_ptr<const HwConvCostModel> createHwConvCostModel(const std::string& config) {
+    if (config.empty()) {
+        return std::make_shared<DefaultHwConvCostModel>();
+    }
+
+    auto comma = config.find(',');
+    if (comma != std::string::npos) {
+        try {
+            size_t pos1 = 0, pos2 = 0;
+            auto descriptor_uSec = std::stod(config.substr(0, comma), &pos1);
+            auto compute_uSec = std::stod(config.substr(comma + 1), &pos2);
+            if (pos1 == comma && pos2 == config.size() - comma - 1 &&
+                descriptor_uSec >= 0 && compute_uSec >= 0) {
+                return std::make_shared<LinearHwConvCostModel>(descriptor_uSec, compute_uSec);
+            }
+        } catch (const std::exception&) {
+        }
+    }
+
+    THROW_IE_EXCEPTION << "[VPU] Invalid HW convolution cost model: " << config;
+}
+
+std::string VPU::calibrateHwConvCostModel(
+        const std::vector<BlobMetaData>& metadata,
+        const std::map<std::string, InferenceEngineProfileInfo>& perfCounts) {
+    std::vector<HwConvTimingSample> samples;
+    for (const auto& meta : metadata) {
+        if (meta.hwDescriptors == 0 || meta.status != InferenceEngineProfileInfo::EXECUTED)
+            continue;
+
+        auto counter = perfCounts.find(meta.name);
+        if (counter == perfCounts.end() || counter->second.realTime_uSec <= 0)
+            continue;
+
+        samples.push_back({meta.hwDescriptors, meta.hwComputeCost, meta.hwOutputPixels,
+                           static_cast<double>(counter->second.realTime_uSec)});
+    }
+
+    auto model = LinearHwConvCostModel::fit(samples);
+    // the name is "linear:<descriptor_us>,<compute_us>"
+    auto name = model.name();
+    return name.substr(name.find(':') + 1);
+}
+
 bool isReluPostOp(const VpuStageHandle& postOp) {
     return (postOp != nullptr && (postOp->type == kRelu || postOp->type == kBiasRelu));
 }
@@ -382,6 +524,8 @@ bool isStageNameInList(const std::vector<std::string>& vec, const std::string& n
 }  // namespace
 
 void GraphTransformerImpl::addHWStages() {
+    _hwConvCostModel = createHwConvCostModel(_blobConfig.hwConvCostModel);
+
     auto cmxLimit =
             _blobConfig.useCmxBuffers ?
                 std::min(_blobConfig.cmxBufferSize, CMX_BUFFER_SIZE_LIMIT) :
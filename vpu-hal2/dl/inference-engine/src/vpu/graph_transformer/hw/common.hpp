@@ -34,6 +34,10 @@
 
 #include <tuple>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include "graph_transformer_impl.hpp"
 
 HwPaddingInfo getPadding(const VpuDims& inDims, const VpuDims& outDims,
@@ -102,3 +106,85 @@ private:
 };
 
 uint32_t estimateHwBufferSize(const VpuDims& dims);
+
+// Tiling solutions depend only on the layer geometry, so they are shared
+// by all layers and networks compiled in the process.
+template <class Key, class Value>
+class HwTilingCache {
+public:
+    bool find(const Key& key, Value& value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _cache.find(key);
+        if (it == _cache.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    void insert(const Key& key, const Value& value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_cache.size() >= MAX_SIZE)
+            _cache.clear();
+        _cache.insert({key, value});
+    }
+
+private:
+    static const size_t MAX_SIZE = 4096;
+
+    std::mutex _mutex;
+    std::map<Key, Value> _cache;
+};
+
+// Ranks the ways to split a HW convolution over output channels. A tiling
+// is described by the number of descriptors and their total compute cost
+// per output pixel: input channels per RAM block times kernel size plus the
+// mode overhead. The output X * Y pixels scale the compute cost, so stages
+// of different spatial size share one model.
+class HwConvCostModel {
+public:
+    virtual ~HwConvCostModel() = default;
+
+    virtual double cost(uint32_t numDescriptors, uint32_t computeCost, uint32_t outputPixels) const = 0;
+
+    // Identifies the model in the tiling cache
+    virtual std::string name() const = 0;
+};
+
+// Fewest descriptors first, then the lowest compute cost
+class DefaultHwConvCostModel : public HwConvCostModel {
+public:
+    double cost(uint32_t numDescriptors, uint32_t computeCost, uint32_t outputPixels) const override;
+
+    std::string name() const override;
+};
+
+// Measured time of a HW convolution stage, e.g. taken from the perf counters
+struct HwConvTimingSample {
+    uint32_t numDescriptors;
+    uint32_t computeCost;
+    uint32_t outputPixels;
+    double time_uSec;
+};
+
+// Estimated time in microseconds: a fixed time per descriptor plus a time
+// per unit of compute cost and output pixel
+class LinearHwConvCostModel : public HwConvCostModel {
+public:
+    LinearHwConvCostModel(double descriptor_uSec, double compute_uSec)
+        : _descriptor_uSec(descriptor_uSec), _compute_uSec(compute_uSec) {
+    }
+
+    // Least squares fit of the coefficients to the measured times
+    static LinearHwConvCostModel fit(const std::vector<HwConvTimingSample>& samples);
+
+    double cost(uint32_t numDescriptors, uint32_t computeCost, uint32_t outputPixels) const override;
+
+    std::string name() const override;
+
+private:
+    double _descriptor_uSec;
+    double _compute_uSec;
+};
+
+// Empty config selects the default model, "<descriptor_us>,<compute_us>" the linear one
+std::shared_ptr<const HwConvCostModel> createHwConvCostModel(const std::string& config);
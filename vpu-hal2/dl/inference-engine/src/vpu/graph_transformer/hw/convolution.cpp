@@ -55,6 +55,8 @@ void VpuMyriadXHwConvolutionStage::dumpToDot(std::ostream& os) {
        << "poolRadX=" << poolRadX << "\\n"
        << "poolRadY=" << poolRadY << "\\n"
        << "hasParallelCopy=" << hasParallelCopy << "\\n"
+       << "tilingCost=" << tilingCost << "\\n"
+       << "tilingOutputPixels=" << tilingOutputPixels << "\\n"
        << "descriptors.size=" << descriptors.size();
 }
 
@@ -139,13 +141,16 @@ std::tuple<bool, uint32_t> checkModeForValidity(uint32_t iX, uint32_t iY, uint32
     return std::make_tuple(true, (iZ / noOfBlocks) * kX * kY + MODES_COST[mode]);
 }
 
+using ConvTiling = std::tuple<uint32_t, uint32_t, VpuMyriadXHwConvolutionStage::Tiles, uint32_t>;
+
 // This function splits the convolution operation into uniform pieces
-std::tuple<uint32_t, uint32_t, VpuMyriadXHwConvolutionStage::Tiles> splitConvolution(
+ConvTiling calcConvTiling(
         uint32_t iX, uint32_t iY, uint32_t iZ,
         uint32_t oX, uint32_t oY, uint32_t oZ,
         uint32_t kX, uint32_t kY, uint32_t kS,
         cnnDataMode dataType, cnnCoefficientMode coeffType,
-        const std::vector<cnnOperationMode>& modes = {MODE_1_256, MODE_2_128, MODE_4_64, MODE_8_32, MODE_16_16}) {
+        const std::vector<cnnOperationMode>& modes,
+        const HwConvCostModel& costModel) {
     using ConvSolution = std::tuple<cnnOperationMode, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>;
     using ConvSolutions = std::vector<ConvSolution>;
 
@@ -180,40 +185,22 @@ std::tuple<uint32_t, uint32_t, VpuMyriadXHwConvolutionStage::Tiles> splitConvolu
     }
 
     if (!solutions.empty()) {
-        auto minNumDesc = std::numeric_limits<uint32_t>::max();
-        for (const auto& s : solutions) {
-            minNumDesc = std::min(minNumDesc, std::get<3>(s));
-        }
-
-        // filter out solutions != minNumDesc
-        {
-            ConvSolutions tmpSolutions;
-            for (const auto& s : solutions) {
-                if (std::get<3>(s) == minNumDesc)
-                    tmpSolutions.push_back(s);
-            }
-            solutions.swap(tmpSolutions);
-        }
-
-        auto minCost = std::numeric_limits<uint32_t>::max();
-        for (const auto& s : solutions) {
-            minCost = std::min(minCost, std::get<6>(s));
-        }
-
-        // filter out solutions != minCost
-        {
-            ConvSolutions tmpSolutions;
-            for (const auto& s : solutions) {
-                if (std::get<6>(s) == minCost)
-                    tmpSolutions.push_back(s);
+        // Pick the cheapest solution, the first one on ties
+        size_t bestInd = 0;
+        auto bestCost = costModel.cost(std::get<3>(solutions[0]), std::get<6>(solutions[0]), oX * oY);
+        for (size_t i = 1; i < solutions.size(); ++i) {
+            auto curCost = costModel.cost(std::get<3>(solutions[i]), std::get<6>(solutions[i]), oX * oY);
+            if (curCost < bestCost) {
+                bestInd = i;
+                bestCost = curCost;
             }
-            solutions.swap(tmpSolutions);
         }
 
         cnnOperationMode mode;
         uint32_t newInZ, newOutZ, oChansPerDescr, remOChans;
+        uint32_t computeCost;
         uint32_t _;
-        std::tie(mode, newInZ, newOutZ, _, oChansPerDescr, remOChans, _) = solutions[0];
+        std::tie(mode, newInZ, newOutZ, _, oChansPerDescr, remOChans, computeCost) = solutions[bestInd];
 
         VpuMyriadXHwConvolutionStage::Tiles tiles(newOutZ / oChansPerDescr,
                                                   std::make_tuple(oChansPerDescr, mode));
@@ -243,10 +230,35 @@ std::tuple<uint32_t, uint32_t, VpuMyriadXHwConvolutionStage::Tiles> splitConvolu
             tiles = newTiles;
         }
 
-        return std::make_tuple(newInZ, newOutZ, std::move(tiles));
+        return std::make_tuple(newInZ, newOutZ, std::move(tiles), computeCost);
+    }
+
+    return std::make_tuple(0, 0, VpuMyriadXHwConvolutionStage::Tiles(), 0);
+}
+
+using ConvTilingKey = std::tuple<std::vector<uint32_t>, std::vector<cnnOperationMode>, std::string>;
+
+HwTilingCache<ConvTilingKey, ConvTiling> convTilingCache;
+
+// Returns (newInZ, newOutZ, tiles, computeCost), empty tiles if HW can't process the convolution
+ConvTiling splitConvolution(
+        uint32_t iX, uint32_t iY, uint32_t iZ,
+        uint32_t oX, uint32_t oY, uint32_t oZ,
+        uint32_t kX, uint32_t kY, uint32_t kS,
+        cnnDataMode dataType, cnnCoefficientMode coeffType,
+        const HwConvCostModel& costModel,
+        const std::vector<cnnOperationMode>& modes = {MODE_1_256, MODE_2_128, MODE_4_64, MODE_8_32, MODE_16_16}) {
+    ConvTilingKey key(std::vector<uint32_t>{iX, iY, iZ, oX, oY, oZ, kX, kY, kS,
+                                            static_cast<uint32_t>(dataType), static_cast<uint32_t>(coeffType)},
+                      modes, costModel.name());
+
+    ConvTiling tiling;
+    if (!convTilingCache.find(key, tiling)) {
+        tiling = calcConvTiling(iX, iY, iZ, oX, oY, oZ, kX, kY, kS, dataType, coeffType, modes, costModel);
+        convTilingCache.insert(key, tiling);
     }
 
-    return std::make_tuple(0, 0, VpuMyriadXHwConvolutionStage::Tiles());
+    return tiling;
 }
 
 }  // namespace
@@ -316,13 +328,13 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
                           swStage->radixX, swStage->radixY,
                           swStage->strideX, swStage->strideY);
 
-    uint32_t newInputDimZ = 0, newOutputDimZ = 0;
+    uint32_t newInputDimZ = 0, newOutputDimZ = 0, tilingCost = 0;
     VpuMyriadXHwConvolutionStage::Tiles tiles;
-    std::tie(newInputDimZ, newOutputDimZ, tiles)
+    std::tie(newInputDimZ, newOutputDimZ, tiles, tilingCost)
             = splitConvolution(input->dims[Dim::X], input->dims[Dim::Y], input->dims[Dim::Z],
                                output->dims[Dim::X], output->dims[Dim::Y], output->dims[Dim::Z],
                                swStage->radixX, swStage->radixY, swStage->strideX,
-                               MODE_FP16, FP16_COEFF);
+                               MODE_FP16, FP16_COEFF, *_hwConvCostModel);
 
     uint32_t inputTileDimZ = newInputDimZ;
     uint32_t numInputTiles = 1;
@@ -343,11 +355,11 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
                 inputTileDimZ = curTileSize;
                 numInputTiles = input->dims[Dim::Z] / inputTileDimZ;
 
-                std::tie(newInputDimZ, newOutputDimZ, tiles)
+                std::tie(newInputDimZ, newOutputDimZ, tiles, tilingCost)
                         = splitConvolution(input->dims[Dim::X], input->dims[Dim::Y], inputTileDimZ,
                                            output->dims[Dim::X], output->dims[Dim::Y], output->dims[Dim::Z],
                                            swStage->radixX, swStage->radixY, swStage->strideX,
-                                           MODE_FP16, FP16_COEFF);
+                                           MODE_FP16, FP16_COEFF, *_hwConvCostModel);
 
                 // TODO : support any number of output channels
                 if (newInputDimZ == inputTileDimZ && !tiles.empty()) {
@@ -379,6 +391,7 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
     weights->writer = nullptr;
 
     auto hasRelu = isReluPostOp(postOp);
+    uint32_t tilingOutputPixels = output->dims[Dim::X] * output->dims[Dim::Y];
 
     auto biasesHW = biases;
     if (scale != 1.0f && biases != nullptr && biases->index != IndexNone) {
@@ -429,7 +442,7 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
                 stage->name + "@HW" + hwStageNameSuffix + extraSuffix,
                 kMyriadXHwConvolution,
                 stage->layer,
-                [swStage, pad, newInputDimZ, newOutputDimZ, &tiles, hasRelu, postPoolStage](VpuMyriadXHwConvolutionStage* stage) {
+                [swStage, pad, newInputDimZ, newOutputDimZ, tilingCost, tilingOutputPixels, &tiles, hasRelu, postPoolStage](VpuMyriadXHwConvolutionStage* stage) {
                     stage->radixX = swStage->radixX;
                     stage->radixY = swStage->radixY;
                     stage->stride = swStage->strideX;
@@ -438,6 +451,8 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
 
                     stage->newInputDimZ = newInputDimZ;
                     stage->newOutputDimZ = newOutputDimZ;
+                    stage->tilingCost = tilingCost;
+                    stage->tilingOutputPixels = tilingOutputPixels;
                     stage->tiles = std::move(tiles);
 
                     stage->hasRelu = hasRelu;
@@ -465,7 +480,7 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
                 stage->name + "@HW" + hwStageNameSuffix + extraSuffix + "+Copy",
                 kMyriadXHwConvolution,
                 stage->layer,
-                [swStage, pad, newInputDimZ, newOutputDimZ, &tiles, hasRelu, postPoolStage](VpuMyriadXHwConvolutionStage* stage) {
+                [swStage, pad, newInputDimZ, newOutputDimZ, tilingCost, tilingOutputPixels, &tiles, hasRelu, postPoolStage](VpuMyriadXHwConvolutionStage* stage) {
                     stage->radixX = swStage->radixX;
                     stage->radixY = swStage->radixY;
                     stage->stride = swStage->strideX;
@@ -474,6 +489,8 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
 
                     stage->newInputDimZ = newInputDimZ;
                     stage->newOutputDimZ = newOutputDimZ;
+                    stage->tilingCost = tilingCost;
+                    stage->tilingOutputPixels = tilingOutputPixels;
                     stage->tiles = std::move(tiles);
 
                     stage->hasRelu = hasRelu;
@@ -563,7 +580,7 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
                     stage->name + "@HW@sod" + std::to_string(inputTileInd) + extraSuffix,
                     kMyriadXHwConvolution,
                     stage->layer,
-                    [swStage, pad, newInputDimZ, newOutputDimZ, &tiles](VpuMyriadXHwConvolutionStage* stage) {
+                    [swStage, pad, newInputDimZ, newOutputDimZ, tilingCost, tilingOutputPixels, &tiles](VpuMyriadXHwConvolutionStage* stage) {
                         stage->radixX = swStage->radixX;
                         stage->radixY = swStage->radixY;
                         stage->stride = swStage->strideX;
@@ -572,6 +589,8 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
 
                         stage->newInputDimZ = newInputDimZ;
                         stage->newOutputDimZ = newOutputDimZ;
+                        stage->tilingCost = tilingCost;
+                        stage->tilingOutputPixels = tilingOutputPixels;
                         stage->tiles = tiles;
 
                         stage->hasRelu = false;
@@ -593,7 +612,7 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
                     stage->name + "@HW@sod" + std::to_string(inputTileInd) + extraSuffix + "+Copy",
                     kMyriadXHwConvolution,
                     stage->layer,
-                    [swStage, pad, newInputDimZ, newOutputDimZ, &tiles](VpuMyriadXHwConvolutionStage* stage) {
+                    [swStage, pad, newInputDimZ, newOutputDimZ, tilingCost, tilingOutputPixels, &tiles](VpuMyriadXHwConvolutionStage* stage) {
                         stage->radixX = swStage->radixX;
                         stage->radixY = swStage->radixY;
                         stage->stride = swStage->strideX;
@@ -602,6 +621,8 @@ void GraphTransformerImpl::addHWConv(const std::list<VpuStagePtr>::iterator& sta
 
                         stage->newInputDimZ = newInputDimZ;
                         stage->newOutputDimZ = newOutputDimZ;
+                        stage->tilingCost = tilingCost;
+                        stage->tilingOutputPixels = tilingOutputPixels;
                         stage->tiles = tiles;
 
                         stage->hasRelu = false;
@@ -744,13 +765,13 @@ void GraphTransformerImpl::processHWConv(
         }
     }
 
-    uint32_t newInputDimZ = 0, newOutputDimZ = 0;
+    uint32_t newInputDimZ = 0, newOutputDimZ = 0, tilingCost = 0;
     VpuMyriadXHwConvolutionStage::Tiles tiles;
-    std::tie(newInputDimZ, newOutputDimZ, tiles)
+    std::tie(newInputDimZ, newOutputDimZ, tiles, tilingCost)
             = splitConvolution(input->dims[Dim::X], input->dims[Dim::Y], input->dims[Dim::Z],
                                actualOutput->dims[Dim::X], actualOutput->dims[Dim::Y], actualOutput->dims[Dim::Z],
                                swStage->radixX, swStage->radixY, swStage->strideX,
-                               MODE_FP16, FP16_COEFF);
+                               MODE_FP16, FP16_COEFF, *_hwConvCostModel);
 
     if (tiles.empty()) {
         postPoolStage = nullptr;
@@ -968,6 +989,7 @@ void GraphTransformerImpl::processHWConv(
 
     if (postOp != nullptr) {
         postOp->optimized = true;
+        _postOpStats.hwPostOps++;
     }
 
     if (postPoolStage != nullptr) {
@@ -329,5 +329,6 @@ void GraphTransformerImpl::processHWFC(
 
     if (postOp != nullptr) {
         postOp->optimized = true;
+        _postOpStats.hwPostOps++;
     }
 }
@@ -475,5 +475,6 @@ void GraphTransformerImpl::processHWPool(
 
     if (postOp != nullptr) {
         postOp->optimized = true;
+        _postOpStats.hwPostOps++;
     }
 }
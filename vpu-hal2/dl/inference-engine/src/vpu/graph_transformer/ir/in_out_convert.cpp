@@ -103,7 +103,8 @@ void GraphTransformerImpl::addInputConvertStages() {
                 },
                 {input},
                 {inputFP16});
-        } else if (_blobConfig.inputScale != 1.0f) {
+        } else if (_blobConfig.inputScale != 1.0f && iePrecisionToVpu(netInput->getInputPrecision()) == VpuDataType::FP16) {
+            // inputs converted by the host are already scaled there
             auto weights = addNewData(
                 newDataId(),
                 [input, this](VpuData* data) {
@@ -43,7 +43,7 @@ void GraphTransformerImpl::parseInputAndOutputData() {
             [netInput, inputOffset, this](VpuData* data) {
                 data->name = netInput->name();
                 data->index = IndexInput;
-                data->type = iePrecisionToVpu(netInput->getInputPrecision());
+                data->type = ioPrecisionToVpu(netInput->getInputPrecision(), _blobConfig);
                 data->dims = ieDimsToVpu(netInput->getTensorDesc().getDims());
                 data->offset = inputOffset;
                 if (_blobConfig.hwOptimization) {
@@ -71,7 +71,7 @@ void GraphTransformerImpl::parseInputAndOutputData() {
             [netOutput, outputOffset, this](VpuData* data) {
                 data->name = netOutput->getName();
                 data->index = IndexOutput;
-                data->type = iePrecisionToVpu(netOutput->getPrecision());
+                data->type = ioPrecisionToVpu(netOutput->getPrecision(), _blobConfig);
                 data->dims = ieDimsToVpu(netOutput->getDims());
                 if (_blobConfig.hwOptimization) {
                     data->order = orderZYX;
@@ -35,12 +35,170 @@
 #include <unordered_map>
 #include <list>
 #include <string>
+#include <algorithm>
+#include "vpu_logger.h"
+
+namespace {
+
+// Stages below adapt their order to the order of their input,
+// so they do not vote for the order of the data they access.
+bool isOrderFlexibleStage(const VpuStageHandle& stage) {
+    switch (stage->type) {
+    case kSoftMax: {
+        // only 1x1xC SoftMax is reshaped to follow a ZYX input
+        auto input = stage->inputs[0];
+        return input->dims[Dim::X] == 1 && input->dims[Dim::Y] == 1;
+    }
+    case kLRN:
+    case kNormalize:
+    case kSum:
+    case kProd:
+    case kMax:
+    case kRelu:
+    case kLeakyRelu:
+    case kBiasRelu:
+    case kBiasLeakyRelu:
+    case kBias:
+    case kScale:
+    case kScaleShift:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t calcDataByteSize(const VpuDataHandle& data) {
+    uint32_t size = getDataTypeSize(data->type);
+    for (size_t i = 0; i < data->dims.count(); ++i) {
+        size *= data->dims[i];
+    }
+    return size;
+}
+
+struct ConvertCost {
+    uint32_t stages = 0;
+    uint32_t bytes = 0;
+};
+
+// Convert stages needed around the sub-data of topParent if it is stored in the given order:
+// one after each producer which writes in another order, and one for each sub-data and
+// order which its consumers read in.
+ConvertCost calcConvertCost(const VpuDataHandle& topParent, t_MvTensorStorageOrder order) {
+    ConvertCost cost;
+
+    auto addDataCost = [order, &cost](const VpuDataHandle& data) {
+        auto producer = data->producer;
+        if (producer != nullptr && !producer->optimized && !isOrderFlexibleStage(producer) &&
+            producer->requiredOutputOrder[data->producerOutInd] != order) {
+            ++cost.stages;
+            cost.bytes += calcDataByteSize(data);
+        }
+
+        std::unordered_set<int> readOrders;
+        for (const auto& consumer : data->consumers) {
+            if (consumer->optimized || isOrderFlexibleStage(consumer))
+                continue;
+
+            for (size_t inputIdx = 0; inputIdx < consumer->inputs.size(); ++inputIdx) {
+                if (consumer->inputs[inputIdx] == data && consumer->requiredInputOrder[inputIdx] != order) {
+                    readOrders.insert(consumer->requiredInputOrder[inputIdx]);
+                }
+            }
+        }
+        cost.stages += readOrders.size();
+        cost.bytes += readOrders.size() * calcDataByteSize(data);
+    };
+
+    addDataCost(topParent);
+    loopOverSubData(topParent, addDataCost);
+
+    return cost;
+}
+
+}  // namespace
+
+// The order of data with several producers (e.g. Concat output) is chosen once for the whole
+// graph: the one which needs fewer bytes to be converted. Without that the first producer,
+// whose order differs from the current one, would impose its order on all the others.
+void GraphTransformerImpl::chooseTopParentOrders(
+        std::unordered_set<VpuDataHandle, VpuDataHandleHash>& topParentVisited) {
+    std::unordered_map<VpuStageHandle, size_t, VpuStageHandleHash> stagePos;
+    for (const auto& stage : _stages) {
+        stagePos.insert({stage, stagePos.size()});
+    }
+
+    ConvertCost greedyTotal, chosenTotal;
+
+    for (const auto& data : _datas) {
+        if (data->index != IndexBSS || data->parent != nullptr || data->subData.empty())
+            continue;
+
+        // The order that the first mismatching producer would set
+
+        auto greedyOrder = data->order;
+        size_t greedyPos = _stages.size();
+        auto findGreedyOrder = [&](const VpuDataHandle& subData) {
+            auto producer = subData->producer;
+            if (producer == nullptr || producer->optimized || isOrderFlexibleStage(producer))
+                return;
+
+            auto reqOrder = producer->requiredOutputOrder[subData->producerOutInd];
+            if (reqOrder != data->order && stagePos[producer] < greedyPos) {
+                greedyOrder = reqOrder;
+                greedyPos = stagePos[producer];
+            }
+        };
+        findGreedyOrder(data);
+        loopOverSubData(data, findGreedyOrder);
+
+        auto otherOrder = greedyOrder == orderZYX ? orderYXZ : orderZYX;
+
+        auto greedyCost = calcConvertCost(data, greedyOrder);
+        auto otherCost = calcConvertCost(data, otherOrder);
+
+        auto order = otherCost.bytes < greedyCost.bytes ? otherOrder : greedyOrder;
+        auto cost = otherCost.bytes < greedyCost.bytes ? otherCost : greedyCost;
+
+        if (order != data->order) {
+            uint32_t alignment = 1u;
+            auto findAlignment = [order, &alignment](const VpuDataHandle& subData) {
+                auto producer = subData->producer;
+                if (producer != nullptr && !producer->optimized &&
+                    producer->requiredOutputOrder[subData->producerOutInd] == order) {
+                    alignment = std::max<uint32_t>(alignment, producer->requiredOutputAlignment[subData->producerOutInd]);
+                }
+            };
+            findAlignment(data);
+            loopOverSubData(data, findAlignment);
+
+            data->order = order;
+            data->strides = calcStrides(data->dims, data->type, data->order, alignment);
+
+            loopOverSubData(data, [data](VpuDataHandle subData) {
+                subData->order = data->order;
+                subData->strides = data->strides;
+            });
+        }
+
+        topParentVisited.insert(data);
+
+        greedyTotal.stages += greedyCost.stages;
+        greedyTotal.bytes += greedyCost.bytes;
+        chosenTotal.stages += cost.stages;
+        chosenTotal.bytes += cost.bytes;
+    }
+
+    LOG_INFO("[VPU] GraphTransformer : concat orders need %u convert stages (%u bytes) instead of %u (%u bytes)",
+             chosenTotal.stages, chosenTotal.bytes, greedyTotal.stages, greedyTotal.bytes);
+}
 
 void GraphTransformerImpl::addConvertOrderStages() {
     std::unordered_map<VpuDataHandle, std::list<VpuDataHandle>, VpuDataHandleHash> convertedDataMap;
     std::unordered_map<VpuDataHandle, VpuDataHandle, VpuDataHandleHash> alignedDataMap;
     std::unordered_set<VpuDataHandle, VpuDataHandleHash> topParentVisited;
 
+    chooseTopParentOrders(topParentVisited);
+
     for (auto stageIt = _stages.begin(); stageIt != _stages.end(); ++stageIt) {
         auto stage = *stageIt;
         assert(stage != nullptr);
@@ -525,6 +683,16 @@ void GraphTransformerImpl::addConvertOrderStages() {
             }
         }
     }
+
+    uint32_t numConvertStages = 0, convertedBytes = 0;
+    for (const auto& stage : _stages) {
+        if (!stage->optimized && stage->type == kConvertOrder) {
+            ++numConvertStages;
+            convertedBytes += calcDataByteSize(stage->inputs[0]);
+        }
+    }
+    LOG_INFO("[VPU] GraphTransformer : %u convert order stages, %u bytes converted",
+             numConvertStages, convertedBytes);
 }
 
 VpuDataHandle GraphTransformerImpl::findOrCreateConvertedData(
@@ -35,6 +35,9 @@
 #include <list>
 #include <unordered_set>
 #include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
 #include "vpu_logger.h"
 
 
@@ -79,151 +82,198 @@ bool isStageCMXFree(const VpuStageHandle& stage) {
     return false;
 }
 
-class VpuAllocator {
+// Buffers are not placed while walking the stages. The walk only records
+// the stage range over which each buffer is live, and the offsets are
+// assigned once every live range is known. This lets the largest buffers
+// be placed first, so that small buffers fill the gaps between them
+// instead of fragmenting the memory.
+class VpuMemoryPlanner {
 public:
     struct Chunk {
+        VpuDataHandle data;
         IndexCodes index;
         uint32_t offset;
         uint32_t padding;
         uint32_t size;
         uint32_t inuse;
-        VpuAllocator* allocator;
+        bool canUseCMX;
+        // first and last stage which access the buffer
+        int begin;
+        int end;
+        VpuMemoryPlanner* planner;
     };
 
-    struct FreeMemory {
-        uint32_t offset;
-        uint32_t size;
-    };
-
-    VpuAllocator(bool memOptimization, IndexCodes index, uint32_t maxSize)
-        : _memOptimization(memOptimization), _index(index), _maxSize(maxSize) {
+    VpuMemoryPlanner(bool memOptimization, uint32_t cmxSize, uint32_t ddrSize)
+        : _memOptimization(memOptimization), _cmxSize(cmxSize), _ddrSize(ddrSize) {
     }
 
     Chunk* find(VpuDataHandle data) {
         auto memMapIt = _memMap.find(data);
 
         if (memMapIt != _memMap.end()) {
-            return &memMapIt->second;
+            return memMapIt->second;
         }
 
         return nullptr;
     }
 
-    Chunk* allocate(uint32_t size, uint32_t padding, uint32_t inuse,
-                    VpuDataHandle data) {
-        Chunk* chunk = nullptr;
-
+    Chunk* allocate(bool canUseCMX, uint32_t size, uint32_t padding, uint32_t inuse,
+                    int stagePos, VpuDataHandle data) {
 #ifdef NNLOG
     ALOGI("[VPU] GraphTransformer : _memOptimization = %d size = %u", _memOptimization,
                static_cast<uint32_t>(size));
 #endif
 
-        if (_memOptimization) {
+        if (size > _ddrSize)
+            return nullptr;
 
-            auto minMemIt = _memPool.end();
+        _chunks.push_back({data, IndexBSS, 0, padding, size, inuse, canUseCMX, stagePos, stagePos, this});
 
-            for (auto memPoolIt = _memPool.begin(); memPoolIt != _memPool.end(); ++memPoolIt) {
-                if (memPoolIt->size >= size) {
-                    minMemIt = memPoolIt;
-                    break;
-                }
+        auto chunk = &_chunks.back();
+
+        auto res = _memMap.insert({data, chunk});
+        assert(res.second);
+
+        return chunk;
+    }
+
+    void free(Chunk* chunk, int stagePos) {
+        if (chunk == nullptr)
+            return;
+
+        assert(chunk->planner == this);
+        assert(chunk->inuse > 0);
+
+        if (--chunk->inuse == 0) {
+            chunk->end = stagePos;
+        }
+    }
+
+    void check() {
+        for (const auto& chunk : _chunks) {
+            if (chunk.inuse > 0) {
+                THROW_IE_EXCEPTION << "[VPU] Blob memory packing failed";
             }
+        }
+    }
 
-            if (minMemIt != _memPool.end()) {
-                auto res = _memMap.insert({data, {_index, minMemIt->offset + minMemIt->size - size, padding, size, inuse, this}});
-                assert(res.second);
+    // Assigns the memory and the offset of every chunk. CMX is planned first,
+    // chunks which do not fit into it go to DDR.
+    void plan() {
+        std::vector<Chunk*> order;
+        for (auto& chunk : _chunks) {
+            order.push_back(&chunk);
+        }
 
-                chunk = &res.first->second;
+        std::stable_sort(order.begin(), order.end(), [](const Chunk* a, const Chunk* b) {
+            return a->size > b->size;
+        });
 
-                minMemIt->size -= size;
-                if (minMemIt->size == 0) {
-                    _memPool.erase(minMemIt);
+        std::vector<Chunk*> cmxChunks, ddrChunks;
+
+        for (auto chunk : order) {
+            if (chunk->canUseCMX) {
+                auto offset = findOffset(cmxChunks, chunk);
+                if (offset + chunk->size <= _cmxSize) {
+                    chunk->index = IndexCMX;
+                    chunk->offset = offset;
+                    cmxChunks.push_back(chunk);
+                    _cmxUsed = std::max(_cmxUsed, offset + chunk->size);
+                    continue;
                 }
             }
+
+            auto offset = findOffset(ddrChunks, chunk);
+            if (offset + chunk->size > _ddrSize) {
+                THROW_IE_EXCEPTION << "[VPU] Could not allocate memory buffer for " << chunk->data->name;
+            }
+
+            chunk->index = IndexBSS;
+            chunk->offset = offset;
+            ddrChunks.push_back(chunk);
+            _ddrUsed = std::max(_ddrUsed, offset + chunk->size);
         }
+    }
 
-        if (chunk == nullptr) {
-            if (_memOffset + size <= _maxSize) {
-                auto res = _memMap.insert({data, {_index, _memOffset, padding, size, inuse, this}});
-                assert(res.second);
+    const std::list<Chunk>& chunks() const {
+        return _chunks;
+    }
 
-                chunk = &res.first->second;
+    uint32_t memUsed(IndexCodes index) const {
+        return index == IndexCMX ? _cmxUsed : _ddrUsed;
+    }
 
-                _memOffset += size;
-            }
+    // Lower bound of memUsed: the largest total size of the chunks which
+    // are live at the same stage.
+    uint32_t peakLive(IndexCodes index) const {
+        std::map<int, int64_t> delta;
+        for (const auto& chunk : _chunks) {
+            if (chunk.index != index)
+                continue;
+
+            delta[chunk.begin] += chunk.size;
+            delta[chunk.end + 1] -= chunk.size;
         }
 
-        if (chunk) {
-            _memUsed = std::max(_memUsed, chunk->offset + chunk->size);
+        int64_t live = 0, peak = 0;
+        for (const auto& d : delta) {
+            live += d.second;
+            peak = std::max(peak, live);
         }
 
-        return chunk;
+        return static_cast<uint32_t>(peak);
     }
 
-    void free(Chunk* chunk) {
-        if (chunk == nullptr)
-            return;
+private:
+    bool overlaps(const Chunk* a, const Chunk* b) const {
+        if (!_memOptimization)
+            return true;
 
-        assert(chunk->allocator == this);
-        assert(chunk->inuse > 0);
+        return a->begin <= b->end && b->begin <= a->end;
+    }
 
-        if (--chunk->inuse == 0) {
-            FreeMemory newMem{chunk->offset, chunk->size};
-            while (true) {
-                bool found = false;
-
-                for (auto memPoolIt = _memPool.begin(); memPoolIt != _memPool.end(); ++memPoolIt) {
-                    if (newMem.offset + newMem.size == memPoolIt->offset) {
-                        // [newMem][*memPoolIt] case
-                        // extend newMem to and remove memPoolIt
-                        newMem.size += memPoolIt->size;
-                        _memPool.erase(memPoolIt);
-                        found = true;
-                        break;
-                    } else if (memPoolIt->offset + memPoolIt->size == newMem.offset) {
-                        // [*memPoolIt][newMem] case
-                        // extend newMem to and remove memPoolIt
-                        newMem.offset = memPoolIt->offset;
-                        newMem.size += memPoolIt->size;
-                        _memPool.erase(memPoolIt);
-                        found = true;
-                        break;
-                    }
-                }
+    // Returns the offset of the smallest gap between the placed chunks which
+    // are live together with the new one, or the end of the highest of them
+    // if no gap is large enough.
+    uint32_t findOffset(const std::vector<Chunk*>& placed, const Chunk* chunk) const {
+        std::vector<const Chunk*> live;
+        for (auto other : placed) {
+            if (overlaps(other, chunk))
+                live.push_back(other);
+        }
 
-                if (!found) {
-                    if (newMem.offset + newMem.size == _memOffset) {
-                        _memOffset = newMem.offset;
-                    } else {
-                        _memPool.push_back(newMem);
-                    }
+        std::sort(live.begin(), live.end(), [](const Chunk* a, const Chunk* b) {
+            return a->offset < b->offset;
+        });
+
+        uint32_t bestOffset = 0;
+        uint32_t bestGap = std::numeric_limits<uint32_t>::max();
+        uint32_t curOffset = 0;
 
-                    break;
+        for (auto other : live) {
+            if (other->offset > curOffset) {
+                auto gap = other->offset - curOffset;
+                if (gap >= chunk->size && gap < bestGap) {
+                    bestOffset = curOffset;
+                    bestGap = gap;
                 }
             }
-        }
-    }
 
-    void check() {
-        if (!_memPool.empty() || _memOffset > 0) {
-            THROW_IE_EXCEPTION << "[VPU] Blob memory packing failed";
+            curOffset = std::max(curOffset, other->offset + other->size);
         }
-    }
 
-    uint32_t memUsed() const {
-        return _memUsed;
+        return bestGap != std::numeric_limits<uint32_t>::max() ? bestOffset : curOffset;
     }
 
-private:
     bool _memOptimization;
-    IndexCodes _index;
-    uint32_t _maxSize;
+    uint32_t _cmxSize;
+    uint32_t _ddrSize;
 
-    uint32_t _memOffset = 0;
-    uint32_t _memUsed = 0;
+    uint32_t _cmxUsed = 0;
+    uint32_t _ddrUsed = 0;
 
-    std::unordered_map<VpuDataHandle, Chunk, VpuDataHandleHash> _memMap;
-    std::list<FreeMemory> _memPool;
+    std::unordered_map<VpuDataHandle, Chunk*, VpuDataHandleHash> _memMap;
+    std::list<Chunk> _chunks;
 };
 
 const uint32_t MIN_HW_PADDING = 0u;
@@ -379,37 +429,19 @@ uint32_t getStageRequiredInputPadding(VpuStageHandle stage, VpuDataHandle parent
 void GraphTransformerImpl::packMemory() {
     std::unordered_set<VpuDataHandle, VpuDataHandleHash> processedData;
 
-    VpuAllocator cmxAllocator(_blobConfig.memoryOptimization, IndexCMX, _blobConfig.cmxBufferSize);
-    VpuAllocator ddrAllocator(_blobConfig.memoryOptimization, IndexBSS, 512u * 1024u * 1024u);
+    VpuMemoryPlanner planner(_blobConfig.memoryOptimization, _blobConfig.cmxBufferSize, 512u * 1024u * 1024u);
 
 #ifdef NNLOG
     ALOGI("[VPU] GraphTransformer packMemory _blobConfig.memoryOptimization = %d",_blobConfig.memoryOptimization);
 #endif
     LOG_INFO("[VPU] GraphTransformer packMemory _blobConfig.memoryOptimization = %d",_blobConfig.memoryOptimization);
 
-    auto findChunk = [&cmxAllocator, &ddrAllocator](VpuDataHandle data) {
-        if (auto chunk = cmxAllocator.find(data))
-            return chunk;
-
-        return ddrAllocator.find(data);
-    };
-
-    auto allocateChunk = [&cmxAllocator, &ddrAllocator](
-            bool canUseCMX,
-            uint32_t size, uint32_t padding, uint32_t inuse,
-            VpuDataHandle data) {
-        if (canUseCMX) {
-            if (auto chunk = cmxAllocator.allocate(size, padding, inuse, data))
-                return chunk;
-        }
-
-        return ddrAllocator.allocate(size, padding, inuse, data);
-    };
-
-    // Allocate space for BSS/CMX data
+    // Collect live ranges of BSS/CMX data
 
+    int stagePos = -1;
     for (auto stageIt = _stages.begin(); stageIt != _stages.end(); ++stageIt) {
         auto stage = *stageIt;
+        ++stagePos;
         assert(stage != nullptr);
 
         #ifdef NNLOG
@@ -433,25 +465,18 @@ void GraphTransformerImpl::packMemory() {
 
             auto parent = getDataTopParent(output);
 
-            auto chunk = findChunk(parent);
+            auto chunk = planner.find(parent);
 
             if (chunk != nullptr) {
                 if (parent == output) {
                     THROW_IE_EXCEPTION << "[VPU] Trying to allocate the same data " << output->name << " twice";
                 }
 
-                loopOverSubData(parent, [parent, &processedData](VpuDataHandle subData) {
-                    if (processedData.find(subData) != processedData.end())
-                        return;
-
+                loopOverSubData(parent, [&processedData](VpuDataHandle subData) {
                     if (subData->parent == nullptr) {
                         THROW_IE_EXCEPTION << "[VPU] in function " << __PRETTY_FUNCTION__ << ": parent of VPU data handle not defined.";
                     }
 
-                    subData->index = parent->index;
-                    subData->offset =   subData->parent->offset
-                                      + calcAbsParentOffset(subData->offsetFromParent, subData->strides);
-
                     processedData.insert(subData);
                 });
             } else {
@@ -577,28 +602,15 @@ void GraphTransformerImpl::packMemory() {
 
                 // Allocate chunk
 
-                chunk = allocateChunk(canUseCMX, bufferSize, paddingSize, consumers.size(), parent);
+                chunk = planner.allocate(canUseCMX, bufferSize, paddingSize, consumers.size(), stagePos, parent);
                 if (chunk == nullptr) {
                     THROW_IE_EXCEPTION << "[VPU] Could not allocate memory buffer for " << parent->name;
                 }
-
-                parent->index = chunk->index;
-                parent->offset = chunk->offset + chunk->padding;
-                if (parent->index == IndexCMX) {
-                    parent->offset += _blobConfig.cmxBufferStart;
-                }
-                loopOverSubData(parent, [parent, &processedData](VpuDataHandle subData) {
-                    if (processedData.find(subData) != processedData.end())
-                        return;
-
+                loopOverSubData(parent, [&processedData](VpuDataHandle subData) {
                     if (subData->parent == nullptr) {
                         THROW_IE_EXCEPTION << "[VPU] in function " << __PRETTY_FUNCTION__ << ": parent of VPU data handle not defined.";
                     }
 
-                    subData->index = parent->index;
-                    subData->offset =   subData->parent->offset
-                                      + calcAbsParentOffset(subData->offsetFromParent, subData->strides);
-
                     processedData.insert(subData);
                 });
             }
@@ -617,7 +629,7 @@ void GraphTransformerImpl::packMemory() {
 
             auto parent = getDataTopParent(input);
 
-            auto chunk = findChunk(parent);
+            auto chunk = planner.find(parent);
 
             if (chunk == nullptr) {
                 auto producer = parent->producer;
@@ -632,15 +644,43 @@ void GraphTransformerImpl::packMemory() {
                 THROW_IE_EXCEPTION << "[VPU] Input " << input->name << " is not used";
             }
 
-            assert(chunk->allocator != nullptr);
-            chunk->allocator->free(chunk);
+            assert(chunk->planner != nullptr);
+            chunk->planner->free(chunk, stagePos);
         }
     }
 
     // Self-check
 
-    cmxAllocator.check();
-    ddrAllocator.check();
+    planner.check();
+
+    // Allocate space for BSS/CMX data
+
+    planner.plan();
+
+    for (const auto& chunk : planner.chunks()) {
+        auto parent = chunk.data;
+
+        parent->index = chunk.index;
+        parent->offset = chunk.offset + chunk.padding;
+        if (parent->index == IndexCMX) {
+            parent->offset += _blobConfig.cmxBufferStart;
+        }
+
+        loopOverSubData(parent, [parent](VpuDataHandle subData) {
+            subData->index = parent->index;
+            subData->offset =   subData->parent->offset
+                              + calcAbsParentOffset(subData->offsetFromParent, subData->strides);
+        });
+    }
+
+    LOG_INFO("[VPU] GraphTransformer : CMX peak live = %u allocated = %u, BSS peak live = %u allocated = %u",
+             planner.peakLive(IndexCMX), planner.memUsed(IndexCMX),
+             planner.peakLive(IndexBSS), planner.memUsed(IndexBSS));
+#ifdef NNLOG
+    ALOGI("[VPU] GraphTransformer : CMX peak live = %u allocated = %u, BSS peak live = %u allocated = %u",
+             planner.peakLive(IndexCMX), planner.memUsed(IndexCMX),
+             planner.peakLive(IndexBSS), planner.memUsed(IndexBSS));
+#endif
 
     // Pack Blob data
 
@@ -691,20 +731,21 @@ void GraphTransformerImpl::packMemory() {
             continue;
 
         if (stage->buffer != nullptr) {
-            stage->buffer->offset = ddrAllocator.memUsed();
+            stage->buffer->offset = planner.memUsed(IndexBSS);
 
             maxTempBufSize = std::max(maxTempBufSize, calcDataTotalSize(stage->buffer));
         }
     }
 
-    _bssMemSize = ddrAllocator.memUsed() + maxTempBufSize;
+    _bssMemSize = planner.memUsed(IndexBSS) + maxTempBufSize;
+    _cmxMemSize = planner.memUsed(IndexCMX);
 
     LOG_INFO("[VPU] GraphTransformer : DDR memory usage = %u CMX memory usage = %u",
              static_cast<uint32_t>(_bssMemSize),
-             static_cast<uint32_t>(cmxAllocator.memUsed()));
+             static_cast<uint32_t>(planner.memUsed(IndexCMX)));
 #ifdef NNLOG
     ALOGI("[VPU] GraphTransformer : DDR memory usage = %u CMX memory usage = %u",
              static_cast<uint32_t>(_bssMemSize),
-             static_cast<uint32_t>(cmxAllocator.memUsed()));
+             static_cast<uint32_t>(planner.memUsed(IndexCMX)));
 #endif
 }
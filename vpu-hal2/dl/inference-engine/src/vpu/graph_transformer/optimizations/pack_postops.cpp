@@ -32,6 +32,20 @@
 
 #include "graph_transformer_impl.hpp"
 
+namespace {
+
+bool isEltwiseStage(const VpuStageHandle& stage) {
+    return stage->type == kSum || stage->type == kProd || stage->type == kMax;
+}
+
+bool isHwCandidateStage(const VpuStageHandle& stage) {
+    return stage->type == kConv || stage->type == kIm2ColConvolution ||
+           stage->type == kMaxPool || stage->type == kAvgPool ||
+           stage->type == kFC;
+}
+
+}  // namespace
+
 void GraphTransformerImpl::packPostOps() {
     for (auto stagePos = _stages.begin(); stagePos != _stages.end(); stagePos++) {
         auto stage = *stagePos;
@@ -81,28 +95,30 @@ void GraphTransformerImpl::packPostOps() {
                     prevStage->parentOp->postOp = nullptr;
                     prevStage->parentOp = nullptr;
                     prevStage->optimized = true;
+
+                    _postOpStats.biasActivations++;
                 }
             }
         }
 
-        // Make the following operations in-place (since MvTensor works only in that mode)
+        // Make the following operations in-place (since MvTensor works only in that mode).
+        // This shares the buffer, the post-op still runs as its own stage: the firmware
+        // has no kernel that fuses an Eltwise with an activation.
         if (stage->type == kBias || stage->type == kElu || stage->type == kRelu || stage->type == kReluX ||
             stage->type == kLeakyRelu || stage->type == kBiasRelu || stage->type == kBiasLeakyRelu) {
             auto input = stage->inputs[0];
             auto output = stage->outputs[0];
             if (output != input) {
                 if (_blobConfig.hwOptimization) {
-                    // Only Bias and ReLU are supported in-place for HW graph
-                    if (stage->type != kBias && stage->type != kRelu && stage->type != kBiasRelu)
-                        continue;
-
-                    // In case of HW graph we make this operations in-place only for Convolution, Pooling and FC (HW operations)
-                    if (input->producer != nullptr &&
-                        !(input->producer->type == kConv || input->producer->type == kIm2ColConvolution ||
-                          input->producer->type == kMaxPool || input->producer->type == kAvgPool ||
-                          input->producer->type == kFC)) {
+                    // Only Bias and ReLU are supported in-place for HW graph, where HW stages
+                    // take them over. Activations of Eltwise stages run in-place too, so that
+                    // e.g. the Sum+ReLU of a residual block share one buffer.
+                    bool hwPostOp = (stage->type == kBias || stage->type == kRelu || stage->type == kBiasRelu) &&
+                                    (input->producer == nullptr || isHwCandidateStage(input->producer));
+                    bool eltwisePostOp = (stage->type == kRelu || stage->type == kLeakyRelu) &&
+                                         input->producer != nullptr && isEltwiseStage(input->producer);
+                    if (!hwPostOp && !eltwisePostOp)
                         continue;
-                    }
                 }
 
                 if (input->index == IndexOutput) {
@@ -133,6 +149,11 @@ void GraphTransformerImpl::packPostOps() {
 
                         input->producer->postOp = stage;
                         stage->parentOp = input->producer;
+
+                        _postOpStats.inPlacePostOps++;
+                        if (isEltwiseStage(input->producer)) {
+                            _postOpStats.eltwiseActivations++;
+                        }
                     } else {
                         for (auto& subData : input->subData) {
                             if (subData->producer == nullptr) {
@@ -54,6 +54,9 @@ public:
                                const std::map<std::string, std::string> &config,
                                HDDLAllocatorPtr &hddlAllocatorPtr) : _hddlAllocatorPtr(hddlAllocatorPtr) {
         _env = std::make_shared<Common::Environment>(MYRIAD_X, config);
+        // HDDLInferRequest has no host side I/O conversion, FP32 network I/O
+        // stays FP32 on the device whatever the config says
+        _env->parsedConfig.blobConfig.hostIoConversion = false;
 
         Common::LogLevel logLevel;
         try {
@@ -47,6 +47,7 @@
 
 #include "hddl_executor.h"
 #include "vpu_logger.h"
+#include "blob_compression.h"
 #include "hddl_api.h"
 #include "environment.h"
 
@@ -80,9 +81,16 @@ int Executor::openDevice() {
 
 void Executor::allocateGraph(const std::vector<char> &graphFileContent, size_t numStages,
                              const char* networkName) {
+    // the device takes plain blobs only
+    std::vector<char> decodedBlob;
+    const std::vector<char> *graphBlob = &graphFileContent;
+    if (isCompressedBlob(graphFileContent)) {
+        decompressBlob(graphFileContent, decodedBlob);
+        graphBlob = &decodedBlob;
+    }
     HDDLCALL(hddlCreateMvGraphFromMemory(_deviceHandle, networkName,
-                                         graphFileContent.data(),
-                                         graphFileContent.size(), &_graphHandle));
+                                         graphBlob->data(),
+                                         graphBlob->size(), &_graphHandle));
 
     // allocate aux data buffer
 #define DEBUG_BUFFER_SIZE 120
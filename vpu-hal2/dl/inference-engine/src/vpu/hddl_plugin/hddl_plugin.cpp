@@ -113,6 +113,8 @@ void Engine::SetConfig(const std::map<std::string, std::string> &config) {
 
 Engine::Engine() {
     _config = Common::ParsedConfig::getDefaultConfig(MYRIAD_X);
+    // HDDLInferRequest sends and receives the network precision as is
+    _config[VPU_CONFIG_KEY(HOST_IO_CONVERSION)] = CONFIG_VALUE(NO);
     _log = std::make_shared<Common::Logger>();
     _log->init(Common::ParsedConfig::parseLogLevel(_config.at(CONFIG_KEY(LOG_LEVEL))));
     _hddlAllocatorPtr = std::make_shared<HDDLAllocator>(_log);
@@ -0,0 +1,186 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+
+// Calibrates the HW convolution cost model on a device. The network is loaded
+// on MYRIAD with HW stages and performance counters on, and the measured time
+// of every HW convolution stage is paired with the tiling the stage was
+// compiled with. The times per descriptor and per unit of compute cost and
+// output pixel fitted to them are printed as a VPU_HW_CONV_COST_MODEL value,
+// which makes the graph transformer pick tilings by estimated time.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <inference_engine.hpp>
+#include <vpu/vpu_plugin_config.hpp>
+#include <vpu_plugin_config_private.hpp>
+#include <exported_network.h>
+#include <graph_transformer.hpp>
+
+using namespace InferenceEngine;
+using namespace VPU;
+using namespace VPU::Common;
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program << " -m <model.xml> [options]\n"
+              << "  -m <path>          IR network description, with HW convolutions\n"
+              << "  -w <path>          IR weights, <model>.bin by default\n"
+              << "  -d <path>          directory of the MYRIAD plugin library, the library path by default\n"
+              << "  -n <count>         timed inferences, 100 by default\n"
+              << "  -c <KEY>=<VALUE>   plugin config option, may be repeated\n";
+}
+
+std::string removeExtension(const std::string &path) {
+    auto dot = path.find_last_of('.');
+    auto slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path;
+    }
+    return path.substr(0, dot);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string modelPath, weightsPath, pluginDir;
+    int count = 100;
+    std::map<std::string, std::string> config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-m") {
+            modelPath = value;
+        } else if (arg == "-w") {
+            weightsPath = value;
+        } else if (arg == "-d") {
+            pluginDir = value;
+        } else if (arg == "-n") {
+            count = std::atoi(value.c_str());
+        } else if (arg == "-c") {
+            auto eq = value.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "Config option " << value << " is not in <KEY>=<VALUE> form\n";
+                return EXIT_FAILURE;
+            }
+            config[value.substr(0, eq)] = value.substr(eq + 1);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (modelPath.empty() || count < 1) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (weightsPath.empty()) {
+        weightsPath = removeExtension(modelPath) + ".bin";
+    }
+
+    try {
+        CNNNetReader reader;
+        reader.ReadNetwork(modelPath);
+        reader.ReadWeights(weightsPath);
+        CNNNetwork network = reader.getNetwork();
+
+        config[VPU_CONFIG_KEY(HW_STAGES_OPTIMIZATION)] = CONFIG_VALUE(YES);
+        config[CONFIG_KEY(PERF_COUNT)] = CONFIG_VALUE(YES);
+
+        InferencePlugin plugin(PluginDispatcher({pluginDir, ""}).getPluginByDevice("MYRIAD"));
+        auto executable = plugin.LoadNetwork(network, config);
+
+        // the tiling of every stage is in the metadata of the compiled graph,
+        // which the plugin only hands out in an export
+        std::string exportPath = removeExtension(modelPath) + ".calibrate.blob";
+        executable.Export(exportPath);
+        ExportedNetwork exported;
+        {
+            std::ifstream file(exportPath, std::ios_base::binary | std::ios_base::in);
+            exported = readExportedNetwork(file, exportPath);
+        }
+        std::remove(exportPath.c_str());
+
+        auto request = executable.CreateInferRequest();
+        for (int i = 0; i < 10; i++) {
+            request.Infer();
+        }
+
+        // stage times averaged over the timed inferences
+        std::map<std::string, InferenceEngineProfileInfo> perfCounts;
+        std::map<std::string, long long> totals_uSec;
+        for (int i = 0; i < count; i++) {
+            request.Infer();
+            perfCounts = request.GetPerformanceCounts();
+            for (const auto &counter : perfCounts) {
+                totals_uSec[counter.first] += counter.second.realTime_uSec;
+            }
+        }
+        for (auto &counter : perfCounts) {
+            counter.second.realTime_uSec = totals_uSec[counter.first] / count;
+        }
+
+        size_t hwStages = 0;
+        for (const auto &meta : exported.blobMetaData) {
+            hwStages += meta.hwDescriptors != 0 ? 1 : 0;
+        }
+
+        auto costModel = calibrateHwConvCostModel(exported.blobMetaData, perfCounts);
+        std::cout << "Calibrated on " << hwStages << " HW convolution stages of " << exported.name
+                  << " over " << count << " inferences\n"
+                  << VPU_CONFIG_KEY(HW_CONV_COST_MODEL) << "=" << costModel << "\n";
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+// Compiles an IR network into an exported MYRIAD network on the host, with no
+// device attached. The output is what ExecutableNetwork::Export() writes, so it
+// is loaded with ImportNetwork. The Android HAL dumps the IR of every Myriad
+// subgraph it compiles, and a network compiled from it with the HAL config can
+// be installed into the HAL blob cache under the key the HAL logs for it.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <inference_engine.hpp>
+#include <exported_network.h>
+#include <network_batch.h>
+#include <blob_compression.h>
+#include <parsed_config.h>
+#include <graph_transformer.hpp>
+
+using namespace InferenceEngine;
+using namespace VPU;
+using namespace VPU::Common;
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program << " -m <model.xml> [options]\n"
+              << "  -m <path>          IR network description\n"
+              << "  -w <path>          IR weights, <model>.bin by default\n"
+              << "  -o <path>          output file, <model>.blob by default\n"
+              << "  -g <path>          also write the bare graph blob, as ncGraphAllocate or\n"
+              << "                     graph_upload_bench take it\n"
+              << "  -p <2450|2480>     target platform, 2480 (MYRIAD_X) by default\n"
+              << "  -c <KEY>=<VALUE>   plugin config option, may be repeated\n"
+              << "                     e.g. -c VPU_HW_STAGES_OPTIMIZATION=YES\n";
+}
+
+std::string removeExtension(const std::string &path) {
+    auto dot = path.find_last_of('.');
+    auto slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path;
+    }
+    return path.substr(0, dot);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string modelPath, weightsPath, outputPath, graphPath;
+    int platform = MYRIAD_X;
+    std::map<std::string, std::string> config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-m") {
+            modelPath = value;
+        } else if (arg == "-w") {
+            weightsPath = value;
+        } else if (arg == "-o") {
+            outputPath = value;
+        } else if (arg == "-g") {
+            graphPath = value;
+        } else if (arg == "-p") {
+            platform = std::atoi(value.c_str());
+            if (platform != MYRIAD_X && platform != MYRIAD_2) {
+                std::cerr << "Unsupported platform " << value << ", expected 2450 or 2480\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "-c") {
+            auto eq = value.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "Config option " << value << " is not in <KEY>=<VALUE> form\n";
+                return EXIT_FAILURE;
+            }
+            config[value.substr(0, eq)] = value.substr(eq + 1);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (modelPath.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (weightsPath.empty()) {
+        weightsPath = removeExtension(modelPath) + ".bin";
+    }
+    if (outputPath.empty()) {
+        outputPath = removeExtension(modelPath) + ".blob";
+    }
+
+    try {
+        // the same steps ExecutableNetwork takes, with the platform given instead of
+        // read from a booted device
+        ParsedConfig parsedConfig(platform, config);
+        if (platform == MYRIAD_2) {
+            parsedConfig.blobConfig.hwOptimization = false;
+        }
+
+        auto allConfig = ParsedConfig::getDefaultConfig(platform);
+        for (const auto &option : config) {
+            allConfig[option.first] = option.second;
+        }
+        auto _log = std::make_shared<Logger>();
+        _log->init(ParsedConfig::parseLogLevel(allConfig[CONFIG_KEY(LOG_LEVEL)]));
+
+        CNNNetReader reader;
+        reader.ReadNetwork(modelPath);
+        reader.ReadWeights(weightsPath);
+        CNNNetwork network = reader.getNetwork();
+
+        if (network.getPrecision() != Precision::FP16) {
+            THROW_IE_EXCEPTION << "The plugin does not support networks with " << network.getPrecision() << " format.\n"
+                               << "Supported format: FP16.";
+        }
+
+        ExportedNetwork exported;
+        exported.platform = platform;
+        exported.hwOptimization = parsedConfig.blobConfig.hwOptimization;
+        exported.hostIoConversion = parsedConfig.blobConfig.hostIoConversion;
+        exported.inputScale = parsedConfig.blobConfig.inputScale;
+        exported.inputBias = parsedConfig.blobConfig.inputBias;
+
+        auto start = std::chrono::steady_clock::now();
+
+        // a batched network is compiled for one item of the batch, as
+        // ExecutableNetwork does, and the batch goes into the export
+        exported.batchSize = getNetworkBatch(network.getInputsInfo(), network.getOutputsInfo());
+        auto compiledNetwork = cloneNetwork(network);
+        if (exported.batchSize > 1) {
+            removeNetworkBatch(*compiledNetwork, exported.batchSize);
+        }
+
+        size_t numStages = 0;
+        auto graphTransformer = createGraphTransformer(parsedConfig.blobConfig, _log);
+        graphTransformer->generate(*compiledNetwork, exported.graphBlob, exported.blobMetaData, numStages);
+
+        auto compileTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        char networkName[1024] = {};
+        static_cast<ICNNNetwork &>(network).getName(networkName, sizeof(networkName));
+        exported.name = networkName;
+        exported.numStages = numStages;
+        for (const auto &input : network.getInputsInfo()) {
+            exported.inputs.emplace_back(input.first, input.second->getTensorDesc());
+        }
+        for (const auto &output : network.getOutputsInfo()) {
+            exported.outputs.emplace_back(output.first, output.second->getTensorDesc());
+        }
+
+        std::ofstream file(outputPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+        if (!file.is_open()) {
+            THROW_IE_EXCEPTION << "[VPU] Cannot open file " << outputPath << " for writing";
+        }
+        writeExportedNetwork(file, exported, outputPath);
+
+        if (!graphPath.empty()) {
+            std::ofstream graphFile(graphPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!graphFile.write(exported.graphBlob.data(), exported.graphBlob.size())) {
+                THROW_IE_EXCEPTION << "[VPU] Cannot write graph blob to " << graphPath;
+            }
+        }
+
+        std::cout << "Compiled " << exported.name << " for platform " << platform
+                  << " in " << compileTime << " ms: ";
+        if (exported.batchSize > 1) {
+            std::cout << "batch " << exported.batchSize << " split into single inferences, ";
+        }
+        std::cout << numStages << " stages, blob " << exported.graphBlob.size() << " bytes";
+        if (isCompressedBlob(exported.graphBlob)) {
+            std::cout << " (" << decompressedBlobSize(exported.graphBlob) << " decoded)";
+        }
+        std::cout << ", written to " << outputPath << "\n";
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
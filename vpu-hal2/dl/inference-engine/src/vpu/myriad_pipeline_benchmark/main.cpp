@@ -0,0 +1,225 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2018 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+//
+
+
+// Measures the throughput of pipelined asynchronous inference through the
+// MYRIAD plugin at several VPU_FIFO_DEPTH values. For every depth the network
+// is loaded again and as many infer requests as the fifo holds are kept
+// started, so the host, the link and the device overlap the way they do in
+// the HAL. The run goes against the simulated devices of the loopback XLink
+// backend (XLINK_LOOPBACK_*), which must be in the mvnc the plugin is built
+// with. The network is generated: a ReLU over an input of the given size.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <inference_engine.hpp>
+#include <vpu/vpu_plugin_config.hpp>
+
+using namespace InferenceEngine;
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  -d <path>          directory of the MYRIAD plugin library, the library path by default\n"
+              << "  -q <depths>        comma separated VPU_FIFO_DEPTH values, 1,2,4,8 by default\n"
+              << "  -n <count>         timed inferences per depth, 500 by default\n"
+              << "  -c <channels>      input channels, 3 by default\n"
+              << "  -s <size>          input height and width, 224 by default\n"
+              << "  -b <MB/s>          simulated link bandwidth, 300 by default, 0 unlimited\n"
+              << "  -l <us>            simulated latency of every transfer, 100 by default\n"
+              << "  -t <us>            simulated device time of one inference, 5000 by default\n";
+}
+
+std::string reluNetwork(int channels, int size) {
+    std::ostringstream port;
+    port << "<dim>1</dim><dim>" << channels << "</dim><dim>" << size << "</dim><dim>" << size << "</dim>";
+
+    std::ostringstream xml;
+    xml << "<net name=\"myriad_pipeline_benchmark\" version=\"2\" batch=\"1\">\n<layers>\n"
+        << "<layer id=\"0\" name=\"data\" type=\"Input\" precision=\"FP16\">"
+        << "<output><port id=\"0\">" << port.str() << "</port></output></layer>\n"
+        << "<layer id=\"1\" name=\"relu\" type=\"ReLU\" precision=\"FP16\"><data negative_slope=\"0\"/>"
+        << "<input><port id=\"0\">" << port.str() << "</port></input>"
+        << "<output><port id=\"1\">" << port.str() << "</port></output></layer>\n"
+        << "</layers>\n<edges>\n"
+        << "<edge from-layer=\"0\" from-port=\"0\" to-layer=\"1\" to-port=\"0\"/>\n"
+        << "</edges>\n</net>\n";
+    return xml.str();
+}
+
+std::vector<int> parseDepths(const std::string &value) {
+    std::vector<int> depths;
+    std::istringstream list(value);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        depths.push_back(std::atoi(item.c_str()));
+    }
+    return depths;
+}
+
+// the loopback backend reads its config when XLink is initialized, on the
+// first device search of the plugin; values set by the user are kept
+void setLoopbackDefault(const char *name, const std::string &value) {
+#ifdef _WIN32
+    if (std::getenv(name) == nullptr) {
+        _putenv_s(name, value.c_str());
+    }
+#else
+    setenv(name, value.c_str(), 0);
+#endif
+}
+
+void check(StatusCode status) {
+    if (status != OK) {
+        THROW_IE_EXCEPTION << "Inference failed with status " << status;
+    }
+}
+
+double measure(InferencePlugin &plugin, CNNNetwork &network, int depth, int count) {
+    std::map<std::string, std::string> config = {
+        {VPU_CONFIG_KEY(FIFO_DEPTH), std::to_string(depth)}
+    };
+    auto executable = plugin.LoadNetwork(network, config);
+
+    std::vector<InferRequest> requests;
+    for (int i = 0; i < depth; i++) {
+        requests.push_back(executable.CreateInferRequest());
+    }
+
+    auto run = [&](int inferences) {
+        for (int i = 0; i < inferences; i++) {
+            auto &request = requests[i % depth];
+            if (i >= depth) {
+                check(request.Wait(IInferRequest::WaitMode::RESULT_READY));
+            }
+            request.StartAsync();
+        }
+        for (int i = 0; i < depth && i < inferences; i++) {
+            check(requests[i].Wait(IInferRequest::WaitMode::RESULT_READY));
+        }
+    };
+
+    run(depth);
+
+    auto start = std::chrono::steady_clock::now();
+    run(count);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string pluginDir;
+    std::vector<int> depths = {1, 2, 4, 8};
+    int count = 500, channels = 3, size = 224;
+    std::string bandwidth = "300", latency = "100", inference = "5000";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-d") {
+            pluginDir = value;
+        } else if (arg == "-q") {
+            depths = parseDepths(value);
+        } else if (arg == "-n") {
+            count = std::atoi(value.c_str());
+        } else if (arg == "-c") {
+            channels = std::atoi(value.c_str());
+        } else if (arg == "-s") {
+            size = std::atoi(value.c_str());
+        } else if (arg == "-b") {
+            bandwidth = value;
+        } else if (arg == "-l") {
+            latency = value;
+        } else if (arg == "-t") {
+            inference = value;
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    bool validDepths = !depths.empty();
+    for (auto depth : depths) {
+        validDepths &= depth > 0;
+    }
+    if (!validDepths || count < 1 || channels < 1 || size < 1) {
+        std::cerr << "Expected positive values\n";
+        return EXIT_FAILURE;
+    }
+
+    setLoopbackDefault("XLINK_LOOPBACK_DEVICES", "1");
+    setLoopbackDefault("XLINK_LOOPBACK_BANDWIDTH", bandwidth);
+    setLoopbackDefault("XLINK_LOOPBACK_LATENCY_US", latency);
+    setLoopbackDefault("XLINK_LOOPBACK_INFER_US", inference);
+
+    try {
+        std::string xml = reluNetwork(channels, size);
+        CNNNetReader reader;
+        reader.ReadNetwork(xml.data(), xml.size());
+        CNNNetwork network = reader.getNetwork();
+
+        InferencePlugin plugin(PluginDispatcher({pluginDir, ""}).getPluginByDevice("MYRIAD"));
+
+        std::cout << channels << "x" << size << "x" << size << " FP16 input, "
+                  << std::getenv("XLINK_LOOPBACK_BANDWIDTH") << " MB/s, "
+                  << std::getenv("XLINK_LOOPBACK_LATENCY_US") << " us latency, "
+                  << std::getenv("XLINK_LOOPBACK_INFER_US") << " us inference\n";
+        for (auto depth : depths) {
+            double seconds = measure(plugin, network, depth, count);
+            std::cout << "VPU_FIFO_DEPTH=" << depth << ": " << count << " inferences in " << seconds << " s, "
+                      << count / seconds << " inferences/s, " << seconds * 1000.0 / count << " ms each\n";
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
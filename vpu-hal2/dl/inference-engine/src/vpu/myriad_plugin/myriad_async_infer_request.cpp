@@ -20,14 +20,13 @@ using namespace InferenceEngine;
 
 MyriadAsyncInferRequest::MyriadAsyncInferRequest(MyriadInferRequest::Ptr request,
                                                  const InferenceEngine::ITaskExecutor::Ptr &taskExecutorStart,
-                                                 const InferenceEngine::ITaskExecutor::Ptr &taskExecutorGetResult,
                                                  const InferenceEngine::TaskSynchronizer::Ptr &taskSynchronizer,
                                                  const InferenceEngine::ITaskExecutor::Ptr &callbackExecutor)
         : InferenceEngine::AsyncInferRequestThreadSafeDefault(request,
                                                               taskExecutorStart,
                                                               taskSynchronizer,
                                                               callbackExecutor),
-          _request(request), _taskExecutorGetResult(taskExecutorGetResult) {}
+          _request(request) {}
 
 
 InferenceEngine::StagedTask::Ptr MyriadAsyncInferRequest::createAsyncRequestTask() {
@@ -38,7 +37,7 @@ InferenceEngine::StagedTask::Ptr MyriadAsyncInferRequest::createAsyncRequestTask
                 case 3: {
                     _request->InferAsync();
                     asyncTaskCopy->stageDone();
-                    _taskExecutorGetResult->startTask(asyncTaskCopy);
+                    _request->getTaskExecutorGetResult()->startTask(asyncTaskCopy);
                 }
                     break;
                 case 2: {
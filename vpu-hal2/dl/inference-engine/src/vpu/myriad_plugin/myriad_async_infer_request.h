@@ -23,7 +23,6 @@ class MyriadAsyncInferRequest : virtual public InferenceEngine::AsyncInferReques
 public:
     MyriadAsyncInferRequest(MyriadInferRequest::Ptr request,
                                 const InferenceEngine::ITaskExecutor::Ptr &taskExecutorStart,
-                                const InferenceEngine::ITaskExecutor::Ptr &taskExecutorGetResult,
                                 const InferenceEngine::TaskSynchronizer::Ptr &taskSynchronizer,
                                 const InferenceEngine::ITaskExecutor::Ptr &callbackExecutor);
 
@@ -32,7 +31,6 @@ public:
     ~MyriadAsyncInferRequest();
 private:
     MyriadInferRequest::Ptr _request;
-    InferenceEngine::ITaskExecutor::Ptr _taskExecutorGetResult;
 };
 
 }  // namespace MyriadPlugin
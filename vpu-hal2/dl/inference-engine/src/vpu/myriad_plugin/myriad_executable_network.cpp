@@ -0,0 +1,120 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2017 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <ie_common.h>
+#include <exported_network.h>
+#include <network_batch.h>
+#include "myriad_executable_network.h"
+
+using namespace VPU::Common;
+using namespace VPU::MyriadPlugin;
+using namespace InferenceEngine;
+
+ExecutableNetwork::ExecutableNetwork(const std::string &blobFileName,
+                                     std::vector<DevicePtr> &devicePool,
+                                     const std::map<std::string, std::string> &config) {
+    std::ifstream file(blobFileName, std::ios_base::binary | std::ios_base::in);
+    if (!file.is_open()) {
+        THROW_IE_EXCEPTION << "[VPU] Cannot open file " << blobFileName << " for reading";
+    }
+
+    auto exported = readExportedNetwork(file, blobFileName);
+
+    _networkName = exported.name;
+    _numStages = exported.numStages;
+    _graphBlob = std::move(exported.graphBlob);
+
+    for (const auto &input : exported.inputs) {
+        auto data = std::make_shared<Data>(input.first, input.second);
+        auto info = std::make_shared<InputInfo>();
+        info->setInputData(data);
+        _networkInputs[input.first] = info;
+    }
+
+    for (const auto &output : exported.outputs) {
+        _networkOutputs[output.first] = std::make_shared<Data>(output.first, output.second);
+    }
+
+    // the file is fully parsed before a device is claimed for it
+    openDevice(devicePool, config);
+    // the graph was compiled for one item of this batch
+    _env->batchSize = exported.batchSize;
+
+    if (exported.platform != static_cast<uint32_t>(_device->_platform)) {
+        _device->_executors -= 1;
+        THROW_IE_EXCEPTION << "[VPU] Exported network was generated for platform " << exported.platform
+                           << ", device platform is " << _device->_platform;
+    }
+    // the blob decides the device layout and I/O format, not the config it is loaded with
+    _env->parsedConfig.blobConfig.hwOptimization = exported.hwOptimization;
+    _env->parsedConfig.blobConfig.hostIoConversion = exported.hostIoConversion;
+    _env->parsedConfig.blobConfig.inputScale = exported.inputScale;
+    _env->parsedConfig.blobConfig.inputBias = exported.inputBias;
+    _env->blobMetaData = std::move(exported.blobMetaData);
+
+    LOG_INFO("[VPU] imported network %s from %s", _networkName.c_str(), blobFileName.c_str());
+
+    allocateGraph(devicePool);
+}
+
+void ExecutableNetwork::Export(const std::string &modelFileName) {
+    std::ofstream file(modelFileName, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!file.is_open()) {
+        THROW_IE_EXCEPTION << "[VPU] Cannot open file " << modelFileName << " for writing";
+    }
+
+    ExportedNetwork exported;
+    exported.platform = _device->_platform;
+    exported.hwOptimization = _env->parsedConfig.blobConfig.hwOptimization;
+    exported.hostIoConversion = _env->parsedConfig.blobConfig.hostIoConversion;
+    exported.inputScale = _env->parsedConfig.blobConfig.inputScale;
+    exported.inputBias = _env->parsedConfig.blobConfig.inputBias;
+    exported.name = _networkName;
+    exported.numStages = _numStages;
+    exported.batchSize = _env->batchSize;
+    exported.graphBlob = _graphBlob;
+    exported.blobMetaData = _env->blobMetaData;
+
+    for (const auto &input : _networkInputs) {
+        exported.inputs.emplace_back(input.first, input.second->getTensorDesc());
+    }
+    for (const auto &output : _networkOutputs) {
+        exported.outputs.emplace_back(output.first, output.second->getTensorDesc());
+    }
+
+    writeExportedNetwork(file, exported, modelFileName);
+}
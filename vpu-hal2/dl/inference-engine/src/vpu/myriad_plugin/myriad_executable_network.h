@@ -39,12 +39,15 @@
 #include <ie_common.h>
 #include <cpp_interfaces/impl/ie_executable_network_thread_safe_default.hpp>
 #include <cpp_interfaces/ie_executor_manager.hpp>
+#include <ie_util_internal.hpp>
 #include "myriad_executor.h"
+#include "myriad_scheduler.h"
 #include "myriad_executable_network.h"
 #include "graph_transformer.hpp"
 #include "myriad_infer_request.h"
 #include <environment.h>
 #include <parsed_config.h>
+#include <network_batch.h>
 #include "myriad_async_infer_request.h"
 
 namespace VPU {
@@ -57,83 +60,70 @@ public:
     explicit ExecutableNetwork(InferenceEngine::ICNNNetwork &network,
                                std::vector<DevicePtr> &devicePool,
                                const std::map<std::string, std::string> &config) {
-        Common::LogLevel logLevel;
-        Common::LogLevel vpuLogLevel;
-
-        try {
-            logLevel = Common::ParsedConfig::parseLogLevel(
-                    config.at(CONFIG_KEY(LOG_LEVEL)));
-            vpuLogLevel = Common::ParsedConfig::parseLogLevel(
-                    config.at(VPU_CONFIG_KEY(LOG_LEVEL)));
-        } catch (const std::out_of_range& error) {
-            auto default_config = Common::ParsedConfig::getDefaultConfig();
-            logLevel = Common::ParsedConfig::parseLogLevel(
-                    default_config.at(CONFIG_KEY(LOG_LEVEL)));
-            vpuLogLevel = Common::ParsedConfig::parseLogLevel(
-                    default_config.at(VPU_CONFIG_KEY(LOG_LEVEL)));
+        openDevice(devicePool, config);
+
+        InferenceEngine::InputsDataMap networkInputs;
+        InferenceEngine::OutputsDataMap networkOutputs;
+        network.getInputsInfo(networkInputs);
+        network.getOutputsInfo(networkOutputs);
+        _env->batchSize = Common::getNetworkBatch(networkInputs, networkOutputs);
+
+        // a batched network is compiled for one item of the batch, the
+        // network itself keeps its batch for the inputs and outputs
+        InferenceEngine::details::CNNNetworkImplPtr batchItemNetwork;
+        if (_env->batchSize > 1) {
+            batchItemNetwork = Common::cloneNetwork(network);
+            Common::removeNetworkBatch(*batchItemNetwork, _env->batchSize);
+            LOG_INFO("[VPU] ExecutableNetwork : batch %zu is split into single inferences", _env->batchSize);
         }
-        _log = std::make_shared<Common::Logger>();
-        _log->init(logLevel);
+        InferenceEngine::ICNNNetwork &compiledNetwork = batchItemNetwork != nullptr ? *batchItemNetwork : network;
 
-        _executor = std::make_shared<MyriadExecutor>(vpuLogLevel, _log);
-        _device = _executor->openDevice(devicePool);
-        _env = std::make_shared<Common::Environment>(_device->_platform, config);
-        // ignore hardware optimization config for MYRIAD2, it is always disabled
-        if (_device->_platform == MYRIAD_2) {
-            _env->parsedConfig.blobConfig.hwOptimization = false;
-            LOG_INFO("[VPU] hardware optimization config for MYRIAD2 always disabled");
+        // kept to recompile the graph for its share of a device shared with
+        // other graphs; the graph transformer only reads it, so a batched
+        // network keeps the copy made above
+        if (_env->parsedConfig.partitionDeviceResources) {
+            _network = batchItemNetwork != nullptr ? batchItemNetwork : Common::cloneNetwork(network);
         }
 
         auto graphTrasnformer = createGraphTransformer(_env->parsedConfig.blobConfig, _log);
 
-        size_t numStages = 0;
-        graphTrasnformer->generate(network, _graphBlob, _env->blobMetaData, numStages);
+        graphTrasnformer->generate(compiledNetwork, _graphBlob, _env->blobMetaData, _numStages);
 
         LOG_INFO("[VPU] ExecutableNetwork : graphTrasnformer->generate done");
 
         char networkName[1024] = {};
         network.getName(networkName, sizeof(networkName));
+        _networkName = networkName;
         LOG_INFO("[VPU] org network name %s", networkName);
-        _executor->allocateGraph(_device, _graphDesc, _graphBlob, numStages, networkName);
-        LOG_INFO("[VPU] _executor->allocateGraph");
-        if (_env->parsedConfig.exclusiveAsyncRequests) {
-            InferenceEngine::ExecutorManager *executorManager = InferenceEngine::ExecutorManager::getInstance();
-            _taskExecutor = executorManager->getExecutor(
-                    InferenceEngine::TargetDeviceInfo::name(InferenceEngine::TargetDevice::eMYRIAD));
-        }
 
-        for (size_t i = 0; i < _maxTaskExecutorGetResultCount; i++) {
-            std::stringstream idStream;
-            idStream << networkName << "_TaskExecutorGetResult" << i;
-            _taskExecutorGetResultIds.push(idStream.str());
-        }
+        allocateGraph(devicePool);
     }
 
-    ~ExecutableNetwork() {
-        _executor->deallocateGraph(_device, _graphDesc);
-    }
+    // Creates the network from a file written by Export(), skipping graph
+    // transformation. Throws if the file is not a valid export for this
+    // plugin version or was generated for another platform.
+    explicit ExecutableNetwork(const std::string &blobFileName,
+                               std::vector<DevicePtr> &devicePool,
+                               const std::map<std::string, std::string> &config);
 
     InferenceEngine::InferRequestInternal::Ptr CreateInferRequestImpl(InferenceEngine::InputsDataMap networkInputs,
                                                                       InferenceEngine::OutputsDataMap networkOutputs) override {
-        return std::make_shared<MyriadInferRequest>(_graphDesc, networkInputs, networkOutputs, _env, _log, _executor);
+        return std::make_shared<MyriadInferRequest>(_scheduler, networkInputs, networkOutputs, _env, _log, _executor);
     }
 
     void CreateInferRequest(InferenceEngine::IInferRequest::Ptr &asyncRequest) override {
-        auto syncRequestImpl = std::make_shared<MyriadInferRequest>(_graphDesc, _networkInputs, _networkOutputs, _env, _log,
+        auto syncRequestImpl = std::make_shared<MyriadInferRequest>(_scheduler, _networkInputs, _networkOutputs, _env, _log,
                                                                     _executor);
         syncRequestImpl->setPointerToExecutableNetworkInternal(shared_from_this());
-        auto taskExecutorGetResult = getNextTaskExecutotGetResult();
         auto asyncTreadSafeImpl = std::make_shared<MyriadAsyncInferRequest>(
-                syncRequestImpl, _taskExecutor, taskExecutorGetResult, _taskSynchronizer, _callbackExecutor);
+                syncRequestImpl, _taskExecutor, _taskSynchronizer, _callbackExecutor);
         asyncRequest.reset(new InferenceEngine::InferRequestBase<InferenceEngine::AsyncInferRequestThreadSafeDefault>(
                            asyncTreadSafeImpl),
                            [](InferenceEngine::IInferRequest *p) { p->Release(); });
         asyncTreadSafeImpl->SetPointerToPublicInterface(asyncRequest);
     }
 
-    void Export(const std::string &modelFileName) {
-        THROW_IE_EXCEPTION << "Export is not implemented\n";
-    }
+    void Export(const std::string &modelFileName) override;
 
     void GetMappedTopology(
             std::map<std::string, std::vector<InferenceEngine::PrimitiveInfo::Ptr>> &deployedTopology) override {
@@ -145,22 +135,70 @@ private:
     Common::LoggerPtr _log;
     MyriadExecutorPtr _executor;
     std::vector<char> _graphBlob;
-    GraphDesc _graphDesc;
+    size_t _numStages = 0;
+    std::string _networkName;
     DevicePtr _device;
+    InferenceEngine::details::CNNNetworkImplPtr _network;
+    MyriadScheduler::Ptr _scheduler;
+
+    void openDevice(std::vector<DevicePtr> &devicePool,
+                    const std::map<std::string, std::string> &config) {
+        Common::LogLevel logLevel;
+        Common::LogLevel vpuLogLevel;
+
+        try {
+            logLevel = Common::ParsedConfig::parseLogLevel(
+                    config.at(CONFIG_KEY(LOG_LEVEL)));
+            vpuLogLevel = Common::ParsedConfig::parseLogLevel(
+                    config.at(VPU_CONFIG_KEY(LOG_LEVEL)));
+        } catch (const std::out_of_range& error) {
+            auto default_config = Common::ParsedConfig::getDefaultConfig();
+            logLevel = Common::ParsedConfig::parseLogLevel(
+                    default_config.at(CONFIG_KEY(LOG_LEVEL)));
+            vpuLogLevel = Common::ParsedConfig::parseLogLevel(
+                    default_config.at(VPU_CONFIG_KEY(LOG_LEVEL)));
+        }
+        _log = std::make_shared<Common::Logger>();
+        _log->init(logLevel);
 
-    const size_t _maxTaskExecutorGetResultCount = 1;
-    std::queue<std::string> _taskExecutorGetResultIds;
+        _executor = std::make_shared<MyriadExecutor>(vpuLogLevel, _log);
+        _device = _executor->openDevice(devicePool);
+        _env = std::make_shared<Common::Environment>(_device->_platform, config);
+        // ignore hardware optimization config for MYRIAD2, it is always disabled
+        if (_device->_platform == MYRIAD_2) {
+            _env->parsedConfig.blobConfig.hwOptimization = false;
+            LOG_INFO("[VPU] hardware optimization config for MYRIAD2 always disabled");
+        }
+    }
 
-    InferenceEngine::ITaskExecutor::Ptr getNextTaskExecutotGetResult() {
-        std::string id = _taskExecutorGetResultIds.front();
+    void compileFor(const GraphResources &resources, std::vector<char> &blob,
+                    std::vector<BlobMetaData> &metaData, size_t &numStages) {
+        auto blobConfig = _env->parsedConfig.blobConfig;
+        resources.applyTo(blobConfig);
 
-        _taskExecutorGetResultIds.pop();
-        _taskExecutorGetResultIds.push(id);
+        createGraphTransformer(blobConfig, _log)->generate(*_network, blob, metaData, numStages);
+    }
 
-        InferenceEngine::ExecutorManager *executorManager = InferenceEngine::ExecutorManager::getInstance();
-        InferenceEngine::ITaskExecutor::Ptr taskExecutor = executorManager->getExecutor(id);
+    void allocateGraph(std::vector<DevicePtr> &devicePool) {
+        GraphCompiler compiler;
+        if (_network != nullptr) {
+            compiler = [this](const GraphResources &resources, std::vector<char> &blob,
+                              std::vector<BlobMetaData> &metaData, size_t &numStages) {
+                compileFor(resources, blob, metaData, numStages);
+            };
+        }
 
-        return taskExecutor;
+        _scheduler = std::make_shared<MyriadScheduler>(_executor, _log, devicePool, _device, _graphBlob, _numStages,
+                                                       _networkName, _env->parsedConfig.multiDevice,
+                                                       _env->parsedConfig.fifoDepth, compiler,
+                                                       GraphResources::fromBlobConfig(_env->parsedConfig.blobConfig),
+                                                       GraphProfile::fromMetaData(_env->blobMetaData));
+        LOG_INFO("[VPU] _executor->allocateGraph");
+        if (_env->parsedConfig.exclusiveAsyncRequests) {
+            InferenceEngine::ExecutorManager *executorManager = InferenceEngine::ExecutorManager::getInstance();
+            _taskExecutor = executorManager->getExecutor(
+                    InferenceEngine::TargetDeviceInfo::name(InferenceEngine::TargetDevice::eMYRIAD));
+        }
     }
 };
 
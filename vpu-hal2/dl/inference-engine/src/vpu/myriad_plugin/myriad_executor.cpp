@@ -34,6 +34,7 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <algorithm>
 #include <sys/stat.h>
 #include <dirent.h>
 
@@ -42,6 +43,7 @@
 #include <chrono>
 #include <thread>
 #include <vpu_logger.h>
+#include <blob_compression.h>
 
 #include "myriad_executor.h"
 #include <cpp_interfaces/exception2status.hpp>
@@ -81,6 +83,90 @@ MyriadExecutor::MyriadExecutor(const LogLevel& vpuLogLevel, const LoggerPtr& log
     }
 }
 
+// Name of a device as XLink enumerates it: its USB port and, before it is
+// booted, its chip, e.g. "1.2-ma2450" that comes back as "1.2-" once booted.
+static std::string deviceName(deviceHandle_t *deviceHandle) {
+    char *name = nullptr;
+    unsigned int dataLength = 0;
+    if (ncDeviceGetOption(deviceHandle, NC_OPTION_CLASS0, NC_RO_DEVICE_NAME, &name, &dataLength) != NC_OK ||
+        name == nullptr) {
+        return std::string();
+    }
+    return name;
+}
+
+static std::string devicePort(const std::string &name) {
+    return name.substr(0, name.find('-'));
+}
+
+// Boots the first enumerated device that is not booted yet and appends it
+// with no executors attached. Devices are matched to the pool by port, as
+// the enumeration order changes when a device boots or is unplugged; the
+// booted ones of other processes are skipped. Returns false if there is no
+// such device.
+static bool bootNextDevice(std::vector<DevicePtr> &devicePool, ncStatus_t &statusInit, ncStatus_t &statusOpen) {
+    static int nextDeviceIdx = 0;
+
+    for (int index = 0; ; ++index) {
+        deviceHandle_t *deviceHandle = nullptr;
+        statusInit = ncDeviceInit(index, &deviceHandle);
+        if (statusInit != NC_OK) {
+            return false;
+        }
+
+        auto name = deviceName(deviceHandle);
+        auto port = devicePort(name);
+        bool inPool = std::any_of(devicePool.begin(), devicePool.end(), [&](const DevicePtr &device) {
+            return devicePort(device->_name) == port;
+        });
+        if (inPool || name.empty() || name.back() == '-') {
+            ncDeviceClose(deviceHandle);
+            continue;
+        }
+
+        statusOpen = ncDeviceOpen(deviceHandle);
+        if (statusOpen != NC_OK) {
+            ncDeviceClose(deviceHandle);
+            return false;
+        }
+
+        DeviceDesc device;
+        device._deviceHandle = deviceHandle;
+        device._name = deviceName(deviceHandle);
+        unsigned int dataLength = 0;
+/*    if (NC_OK != ncDeviceGetOption(device._deviceHandle, NC_OPTION_CLASS0,
+            NC_RO_DEVICE_PLATFORM, reinterpret_cast<void*>(&device._platform), &dataLength)
+        || dataLength != sizeof(device._platform)) {
+        LOG_WARNING("WARNING: Failed to get device platform");
+    }
+*/
+#ifdef AKS
+        device._platform = 2450; //fixed for Myriad 2450
+#endif
+        device._deviceIdx = nextDeviceIdx++;
+        devicePool.push_back(std::make_shared<DeviceDesc>(device));
+        return true;
+    }
+}
+
+// Resets the lost devices no graph uses any more and drops them from the
+// pool. A reset device comes back unbooted, so the next scan boots it again
+// if it recovered. Returns the dropped devices.
+static std::vector<DevicePtr> dropLostDevices(std::vector<DevicePtr> &devicePool) {
+    auto last = std::stable_partition(devicePool.begin(), devicePool.end(), [](const DevicePtr &device) {
+        return !device->_lost || device->_executors != 0;
+    });
+    std::vector<DevicePtr> dropped(last, devicePool.end());
+    devicePool.erase(last, devicePool.end());
+    for (auto &device : dropped) {
+        if (device->_deviceHandle != nullptr) {
+            ncDeviceClose(device->_deviceHandle);
+            device->_deviceHandle = nullptr;
+        }
+    }
+    return dropped;
+}
+
 DevicePtr MyriadExecutor::openDevice(std::vector<DevicePtr> &devicePool) {
     std::lock_guard<std::mutex> lock(device_mutex);
     ncStatus_t statusInit = NC_ERROR;
@@ -89,42 +175,23 @@ DevicePtr MyriadExecutor::openDevice(std::vector<DevicePtr> &devicePool) {
     // check already booted but empty devices
     int deviceIdx = -1;
     while (++deviceIdx < devicePool.size()) {
-        if (devicePool[deviceIdx]->_executors == 0) {
+        if (devicePool[deviceIdx]->_executors == 0 && !devicePool[deviceIdx]->_lost) {
             devicePool[deviceIdx]->_executors = 1;
             return devicePool[deviceIdx];
         }
     }
 
     // try to boot next device if any
-    if (statusInit != NC_OK) {
-        deviceIdx = devicePool.size();
-        DeviceDesc device;
-        statusInit = ncDeviceInit(deviceIdx, &device._deviceHandle);
-        if (statusInit == NC_OK) {
-            statusOpen = ncDeviceOpen(device._deviceHandle);
-            if (statusOpen == NC_OK) {
-                unsigned int dataLength = 0;
-/*                if (NC_OK != ncDeviceGetOption(device._deviceHandle, NC_OPTION_CLASS0,
-                        NC_RO_DEVICE_PLATFORM, reinterpret_cast<void*>(&device._platform), &dataLength)
-                    || dataLength != sizeof(device._platform)) {
-                    LOG_WARNING("WARNING: Failed to get device platform");
-                }
-*/
-#ifdef AKS
-                device._platform = 2450; //fixed for Myriad 2450
-#endif
-                device._executors = 1;
-                device._deviceIdx = deviceIdx;
-                devicePool.push_back(std::make_shared<DeviceDesc>(device));
-            }
-        }
+    if (bootNextDevice(devicePool, statusInit, statusOpen)) {
+        deviceIdx = devicePool.size() - 1;
+        devicePool[deviceIdx]->_executors = 1;
     }
 
     // attach one more executor to already booted device
     if (statusInit != NC_OK) {
         deviceIdx = -1;
         while (++deviceIdx < devicePool.size()) {
-            if (devicePool[deviceIdx]->_executors < DEVICE_MAX_GRAPHS) {
+            if (devicePool[deviceIdx]->_executors < DEVICE_MAX_GRAPHS && !devicePool[deviceIdx]->_lost) {
                 devicePool[deviceIdx]->_executors += 1;
                 return devicePool[deviceIdx];
             }
@@ -144,6 +211,40 @@ DevicePtr MyriadExecutor::openDevice(std::vector<DevicePtr> &devicePool) {
     return devicePool[deviceIdx];
 }
 
+std::vector<DevicePtr> MyriadExecutor::openExtraDevices(std::vector<DevicePtr> &devicePool, int platform,
+                                                        const std::vector<DevicePtr> &exclude) {
+    std::lock_guard<std::mutex> lock(device_mutex);
+    ncStatus_t statusInit = NC_ERROR;
+    ncStatus_t statusOpen = NC_ERROR;
+
+    // every multi-device network rescans on its own timer, the bus is
+    // scanned for the first one due and the others take what it booted
+    static std::chrono::steady_clock::time_point lastScan;
+    auto now = std::chrono::steady_clock::now();
+    if (lastScan == std::chrono::steady_clock::time_point() ||
+        now - lastScan >= std::chrono::milliseconds(DEVICE_RESCAN_INTERVAL_MS)) {
+        lastScan = now;
+        for (auto &device : dropLostDevices(devicePool)) {
+            LOG_INFO("[VPU] reset lost device %d (%s)", device->_deviceIdx, device->_name.c_str());
+        }
+        while (bootNextDevice(devicePool, statusInit, statusOpen)) {
+            LOG_INFO("[VPU] booted device %d (%s)", devicePool.back()->_deviceIdx, devicePool.back()->_name.c_str());
+        }
+    }
+
+    std::vector<DevicePtr> devices;
+    for (auto &device : devicePool) {
+        if (device->_deviceHandle == nullptr || device->_lost || device->_platform != platform ||
+            device->_executors >= DEVICE_MAX_GRAPHS ||
+            std::find(exclude.begin(), exclude.end(), device) != exclude.end()) {
+            continue;
+        }
+        device->_executors += 1;
+        devices.push_back(device);
+    }
+    return devices;
+}
+
 void MyriadExecutor::closeDevices(std::vector<DevicePtr> &devicePool) {
     std::lock_guard<std::mutex> lock(device_mutex);
     for (auto &device : devicePool) {
@@ -165,8 +266,13 @@ void MyriadExecutor::closeDevices(std::vector<DevicePtr> &devicePool) {
     #endif
 }
 
+void MyriadExecutor::markDeviceLost(DevicePtr &device) {
+    std::lock_guard<std::mutex> lock(device_mutex);
+    device->_lost = true;
+}
+
 void MyriadExecutor::allocateGraph(DevicePtr &device, GraphDesc &graphDesc,
-        const std::vector<char> &graphFileContent, size_t numStages, const char* networkName) {
+        const std::vector<char> &graphFileContent, size_t numStages, const char* networkName, int fifoDepth) {
 
     LOG_INFO("MyriadExecutor::allocateGraph");
     if (device->_deviceHandle == nullptr) {
@@ -191,7 +297,20 @@ void MyriadExecutor::allocateGraph(DevicePtr &device, GraphDesc &graphDesc,
         THROW_IE_EXCEPTION << "Failed to set graph executors: " << ncStatusToStr(nullptr, status);
     }
 
-    status = ncGraphAllocate(device->_deviceHandle, graphDesc._graphHandle, graphFileContent.data(), graphFileContent.size());
+    // the firmware takes plain blobs only
+    std::vector<char> decodedBlob;
+    const std::vector<char> *graphBlob = &graphFileContent;
+    if (isCompressedBlob(graphFileContent)) {
+        auto start = std::chrono::steady_clock::now();
+        decompressBlob(graphFileContent, decodedBlob);
+        graphBlob = &decodedBlob;
+        auto decodeTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("MyriadExecutor::allocateGraph decoded blob %zu -> %zu bytes in %lld us",
+                 graphFileContent.size(), decodedBlob.size(), static_cast<long long>(decodeTime));
+    }
+
+    status = ncGraphAllocate(device->_deviceHandle, graphDesc._graphHandle, graphBlob->data(), graphBlob->size());
     if (status != NC_OK) {
         THROW_IE_EXCEPTION << "Failed to allocate graph: " << ncStatusToStr(nullptr, status);
     }
@@ -230,14 +349,12 @@ void MyriadExecutor::allocateGraph(DevicePtr &device, GraphDesc &graphDesc,
         THROW_IE_EXCEPTION << "Failed to get output description: " << ncStatusToStr(graphDesc._graphHandle, status);
     }
 
-    int fifo_elements = 4;
-
     status = ncFifoInit(NC_FIFO_HOST_WO, &graphDesc._inputFifoHandle);
     if (status != NC_OK) {
         THROW_IE_EXCEPTION << "Failed to init input FIFO: " << ncStatusToStr(graphDesc._graphHandle, status);
     }
 
-    status = ncFifoCreate(graphDesc._inputFifoHandle, device->_deviceHandle, graphDesc._inputDesc, fifo_elements);
+    status = ncFifoCreate(graphDesc._inputFifoHandle, device->_deviceHandle, graphDesc._inputDesc, fifoDepth);
     if (status != NC_OK) {
         THROW_IE_EXCEPTION << "Failed to create input FIFO: " << ncStatusToStr(graphDesc._graphHandle, status);
     }
@@ -247,7 +364,7 @@ void MyriadExecutor::allocateGraph(DevicePtr &device, GraphDesc &graphDesc,
         THROW_IE_EXCEPTION << "Failed to init output FIFO: " << ncStatusToStr(graphDesc._graphHandle, status);
     }
 
-    status = ncFifoCreate(graphDesc._outputFifoHandle, device->_deviceHandle, graphDesc._outputDesc, fifo_elements);
+    status = ncFifoCreate(graphDesc._outputFifoHandle, device->_deviceHandle, graphDesc._outputDesc, fifoDepth);
     if (status != NC_OK) {
         THROW_IE_EXCEPTION << "Failed to create output FIFO: " << ncStatusToStr(graphDesc._graphHandle, status);
     }
@@ -318,31 +435,47 @@ void MyriadExecutor::deallocateGraph(DevicePtr &device, GraphDesc &graphDesc) {
     #endif
       std::lock_guard<std::mutex> lock(device_mutex);
     if (device->_deviceHandle != nullptr) {
-        if (graphDesc._inputFifoHandle != nullptr) {
-            auto res = ncFifoDelete(graphDesc._inputFifoHandle);
-            if (res != NC_OK)
-                LOG_WARNING("ncFifoDelete result %s", ncStatusToStr(nullptr, res));
-            graphDesc._inputFifoHandle = nullptr;
-        }
-        if (graphDesc._outputFifoHandle != nullptr) {
-            auto res = ncFifoDelete(graphDesc._outputFifoHandle);
-            if (res != NC_OK)
-                LOG_WARNING("ncFifoDelete result %s", ncStatusToStr(nullptr, res));
-            graphDesc._outputFifoHandle = nullptr;
-        }
-        if (graphDesc._graphHandle != nullptr) {
-            auto res = ncGraphDeallocate(graphDesc._graphHandle);
-            if (res !=NC_OK) {
-                LOG_DEBUG("Deallocate Graph result %s.", ncStatusToStr(nullptr, res));
-
-                #ifdef NNLOG
-                ALOGI("Deallocate Graph result %s.", ncStatusToStr(nullptr, res));
-                #endif
-              }
-            graphDesc._graphHandle = nullptr;
+        releaseGraph(device, graphDesc);
+        device->_executors -= 1;
+    }
+}
+
+void MyriadExecutor::reallocateGraph(DevicePtr &device, GraphDesc &graphDesc, const std::vector<char> &graphFileContent,
+                                     size_t numStages, const char* networkName, int fifoDepth) {
+    LOG_INFO("MyriadExecutor::reallocateGraph");
+    {
+        std::lock_guard<std::mutex> lock(device_mutex);
+        if (device->_deviceHandle != nullptr) {
+            releaseGraph(device, graphDesc);
         }
+    }
+    allocateGraph(device, graphDesc, graphFileContent, numStages, networkName, fifoDepth);
+}
 
-        device->_executors -= 1;
+// Frees the fifos and the graph on the device, called with device_mutex held.
+void MyriadExecutor::releaseGraph(DevicePtr &device, GraphDesc &graphDesc) {
+    if (graphDesc._inputFifoHandle != nullptr) {
+        auto res = ncFifoDelete(graphDesc._inputFifoHandle);
+        if (res != NC_OK)
+            LOG_WARNING("ncFifoDelete result %s", ncStatusToStr(nullptr, res));
+        graphDesc._inputFifoHandle = nullptr;
+    }
+    if (graphDesc._outputFifoHandle != nullptr) {
+        auto res = ncFifoDelete(graphDesc._outputFifoHandle);
+        if (res != NC_OK)
+            LOG_WARNING("ncFifoDelete result %s", ncStatusToStr(nullptr, res));
+        graphDesc._outputFifoHandle = nullptr;
+    }
+    if (graphDesc._graphHandle != nullptr) {
+        auto res = ncGraphDeallocate(graphDesc._graphHandle);
+        if (res !=NC_OK) {
+            LOG_DEBUG("Deallocate Graph result %s.", ncStatusToStr(nullptr, res));
+
+            #ifdef NNLOG
+            ALOGI("Deallocate Graph result %s.", ncStatusToStr(nullptr, res));
+            #endif
+          }
+        graphDesc._graphHandle = nullptr;
     }
 }
 
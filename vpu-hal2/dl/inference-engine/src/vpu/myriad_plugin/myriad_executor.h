@@ -54,11 +54,23 @@ struct GraphDesc {
 
 #define DEVICE_MAX_GRAPHS 2
 
+// How often a multi-device network looks for newly plugged devices and
+// releases the graphs of failed ones. The USB bus is scanned at most this
+// often for all the networks together.
+#define DEVICE_RESCAN_INTERVAL_MS 2000
+
 struct DeviceDesc {
     int _executors = 0;
     int _platform = UNKNOWN_DEVICE;
     int _deviceIdx = -1;
+    // USB address of the booted device, e.g. "1.2-"; the port part is the
+    // same as before the boot
+    std::string _name;
     deviceHandle_t *_deviceHandle = nullptr;
+    // set once an inference failed on the device, which is then no longer
+    // handed out. The device is reset and dropped from the pool once no
+    // graph uses it, and booted again by a later rescan.
+    bool _lost = false;
 };
 
 typedef std::shared_ptr<DeviceDesc> DevicePtr;
@@ -73,12 +85,26 @@ public:
 
     DevicePtr openDevice(std::vector<DevicePtr> &devicePool);
 
+    // Boots every device that is not in the pool yet, at most once per
+    // DEVICE_RESCAN_INTERVAL_MS for all the callers, and attaches one more
+    // executor to each device of the given platform that can take another
+    // graph, skipping the devices in exclude.
+    std::vector<DevicePtr> openExtraDevices(std::vector<DevicePtr> &devicePool, int platform,
+                                            const std::vector<DevicePtr> &exclude);
+
     static void closeDevices(std::vector<DevicePtr> &devicePool);
 
-    void allocateGraph(DevicePtr &device, GraphDesc &graphDesc, const std::vector<char> &graphFileContent, size_t numStages, const char* networkName);
+    static void markDeviceLost(DevicePtr &device);
+
+    void allocateGraph(DevicePtr &device, GraphDesc &graphDesc, const std::vector<char> &graphFileContent, size_t numStages, const char* networkName,
+                       int fifoDepth);
 
     void deallocateGraph(DevicePtr &device, GraphDesc &graphDesc);
 
+    // Replaces the graph with another one, keeping the executor it takes on the device.
+    void reallocateGraph(DevicePtr &device, GraphDesc &graphDesc, const std::vector<char> &graphFileContent, size_t numStages,
+                         const char* networkName, int fifoDepth);
+
     void queueInference(GraphDesc &graphDesc, void *input_data, size_t input_bytes,
                         void **result_data, size_t *result_bytes);
 
@@ -90,6 +116,10 @@ public:
 
     void printThrottlingStatus();
 
+private:
+    void releaseGraph(DevicePtr &device, GraphDesc &graphDesc);
+
+public:
     template<typename T>
     std::shared_ptr<Common::GraphInfo<T>> getGraphInfo(graphHandle_t *graphHandle, ncOptionClass_t opClass, int graphOption) {
         T *graphInfo;
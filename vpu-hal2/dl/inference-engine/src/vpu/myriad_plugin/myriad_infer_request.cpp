@@ -29,6 +29,7 @@
 // this notice or any other notice embedded in Materials by Intel or Intel's
 // suppliers or licensors in any way.
 
+#include <algorithm>
 #include <ie_blob.h>
 #include <ie_plugin.hpp>
 #include <description_buffer.hpp>
@@ -39,6 +40,7 @@
 #include "myriad_executable_network.h"
 #include "myriad_infer_request.h"
 #include "common.h"
+#include "blob_convert.h"
 
 #ifdef NNLOG
 #include <android/log.h>
@@ -49,13 +51,13 @@ using namespace VPU::Common;
 using namespace VPU::MyriadPlugin;
 using namespace InferenceEngine;
 
-MyriadInferRequest::MyriadInferRequest(GraphDesc &graphDesc,
+MyriadInferRequest::MyriadInferRequest(const MyriadScheduler::Ptr &scheduler,
                                         InferenceEngine::InputsDataMap networkInputs,
                                         InferenceEngine::OutputsDataMap networkOutputs,
                                         const EnvironmentPtr &env, const LoggerPtr &log,
                                         const MyriadExecutorPtr &executor) :
-        InferRequestInternal(networkInputs, networkOutputs), _graphDesc(
-                graphDesc), _env(env), _log(log), _executor(executor) {
+        InferRequestInternal(networkInputs, networkOutputs), _executor(executor),
+        _env(env), _log(log), _scheduler(scheduler) {
 
 
           //LOG_DEBUG("myriad InferRequest allocate network input blob");
@@ -120,6 +122,22 @@ MyriadInferRequest::MyriadInferRequest(GraphDesc &graphDesc,
     if (_networkOutputs.empty() || _networkInputs.empty()) {
         THROW_IE_EXCEPTION << "Internal error: no information about network's output/input";
     }
+
+    size_t inputSize = 0;
+    for (auto input : _inputs) {
+        inputSize += input.second->size() * getDevicePrecision(input.second->precision()).size();
+    }
+    _inputBuffer.resize(inputSize / _env->batchSize);
+}
+
+Precision MyriadInferRequest::getDevicePrecision(const Precision& precision) const {
+    if (precision == Precision::FP32 && _env->parsedConfig.blobConfig.hostIoConversion)
+        return Precision::FP16;
+    return precision;
+}
+
+Layout MyriadInferRequest::getDeviceLayout(const Layout& layout) const {
+    return (layout == NCHW || layout == NHWC) ? _deviceLayout : layout;
 }
 
 void MyriadInferRequest::Infer() {
@@ -149,134 +167,206 @@ void MyriadInferRequest::InferAsync() {
             THROW_IE_EXCEPTION << PARAMETER_MISMATCH_str << "Unsupported output blob precision";
     }
 
-    std::vector<uint8_t> tmpMemory;
-    Blob::Ptr tmpBlob;
+    // inferences left by an InferAsync() without GetResult()
+    discardItems();
+    _itemsQueued = 0;
+    _itemsRead = 0;
+
+    // the items of a batch run side by side on the devices; no more are
+    // queued than their fifos have room for, the rest follow as results are read
+    try {
+        queueItems();
+    } catch (...) {
+        discardItems();
+        throw;
+    }
+}
+
+void MyriadInferRequest::queueItems() {
+    // only wait for room while no item of this request is unread, other
+    // requests may be waiting for those to be read before they free any
+    while (_itemsQueued < _env->batchSize && queueItem(_itemsQueued, _tickets.empty())) {
+        _itemsQueued++;
+    }
+}
 
+bool MyriadInferRequest::queueItem(size_t item, bool wait) {
+    InferenceTicket ticket;
+    if (!_scheduler->reserve(ticket, wait)) {
+        return false;
+    }
     void* inputPtr = nullptr;
     size_t inputSize = 0;
+    try {
+        prepareItem(item, inputPtr, inputSize);
+    } catch (...) {
+        _scheduler->cancel(ticket);
+        throw;
+    }
+    _scheduler->queueInference(ticket, inputPtr, inputSize);
+    _tickets.push_back(ticket);
+    return true;
+}
 
-    if (_inputs.size() > 1) {
-        inputSize = 0;
-        for (auto input : _inputs) {
-            auto const inputBlobPtr = input.second;
-            size_t byteSize = inputBlobPtr->size() * inputBlobPtr->element_size();
-            inputSize += byteSize;
-        }
+void MyriadInferRequest::prepareItem(size_t item, void *&inputPtr, size_t &inputSize) {
+    const auto& blobConfig = _env->parsedConfig.blobConfig;
+    size_t batch = _env->batchSize;
 
-        tmpMemory.resize(inputSize);
-        auto dst = tmpMemory.data();
+    if (_inputs.size() == 1) {
+        auto dataName = _networkInputs.begin()->first;
+        auto foundInputBlob = _inputs.find(dataName);
+        if (foundInputBlob == _inputs.end())
+            THROW_IE_EXCEPTION << "Error: input [" << dataName << "] is not provided.";
 
+        // a blob already in device layout and precision is sent as is
+        auto inputBlobPtr = foundInputBlob->second;
+        Layout layout = inputBlobPtr->getTensorDesc().getLayout();
+        if (getDeviceLayout(layout) == layout && getDevicePrecision(inputBlobPtr->precision()) == inputBlobPtr->precision()) {
+            inputSize = inputBlobPtr->byteSize() / batch;
+            inputPtr = inputBlobPtr->buffer().as<uint8_t *>() + item * inputSize;
+        }
+    }
+
+    if (inputPtr == nullptr) {
+        auto dst = _inputBuffer.data();
         for (auto input : _inputs) {
             auto inputBlobPtr = input.second;
-            size_t byteSize = inputBlobPtr->size() * inputBlobPtr->element_size();
+            Precision precision = inputBlobPtr->precision();
+            Precision devicePrecision = getDevicePrecision(precision);
             Layout layout = inputBlobPtr->getTensorDesc().getLayout();
-            if (layout != _deviceLayout && (layout == NCHW || layout == NHWC)) {
-                switch (inputBlobPtr->precision()) {
-                    case Precision::U8:
-                        ConvertBlobToLayout<uint8_t>(_deviceLayout, inputBlobPtr);
-                        break;
-                    case Precision::FP16:
-                        ConvertBlobToLayout<ie_fp16>(_deviceLayout, inputBlobPtr);
-                        break;
-                    case Precision::FP32:
-                        ConvertBlobToLayout<float>(_deviceLayout, inputBlobPtr);
-                        break;
-                    default:
-                        THROW_IE_EXCEPTION << "unsupported blob precision for converting layout";
-                        break;
-                }
-            }
-            memcpy(dst, inputBlobPtr->buffer(), byteSize);
-            dst += byteSize;
-        }
 
-        inputPtr = tmpMemory.data();
-    } else {
-        auto dataName = _networkInputs.begin()->first;
-        auto foundInputBlob = _inputs.find(dataName);
-        if (foundInputBlob == _inputs.end())
-            THROW_IE_EXCEPTION << "Error: input [" << dataName << "] is not provided.";
+            // the host applies the input normalization together with FP32 -> FP16
+            float scale = 1.f, bias = 0.f;
+            if (devicePrecision != precision) {
+                scale = blobConfig.inputScale;
+                bias = blobConfig.inputBias;
+            }
 
-        tmpBlob = foundInputBlob->second;
-        size_t byteSize = tmpBlob->size() * tmpBlob->element_size();
-        Layout layout = tmpBlob->getTensorDesc().getLayout();
-        if (layout != _deviceLayout && (layout == NCHW || layout == NHWC)) {
-            switch (tmpBlob->precision()) {
-                case Precision::U8:
-                    ConvertBlobToLayout<uint8_t>(_deviceLayout, tmpBlob);
-                    break;
-                case Precision::FP16:
-                    ConvertBlobToLayout<ie_fp16>(_deviceLayout, tmpBlob);
-                    break;
-                case Precision::FP32:
-                    ConvertBlobToLayout<float>(_deviceLayout, tmpBlob);
-                    break;
-                default:
-                    THROW_IE_EXCEPTION << "unsupported blob precision for converting layout";
-                    break;
+            SizeVector dims = inputBlobPtr->getTensorDesc().getDims();
+            if (batch > 1) {
+                dims[0] = 1;
             }
+            size_t itemSize = inputBlobPtr->size() / batch;
+
+            ConvertBlob(inputBlobPtr->cbuffer().as<const uint8_t *>() + item * itemSize * precision.size(),
+                        precision, layout,
+                        dst, devicePrecision, getDeviceLayout(layout),
+                        dims, scale, bias);
+            dst += itemSize * devicePrecision.size();
         }
 
-        inputPtr = tmpBlob->buffer();
-        inputSize = byteSize;
+        inputPtr = _inputBuffer.data();
+        inputSize = dst - _inputBuffer.data();
     }
 
-    _executor->queueInference(_graphDesc, inputPtr, inputSize, nullptr, nullptr);
 }
 
 void MyriadInferRequest::GetResult() {
-    void *resultPtr = NULL;
-    size_t resultSize = 0;
+    if (_tickets.empty()) {
+        THROW_IE_EXCEPTION << "No inference was started";
+    }
 
-    _executor->getResult(_graphDesc, &resultPtr, &resultSize);
+    try {
+        while (!_tickets.empty()) {
+            InferenceTicket ticket = _tickets.front();
+            _tickets.pop_front();
+            _lastSlot = ticket._slot;
+            readItem(ticket, _itemsRead++);
+            queueItems();
+        }
+    } catch (...) {
+        discardItems();
+        throw;
+    }
+
+#if 0
+    _executor->printThrottlingStatus();
+#endif
+}
+
+void MyriadInferRequest::readItem(const InferenceTicket &ticket, size_t item) {
+    size_t batch = _env->batchSize;
+
+    _scheduler->getResult(ticket, _resultBuffer);
+    void *resultPtr = _resultBuffer.data();
+    size_t resultSize = _resultBuffer.size();
 
     size_t resultOffset = 0;
     for (auto pp : _outputs) {
-        if (resultOffset > resultSize) {
-            THROW_IE_EXCEPTION << "unexpected result data size";
-        }
         auto const outputBlobPtr = pp.second;
+        Precision devicePrecision = getDevicePrecision(outputBlobPtr->precision());
         Layout layout = outputBlobPtr->getTensorDesc().getLayout();
         SizeVector dims = outputBlobPtr->getTensorDesc().getDims();
+        if (batch > 1) {
+            dims[0] = 1;
+        }
+        size_t itemSize = outputBlobPtr->size() / batch;
+        size_t byteSize = itemSize * devicePrecision.size();
+        if (resultOffset + byteSize > resultSize) {
+            THROW_IE_EXCEPTION << "unexpected result data size";
+        }
+
+        Layout deviceLayout = layout;
         if (layout != _deviceLayout && (layout == NCHW || layout == NHWC)
             && (dims[0] != 1 || dims[1] != 1) && (dims[2] != 1 || dims[3] != 1)) {
-            Blob::Ptr tmpBlob = nullptr;
-            switch (outputBlobPtr->precision()) {
-            case Precision::FP32:
-                tmpBlob = InferenceEngine::make_shared_blob<float>(Precision::FP32, _deviceLayout, outputBlobPtr->dims(),
-                                                                   reinterpret_cast<float *>(reinterpret_cast<uint8_t *>(resultPtr) + resultOffset));
-                ConvertBlobToLayout<float>(layout, tmpBlob);
-                break;
-            case Precision::FP16:
-                tmpBlob = InferenceEngine::make_shared_blob<ie_fp16>(Precision::FP16, _deviceLayout, outputBlobPtr->dims(),
-                                                                     reinterpret_cast<short *>(reinterpret_cast<uint8_t *>(resultPtr) + resultOffset));
-                ConvertBlobToLayout<ie_fp16>(layout, tmpBlob);
-                break;
-            default:
-                THROW_IE_EXCEPTION << PARAMETER_MISMATCH_str << "Unsupported output precision: "
-                                   << outputBlobPtr->precision() << "! Supported precisions: FP32, FP16";
-            }
-            memcpy(outputBlobPtr->buffer(), tmpBlob->cbuffer(), outputBlobPtr->byteSize());
-        } else {
-            memcpy(outputBlobPtr->buffer(), reinterpret_cast<uint8_t *>(resultPtr) + resultOffset, outputBlobPtr->byteSize());
+            deviceLayout = _deviceLayout;
         }
 
-        resultOffset += outputBlobPtr->byteSize();
+        // converted straight into the slice of the item
+        ConvertBlob(reinterpret_cast<uint8_t *>(resultPtr) + resultOffset, devicePrecision, deviceLayout,
+                    outputBlobPtr->buffer().as<uint8_t *>() + item * itemSize * outputBlobPtr->precision().size(),
+                    outputBlobPtr->precision(), layout, dims);
+
+        resultOffset += byteSize;
     }
+}
 
-#if 0
-    _executor->printThrottlingStatus();
-#endif
+void MyriadInferRequest::discardItems() {
+    // a slot returns results in order, so every queued one has to be read
+    while (!_tickets.empty()) {
+        try {
+            _scheduler->getResult(_tickets.front(), _resultBuffer);
+        } catch (...) {
+        }
+        _tickets.pop_front();
+    }
+}
+
+ITaskExecutor::Ptr MyriadInferRequest::getTaskExecutorGetResult() const {
+    return _tickets.front().taskExecutorGetResult();
 }
 
 void MyriadInferRequest::GetPerformanceCounts(std::map<std::string, InferenceEngineProfileInfo> &perfMap) const {
-    std::shared_ptr<GraphInfo<float>> graphInfo = _executor->getPerfTimeInfo(_graphDesc._graphHandle);
+    auto slot = _lastSlot != nullptr ? _lastSlot : _scheduler->primarySlot();
+    if (slot == nullptr) {
+        THROW_IE_EXCEPTION << "No MYRIAD device is available";
+    }
+    // the slot may be repacked for another share of the device in the meantime
+    std::shared_ptr<GraphInfo<float>> graphInfo;
+    std::shared_ptr<const std::vector<BlobMetaData>> blobMetaData;
+    {
+        std::lock_guard<std::mutex> lock(slot->_writeMutex);
+        graphInfo = _executor->getPerfTimeInfo(slot->_graphDesc._graphHandle);
+        blobMetaData = slot->_blobMetaData;
+    }
     if (_log->getLogLevel() >= LogLevel::eLOGINFO) {
         if (graphInfo != nullptr && graphInfo->numElements()) {
             LOG_INFO("** Device execution time %.3lf **"
                     , graphInfo->info()[graphInfo->numElements()- 1]);
         }
     }
-    Common::GetPerformanceCounts(_env->blobMetaData, graphInfo, perfMap,
+    Common::GetPerformanceCounts(blobMetaData != nullptr ? *blobMetaData : _env->blobMetaData, graphInfo, perfMap,
             _env->parsedConfig.printReceiveTensorTime);
+
+    // how DeviceResourcePlanner split the device between the graphs on it,
+    // exec_type is e.g. "net1: shaves 0-3, cmx 0+524288; net2: ..."
+    auto split = DeviceResourcePlanner::describe(slot->_device);
+    if (!split.empty()) {
+        InferenceEngineProfileInfo &pc = perfMap["Device-Resources"];
+        pc.cpu_uSec = pc.realTime_uSec = 0;
+        pc.status = InferenceEngineProfileInfo::NOT_RUN;
+        split.copy(pc.exec_type, sizeof(pc.exec_type) / sizeof(pc.exec_type[0]) - 1, 0);
+        std::string layerType = "Resource-Split";
+        layerType.copy(pc.layer_type, sizeof(pc.layer_type) / sizeof(pc.layer_type[0]) - 1, 0);
+    }
 }
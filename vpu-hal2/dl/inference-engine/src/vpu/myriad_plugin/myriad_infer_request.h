@@ -33,9 +33,11 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <deque>
 #include <memory>
 #include <ie_common.h>
 #include "myriad_executor.h"
+#include "myriad_scheduler.h"
 #include "cpp_interfaces/impl/ie_infer_request_internal.hpp"
 #include "cpp_interfaces/impl/ie_executable_network_internal.hpp"
 #include <environment.h>
@@ -49,13 +51,24 @@ class MyriadInferRequest : public InferenceEngine::InferRequestInternal {
     Common::EnvironmentPtr _env;
     InferenceEngine::Layout _deviceLayout;
     Common::LoggerPtr _log;
+    // inputs of one batch item as sent to the device, reused by every inference
+    std::vector<uint8_t> _inputBuffer;
+    // outputs of one batch item as read from the device
+    std::vector<uint8_t> _resultBuffer;
 
-    GraphDesc _graphDesc;
+    MyriadScheduler::Ptr _scheduler;
+    // the inferences of the batch items queued since the last InferAsync()
+    // and not read yet, in item order
+    std::deque<InferenceTicket> _tickets;
+    size_t _itemsQueued = 0;
+    size_t _itemsRead = 0;
+    // the slot that ran the last inference, for performance counters
+    GraphSlotPtr _lastSlot;
 
 public:
     typedef std::shared_ptr<MyriadInferRequest> Ptr;
 
-    explicit MyriadInferRequest(GraphDesc &_graphDesc, InferenceEngine::InputsDataMap networkInputs, InferenceEngine::OutputsDataMap networkOutputs,
+    explicit MyriadInferRequest(const MyriadScheduler::Ptr &scheduler, InferenceEngine::InputsDataMap networkInputs, InferenceEngine::OutputsDataMap networkOutputs,
                           const Common::EnvironmentPtr &env,
                           const Common::LoggerPtr &log,
                           const MyriadExecutorPtr &executor);
@@ -64,6 +77,26 @@ public:
     void InferAsync();
     void GetResult();
 
+    // executor reading the result of the last InferAsync()
+    InferenceEngine::ITaskExecutor::Ptr getTaskExecutorGetResult() const;
+
+private:
+    // Queues the next batch items as long as the devices have room.
+    void queueItems();
+    // Queues the inference of the batch item, false if no device has room and wait is false.
+    bool queueItem(size_t item, bool wait);
+    // Converts the inputs of the batch item to what is sent to the device.
+    void prepareItem(size_t item, void *&inputPtr, size_t &inputSize);
+    // Converts the result of the batch item into its slice of the outputs.
+    void readItem(const InferenceTicket &ticket, size_t item);
+    // Reads and drops the results of the items still queued.
+    void discardItems();
+
+    InferenceEngine::Precision getDevicePrecision(const InferenceEngine::Precision& precision) const;
+    InferenceEngine::Layout getDeviceLayout(const InferenceEngine::Layout& layout) const;
+
+public:
+
     void
     GetPerformanceCounts(std::map<std::string, InferenceEngine::InferenceEngineProfileInfo> &perfMap) const override;
 };
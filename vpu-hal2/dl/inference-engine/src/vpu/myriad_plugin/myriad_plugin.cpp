@@ -96,6 +96,15 @@ if (supportedDevice == InferenceEngine::TargetDevice::eMYRIAD)
     return std::make_shared<ExecutableNetwork>(network, _devicePool, configCopy);
 }
 
+void Engine::ImportNetwork(IExecutableNetwork::Ptr &executableNetwork, const std::string &modelFileName) {
+    auto impl = std::make_shared<ExecutableNetwork>(modelFileName, _devicePool, _config);
+    impl->SetPointerToPluginInternal(shared_from_this());
+
+    executableNetwork.reset(new ExecutableNetworkBase<ExecutableNetworkInternal>(impl), [](details::IRelease *p) {
+        p->Release();
+    });
+}
+
 void Engine::SetConfig(const std::map<std::string, std::string> &config) {
     // override default config
     for (auto i = config.begin(); i != config.end(); i++) {
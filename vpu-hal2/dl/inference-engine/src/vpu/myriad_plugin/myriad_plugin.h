@@ -53,6 +53,9 @@ public:
 
     void SetConfig(const std::map<std::string, std::string> &config) override;
 
+    void ImportNetwork(InferenceEngine::IExecutableNetwork::Ptr &executableNetwork,
+                       const std::string &modelFileName) override;
+
 
     ~Engine() {
         MyriadExecutor::closeDevices(_devicePool);
@@ -0,0 +1,358 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2017 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+
+
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <algorithm>
+
+#include <ie_common.h>
+
+#include "myriad_resource_planner.h"
+
+using namespace VPU;
+using namespace VPU::Common;
+using namespace VPU::MyriadPlugin;
+using namespace InferenceEngine;
+
+// CMX windows start and end at multiples of it
+#define CMX_WINDOW_ALIGNMENT 1024u
+
+GraphResources GraphResources::fromBlobConfig(const BlobConfig &blobConfig) {
+    GraphResources resources;
+    resources.firstShave = blobConfig.firstShave;
+    resources.lastShave = blobConfig.lastShave;
+    resources.cmxBufferStart = blobConfig.useCmxBuffers ? blobConfig.cmxBufferStart : 0;
+    resources.cmxBufferSize = blobConfig.useCmxBuffers ? blobConfig.cmxBufferSize : 0;
+    return resources;
+}
+
+void GraphResources::applyTo(BlobConfig &blobConfig) const {
+    blobConfig.firstShave = firstShave;
+    blobConfig.lastShave = lastShave;
+    blobConfig.useCmxBuffers = cmxBufferSize != 0;
+    blobConfig.cmxBufferStart = cmxBufferStart;
+    blobConfig.cmxBufferSize = cmxBufferSize;
+}
+
+bool GraphResources::operator==(const GraphResources &other) const {
+    return firstShave == other.firstShave && lastShave == other.lastShave &&
+           cmxBufferStart == other.cmxBufferStart && cmxBufferSize == other.cmxBufferSize;
+}
+
+std::string GraphResources::toString() const {
+    std::ostringstream str;
+    str << "shaves " << firstShave << "-" << lastShave
+        << ", cmx " << cmxBufferStart << "+" << cmxBufferSize;
+    return str.str();
+}
+
+GraphProfile GraphProfile::fromMetaData(const std::vector<BlobMetaData> &metaData) {
+    GraphProfile profile;
+    for (const auto &meta : metaData) {
+        // transfers and compile passes follow the stages
+        if (meta.exec_type == "Receive-Tensor")
+            break;
+        if (meta.status != InferenceEngineProfileInfo::EXECUTED)
+            continue;
+
+        if (meta.exec_type.compare(0, 9, "MyriadXHw") == 0) {
+            profile.hwStages++;
+        } else {
+            profile.shaveStages++;
+        }
+    }
+    return profile;
+}
+
+namespace {
+
+// Splits total units by weight, at least minimum units each, largest remainders
+// rounded up.
+std::vector<uint32_t> splitByWeight(uint32_t total, uint32_t minimum, const std::vector<size_t> &weights) {
+    std::vector<uint32_t> shares(weights.size(), 0);
+
+    size_t totalWeight = 0;
+    uint32_t count = 0;
+    for (auto weight : weights) {
+        totalWeight += weight;
+        count += weight != 0 ? 1 : 0;
+    }
+    if (totalWeight == 0 || total < minimum * count)
+        return shares;
+
+    uint32_t spare = total - minimum * count;
+    uint32_t given = 0;
+    std::vector<std::pair<double, size_t>> remainders;
+    for (size_t i = 0; i < weights.size(); i++) {
+        if (weights[i] == 0)
+            continue;
+        double exact = static_cast<double>(spare) * weights[i] / totalWeight;
+        shares[i] = minimum + static_cast<uint32_t>(exact);
+        given += shares[i];
+        remainders.push_back({exact - static_cast<uint32_t>(exact), i});
+    }
+
+    std::stable_sort(remainders.begin(), remainders.end(),
+                     [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) {
+        return a.first > b.first;
+    });
+    for (size_t i = 0; given < total; i++, given++) {
+        shares[remainders[i % remainders.size()].second]++;
+    }
+
+    return shares;
+}
+
+struct DeviceState {
+    GraphResources budget;
+    std::vector<DeviceGraphPtr> graphs;
+};
+
+// guards deviceStates, never held while a graph is compiled or reallocated
+std::mutex plannerMutex;
+std::map<const DeviceDesc *, DeviceState> deviceStates;
+// one per device, held while the graphs of the device are repacked
+std::map<const DeviceDesc *, std::shared_ptr<std::mutex>> repackMutexes;
+
+std::shared_ptr<std::mutex> repackMutexOf(const DevicePtr &device) {
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    auto &repackMutex = repackMutexes[device.get()];
+    if (repackMutex == nullptr) {
+        repackMutex = std::make_shared<std::mutex>();
+    }
+    return repackMutex;
+}
+
+// The largest contiguous SHAVE range and CMX window of the budget that no
+// pinned graph uses. Returns false if every SHAVE is taken.
+bool freeResources(const GraphResources &budget, const std::vector<GraphResources> &pinned, GraphResources &free) {
+    size_t bestShaves = 0;
+    for (uint32_t first = budget.firstShave; first <= budget.lastShave; first++) {
+        uint32_t last = first;
+        auto taken = [&](uint32_t shave) {
+            return std::any_of(pinned.begin(), pinned.end(), [&](const GraphResources &graph) {
+                return shave >= graph.firstShave && shave <= graph.lastShave;
+            });
+        };
+        if (taken(first))
+            continue;
+        while (last + 1 <= budget.lastShave && !taken(last + 1))
+            last++;
+        if (last - first + 1 > bestShaves) {
+            bestShaves = last - first + 1;
+            free.firstShave = static_cast<uint16_t>(first);
+            free.lastShave = static_cast<uint16_t>(last);
+        }
+        first = last;
+    }
+    if (bestShaves == 0)
+        return false;
+
+    std::vector<std::pair<uint32_t, uint32_t>> windows;
+    for (const auto &graph : pinned) {
+        if (graph.cmxBufferSize != 0)
+            windows.push_back({graph.cmxBufferStart, graph.cmxBufferStart + graph.cmxBufferSize});
+    }
+    std::sort(windows.begin(), windows.end());
+
+    free.cmxBufferStart = 0;
+    free.cmxBufferSize = 0;
+    uint32_t budgetEnd = budget.cmxBufferStart + budget.cmxBufferSize;
+    uint32_t gapStart = budget.cmxBufferStart;
+    windows.push_back({budgetEnd, budgetEnd});
+    for (const auto &window : windows) {
+        uint32_t gapEnd = std::min(std::max(window.first, gapStart), budgetEnd);
+        if (gapEnd - gapStart > free.cmxBufferSize) {
+            free.cmxBufferStart = gapStart;
+            free.cmxBufferSize = gapEnd - gapStart;
+        }
+        gapStart = std::min(std::max(gapStart, window.second), budgetEnd);
+    }
+    return true;
+}
+
+std::string describeState(const DeviceState &state) {
+    std::ostringstream str;
+    for (const auto &graph : state.graphs) {
+        if (graph != state.graphs.front())
+            str << "; ";
+        str << graph->name << ": " << graph->resources.toString();
+    }
+    return str.str();
+}
+
+}  // namespace
+
+std::vector<GraphResources> VPU::MyriadPlugin::partitionDeviceResources(const GraphResources &device,
+                                                                      const std::vector<GraphProfile> &graphs) {
+    std::vector<size_t> shaveWeights, cmxWeights;
+    for (const auto &graph : graphs) {
+        // every graph runs some stages on the SHAVEs, if only the transfers
+        shaveWeights.push_back(std::max<size_t>(graph.shaveStages, 1));
+        cmxWeights.push_back(graph.hwStages);
+    }
+
+    uint32_t numShaves = device.lastShave - device.firstShave + 1;
+    auto shaves = splitByWeight(numShaves, 1, shaveWeights);
+    if (shaves.empty() || shaves.front() == 0)
+        return {};
+
+    auto cmxUnits = splitByWeight(device.cmxBufferSize / CMX_WINDOW_ALIGNMENT, 1, cmxWeights);
+
+    std::vector<GraphResources> resources(graphs.size());
+    uint16_t nextShave = device.firstShave;
+    uint32_t nextCmx = device.cmxBufferStart;
+    for (size_t i = 0; i < graphs.size(); i++) {
+        resources[i].firstShave = nextShave;
+        resources[i].lastShave = nextShave + shaves[i] - 1;
+        nextShave += shaves[i];
+
+        resources[i].cmxBufferStart = cmxUnits[i] != 0 ? nextCmx : 0;
+        resources[i].cmxBufferSize = cmxUnits[i] * CMX_WINDOW_ALIGNMENT;
+        nextCmx += resources[i].cmxBufferSize;
+    }
+    return resources;
+}
+
+GraphResources DeviceResourcePlanner::join(const DevicePtr &device, const DeviceGraphPtr &graph,
+                                           const LoggerPtr &_log) {
+    // Joins of one device are serialized by its repack mutex, so the plan
+    // stays valid while the residents are repacked without plannerMutex.
+    auto repackMutex = repackMutexOf(device);
+    std::lock_guard<std::mutex> repackLock(*repackMutex);
+
+    std::vector<DeviceGraphPtr> residents;
+    std::vector<GraphResources> shares;
+    {
+        std::lock_guard<std::mutex> lock(plannerMutex);
+        auto &state = deviceStates[device.get()];
+
+        if (state.graphs.empty()) {
+            state.budget = graph->resources;
+            state.graphs.push_back(graph);
+            return graph->resources;
+        }
+
+        residents = state.graphs;
+        state.graphs.push_back(graph);
+
+        // Graphs that cannot be recompiled, e.g. imported ones, keep their
+        // resources, the others split what those leave free
+        std::vector<GraphResources> pinned;
+        std::vector<GraphProfile> profiles;
+        for (const auto &other : state.graphs) {
+            if (other->repack) {
+                profiles.push_back(other->profile);
+            } else {
+                pinned.push_back(other->resources);
+            }
+        }
+
+        GraphResources free;
+        if (!profiles.empty() && freeResources(state.budget, pinned, free)) {
+            auto flexibleShares = partitionDeviceResources(free, profiles);
+            for (size_t i = 0, next = 0; i < state.graphs.size() && !flexibleShares.empty(); i++) {
+                const auto &other = state.graphs[i];
+                shares.push_back(other->repack ? flexibleShares[next++] : other->resources);
+            }
+        }
+        if (shares.empty()) {
+            LOG_WARNING("[VPU] graphs on device %d share its resources without partitioning: %s",
+                        device->_deviceIdx, describeState(state).c_str());
+            return graph->resources;
+        }
+    }
+
+    std::vector<std::pair<DeviceGraphPtr, GraphResources>> repacked;
+    for (size_t i = 0; i < residents.size(); i++) {
+        auto &resident = residents[i];
+        if (resident->resources == shares[i])
+            continue;
+
+        try {
+            resident->repack(shares[i]);
+        } catch (const std::exception &ex) {
+            // The new graph cannot be given a disjoint share, so the residents
+            // already repacked go back to theirs and it keeps its configured one
+            LOG_WARNING("[VPU] failed to repack %s on device %d: %s",
+                        resident->name.c_str(), device->_deviceIdx, ex.what());
+            for (auto &done : repacked) {
+                try {
+                    done.first->repack(done.second);
+                    // the record follows what is loaded on the device
+                    std::lock_guard<std::mutex> lock(plannerMutex);
+                    done.first->resources = done.second;
+                } catch (const std::exception &rollbackEx) {
+                    LOG_WARNING("[VPU] failed to restore %s on device %d to %s: %s",
+                                done.first->name.c_str(), device->_deviceIdx,
+                                done.second.toString().c_str(), rollbackEx.what());
+                }
+            }
+            return graph->resources;
+        }
+        repacked.push_back({resident, resident->resources});
+
+        std::lock_guard<std::mutex> lock(plannerMutex);
+        resident->resources = shares[i];
+    }
+
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    graph->resources = shares.back();
+    LOG_INFO("[VPU] device %d resources split: %s", device->_deviceIdx,
+             describeState(deviceStates[device.get()]).c_str());
+
+    return graph->resources;
+}
+
+void DeviceResourcePlanner::leave(const DevicePtr &device, const DeviceGraphPtr &graph) {
+    // waits for a repack in progress, which may still be using the graph
+    auto repackMutex = repackMutexOf(device);
+    std::lock_guard<std::mutex> repackLock(*repackMutex);
+
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    auto it = deviceStates.find(device.get());
+    if (it == deviceStates.end())
+        return;
+
+    auto &graphs = it->second.graphs;
+    graphs.erase(std::remove(graphs.begin(), graphs.end(), graph), graphs.end());
+    if (graphs.empty()) {
+        deviceStates.erase(it);
+    }
+}
+
+std::string DeviceResourcePlanner::describe(const DevicePtr &device) {
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    auto it = deviceStates.find(device.get());
+    return it != deviceStates.end() ? describeState(it->second) : std::string();
+}
@@ -0,0 +1,120 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2017 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <graph_transformer.hpp>
+#include <vpu_logger.h>
+#include "myriad_executor.h"
+
+namespace VPU {
+namespace MyriadPlugin {
+
+// The SHAVEs and the CMX window a graph is compiled for.
+struct GraphResources {
+    uint16_t firstShave = 0;
+    uint16_t lastShave = 0;
+    uint32_t cmxBufferStart = 0;
+    uint32_t cmxBufferSize = 0;
+
+    static GraphResources fromBlobConfig(const BlobConfig &blobConfig);
+    void applyTo(BlobConfig &blobConfig) const;
+
+    bool operator==(const GraphResources &other) const;
+    bool operator!=(const GraphResources &other) const { return !(*this == other); }
+
+    std::string toString() const;
+};
+
+// How much work of a graph runs on the SHAVEs and how much on the HW
+// accelerators, which use the CMX window.
+struct GraphProfile {
+    size_t shaveStages = 0;
+    size_t hwStages = 0;
+
+    static GraphProfile fromMetaData(const std::vector<BlobMetaData> &metaData);
+};
+
+// Splits the resources of a device between graphs: each graph gets a
+// contiguous SHAVE range sized by its SHAVE stages, at least one SHAVE, and
+// graphs with HW stages get CMX windows sized by their HW stages. Returns an
+// empty vector if there are fewer SHAVEs than graphs.
+std::vector<GraphResources> partitionDeviceResources(const GraphResources &device,
+                                                     const std::vector<GraphProfile> &graphs);
+
+// Compiles the network for the given share of a device.
+typedef std::function<void(const GraphResources &resources, std::vector<char> &blob,
+                           std::vector<BlobMetaData> &metaData, size_t &numStages)> GraphCompiler;
+
+// A graph allocated on a device.
+struct DeviceGraph {
+    std::string name;
+    GraphProfile profile;
+    GraphResources resources;
+    // recompiles the graph for another share and reallocates it on the
+    // device, null for graphs that cannot be recompiled, e.g. imported ones
+    std::function<void(const GraphResources &resources)> repack;
+};
+
+typedef std::shared_ptr<DeviceGraph> DeviceGraphPtr;
+
+// Keeps the graphs allocated on every device from competing for SHAVEs and
+// CMX. The first graph on a device gets the resources it was configured
+// with, and they become the budget of the device. Each graph joining later
+// triggers a new split of that budget between all the graphs, and graphs
+// whose share changed are repacked. A graph that cannot be recompiled, e.g.
+// one imported from the HAL blob cache, keeps its configured resources and the
+// other graphs split the largest SHAVE range and CMX window it leaves free.
+// If a repack fails, the graphs already repacked get their previous shares
+// back. Repacking holds a lock of the device only, other devices are planned
+// meanwhile.
+class DeviceResourcePlanner {
+public:
+    // Returns the resources the graph must be compiled for.
+    static GraphResources join(const DevicePtr &device, const DeviceGraphPtr &graph,
+                               const Common::LoggerPtr &log);
+
+    // The freed resources go to the next graph joining the device, the
+    // remaining graphs are not recompiled. Waits for a repack of the device
+    // in progress, so the graph is not repacked once this returns.
+    static void leave(const DevicePtr &device, const DeviceGraphPtr &graph);
+
+    // The graphs on the device with their shares, e.g. "net1: shaves 0-3, cmx 0+524288; ...",
+    // reported as the "Device-Resources" performance counter of the infer requests
+    static std::string describe(const DevicePtr &device);
+};
+
+}  // namespace MyriadPlugin
+}  // namespace VPU
@@ -0,0 +1,330 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2017 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+#include <ie_common.h>
+#include <cpp_interfaces/ie_task_executor.hpp>
+
+#include "myriad_scheduler.h"
+
+using namespace VPU::Common;
+using namespace VPU::MyriadPlugin;
+using namespace InferenceEngine;
+
+// weight of the newest sample in the moving average of inference time
+static const double INFERENCE_TIME_WEIGHT = 0.2;
+
+MyriadScheduler::MyriadScheduler(const MyriadExecutorPtr &executor, const LoggerPtr &log,
+                                 std::vector<DevicePtr> &devicePool, DevicePtr &device,
+                                 const std::vector<char> &graphBlob, size_t numStages,
+                                 const std::string &networkName, bool multiDevice, int fifoDepth,
+                                 const GraphCompiler &compiler, const GraphResources &resources,
+                                 const GraphProfile &profile) :
+        _executor(executor), _log(log), _devicePool(&devicePool), _graphBlob(graphBlob),
+        _numStages(numStages), _networkName(networkName), _platform(device->_platform),
+        _multiDevice(multiDevice), _fifoDepth(fifoDepth), _compiler(compiler), _resources(resources),
+        _profile(profile) {
+    addSlot(device);
+
+    if (_multiDevice) {
+        rescan();
+        LOG_INFO("[VPU] network %s replicated on %u devices", _networkName.c_str(),
+                 static_cast<unsigned>(_slots.size()));
+        _rescanThread = std::thread(&MyriadScheduler::rescanLoop, this);
+    }
+}
+
+MyriadScheduler::~MyriadScheduler() {
+    if (_rescanThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopRescan = true;
+        }
+        _rescanCondition.notify_all();
+        _rescanThread.join();
+    }
+
+    for (auto &slot : _slots) {
+        releaseSlot(slot);
+    }
+}
+
+void MyriadScheduler::addSlot(DevicePtr &device) {
+    auto slot = std::make_shared<GraphSlot>();
+    slot->_device = device;
+
+    slot->_deviceGraph = std::make_shared<DeviceGraph>();
+    slot->_deviceGraph->name = _networkName;
+    slot->_deviceGraph->profile = _profile;
+    slot->_deviceGraph->resources = _resources;
+    if (_compiler) {
+        std::weak_ptr<GraphSlot> weakSlot = slot;
+        slot->_deviceGraph->repack = [this, weakSlot](const GraphResources &resources) {
+            if (auto slot = weakSlot.lock()) {
+                repack(slot, resources);
+            }
+        };
+    }
+
+    // the planner may repack the graph as soon as it joins, not before it is allocated
+    std::unique_lock<std::mutex> allocationLock(slot->_writeMutex);
+    auto resources = DeviceResourcePlanner::join(device, slot->_deviceGraph, _log);
+    try {
+        if (resources == _resources) {
+            _executor->allocateGraph(device, slot->_graphDesc, _graphBlob, _numStages, _networkName.c_str(), _fifoDepth);
+        } else {
+            std::vector<char> blob;
+            auto metaData = std::make_shared<std::vector<BlobMetaData>>();
+            size_t numStages = 0;
+            _compiler(resources, blob, *metaData, numStages);
+            _executor->allocateGraph(device, slot->_graphDesc, blob, numStages, _networkName.c_str(), _fifoDepth);
+            slot->_blobMetaData = metaData;
+        }
+    } catch (...) {
+        // release what was allocated and the executor taken on the device;
+        // leave() waits for repacks of the device, which may wait for this slot
+        allocationLock.unlock();
+        DeviceResourcePlanner::leave(device, slot->_deviceGraph);
+        _executor->deallocateGraph(device, slot->_graphDesc);
+        throw;
+    }
+    allocationLock.unlock();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int i = 0; i < GRAPH_RESULT_COLLECTORS; i++) {
+        std::stringstream idStream;
+        idStream << _networkName << "_TaskExecutorGetResult" << _slotsCreated << "_" << i;
+        slot->_taskExecutorsGetResult.push_back(std::make_shared<TaskExecutor>(idStream.str()));
+    }
+    _slotsCreated++;
+    _slots.push_back(slot);
+    _slotFreed.notify_all();
+}
+
+bool MyriadScheduler::reserve(InferenceTicket &ticket, bool wait) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        // devices without measurements are assumed as fast as the fastest one
+        double fastestMs = 0.0;
+        bool anyDevice = false;
+        for (auto &slot : _slots) {
+            anyDevice |= !slot->_lost;
+            if (!slot->_lost && slot->_inferenceTimeMs > 0.0 &&
+                (fastestMs == 0.0 || slot->_inferenceTimeMs < fastestMs)) {
+                fastestMs = slot->_inferenceTimeMs;
+            }
+        }
+        if (!anyDevice) {
+            THROW_IE_EXCEPTION << "[VPU] No MYRIAD device left to run network " << _networkName;
+        }
+        if (fastestMs == 0.0) {
+            fastestMs = 1.0;
+        }
+
+        double bestCost = 0.0;
+        ticket._slot = nullptr;
+        for (auto &slot : _slots) {
+            if (slot->_lost || slot->_inFlight >= _fifoDepth) {
+                continue;
+            }
+            double inferenceMs = slot->_inferenceTimeMs > 0.0 ? slot->_inferenceTimeMs : fastestMs;
+            double cost = (slot->_inFlight + 1) * inferenceMs;
+            if (ticket._slot == nullptr || cost < bestCost) {
+                ticket._slot = slot;
+                bestCost = cost;
+            }
+        }
+        if (ticket._slot != nullptr) {
+            break;
+        }
+        if (!wait) {
+            return false;
+        }
+        _slotFreed.wait(lock);
+    }
+
+    ticket._depth = ++ticket._slot->_inFlight;
+    return true;
+}
+
+void MyriadScheduler::cancel(const InferenceTicket &ticket) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ticket._slot->_inFlight -= 1;
+    }
+    _slotFreed.notify_all();
+}
+
+void MyriadScheduler::queueInference(InferenceTicket &ticket, void *inputData, size_t inputBytes) {
+    auto &slot = ticket._slot;
+    ticket._queued = std::chrono::steady_clock::now();
+    try {
+        // the reserved place guarantees the fifo has room, so the write does not block
+        std::lock_guard<std::mutex> lock(slot->_writeMutex);
+        _executor->queueInference(slot->_graphDesc, inputData, inputBytes, nullptr, nullptr);
+        ticket._sequence = slot->_written++;
+    } catch (...) {
+        finish(ticket, false);
+        throw;
+    }
+}
+
+void MyriadScheduler::getResult(const InferenceTicket &ticket, std::vector<uint8_t> &result) {
+    auto &slot = ticket._slot;
+    {
+        std::unique_lock<std::mutex> lock(slot->_readMutex);
+        slot->_readTurn.wait(lock, [&] { return slot->_read == ticket._sequence; });
+        try {
+            // the fifo reuses its output buffer for the next result
+            void *resultData = nullptr;
+            size_t resultBytes = 0;
+            _executor->getResult(slot->_graphDesc, &resultData, &resultBytes);
+            result.resize(resultBytes);
+            memcpy(result.data(), resultData, resultBytes);
+        } catch (...) {
+            slot->_read++;
+            lock.unlock();
+            slot->_readTurn.notify_all();
+            finish(ticket, false);
+            throw;
+        }
+        slot->_read++;
+    }
+    slot->_readTurn.notify_all();
+    finish(ticket, true);
+}
+
+void MyriadScheduler::repack(const GraphSlotPtr &slot, const GraphResources &resources) {
+    // compiled while the graph still runs
+    std::vector<char> blob;
+    auto metaData = std::make_shared<std::vector<BlobMetaData>>();
+    size_t numStages = 0;
+    _compiler(resources, blob, *metaData, numStages);
+
+    // no new inferences are written until the graph is replaced, and the
+    // results of the written ones are read first
+    std::lock_guard<std::mutex> writeLock(slot->_writeMutex);
+    {
+        std::unique_lock<std::mutex> readLock(slot->_readMutex);
+        slot->_readTurn.wait(readLock, [&] { return slot->_read == slot->_written; });
+    }
+
+    try {
+        _executor->reallocateGraph(slot->_device, slot->_graphDesc, blob, numStages, _networkName.c_str(), _fifoDepth);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        slot->_lost = true;
+        throw;
+    }
+    slot->_blobMetaData = metaData;
+
+    LOG_INFO("[VPU] network %s repacked on device %d to %s", _networkName.c_str(), slot->_device->_deviceIdx,
+             resources.toString().c_str());
+}
+
+void MyriadScheduler::releaseSlot(const GraphSlotPtr &slot) {
+    // no repacking once the graph is deallocated
+    DeviceResourcePlanner::leave(slot->_device, slot->_deviceGraph);
+    _executor->deallocateGraph(slot->_device, slot->_graphDesc);
+}
+
+GraphSlotPtr MyriadScheduler::primarySlot() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slots.empty() ? nullptr : _slots.front();
+}
+
+void MyriadScheduler::finish(const InferenceTicket &ticket, bool succeeded) {
+    auto &slot = ticket._slot;
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    slot->_inFlight -= 1;
+    if (succeeded) {
+        double elapsedMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - ticket._queued).count();
+        double inferenceMs = elapsedMs / ticket._depth;
+        slot->_inferenceTimeMs = slot->_inferenceTimeMs == 0.0 ? inferenceMs :
+                (1.0 - INFERENCE_TIME_WEIGHT) * slot->_inferenceTimeMs + INFERENCE_TIME_WEIGHT * inferenceMs;
+    } else if (_multiDevice && !slot->_lost) {
+        LOG_WARNING("[VPU] inference failed on device %d, draining it", slot->_device->_deviceIdx);
+        slot->_lost = true;
+        MyriadExecutor::markDeviceLost(slot->_device);
+    }
+    lock.unlock();
+    _slotFreed.notify_all();
+}
+
+void MyriadScheduler::rescan() {
+    std::vector<DevicePtr> used;
+    std::vector<GraphSlotPtr> drained;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &slot : _slots) {
+            used.push_back(slot->_device);
+        }
+        auto last = std::stable_partition(_slots.begin(), _slots.end(), [](const GraphSlotPtr &slot) {
+            return !slot->_lost || slot->_inFlight != 0;
+        });
+        drained.assign(last, _slots.end());
+        _slots.erase(last, _slots.end());
+    }
+
+    for (auto &slot : drained) {
+        LOG_INFO("[VPU] releasing network %s on device %d", _networkName.c_str(), slot->_device->_deviceIdx);
+        releaseSlot(slot);
+    }
+
+    for (auto &device : _executor->openExtraDevices(*_devicePool, _platform, used)) {
+        try {
+            addSlot(device);
+            LOG_INFO("[VPU] network %s allocated on device %d", _networkName.c_str(), device->_deviceIdx);
+        } catch (const std::exception &ex) {
+            LOG_WARNING("[VPU] failed to allocate network %s on device %d: %s",
+                        _networkName.c_str(), device->_deviceIdx, ex.what());
+        }
+    }
+}
+
+void MyriadScheduler::rescanLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_rescanCondition.wait_for(lock, std::chrono::milliseconds(DEVICE_RESCAN_INTERVAL_MS),
+                                      [this] { return _stopRescan; })) {
+        lock.unlock();
+        try {
+            rescan();
+        } catch (const std::exception &ex) {
+            LOG_WARNING("[VPU] device rescan failed: %s", ex.what());
+        }
+        lock.lock();
+    }
+}
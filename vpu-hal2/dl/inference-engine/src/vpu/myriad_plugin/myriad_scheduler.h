@@ -0,0 +1,180 @@
+//
+// INTEL CONFIDENTIAL
+// Copyright 2017 Intel Corporation.
+//
+// The source code contained or described herein and all documents
+// related to the source code ("Material") are owned by Intel Corporation
+// or its suppliers or licensors. Title to the Material remains with
+// Intel Corporation or its suppliers and licensors. The Material may
+// contain trade secrets and proprietary and confidential information
+// of Intel Corporation and its suppliers and licensors, and is protected
+// by worldwide copyright and trade secret laws and treaty provisions.
+// No part of the Material may be used, copied, reproduced, modified,
+// published, uploaded, posted, transmitted, distributed, or disclosed
+// in any way without Intel's prior express written permission.
+//
+// No license under any patent, copyright, trade secret or other
+// intellectual property right is granted to or conferred upon you by
+// disclosure or delivery of the Materials, either expressly, by implication,
+// inducement, estoppel or otherwise. Any license under such intellectual
+// property rights must be express and approved by Intel in writing.
+//
+// Include any supplier copyright notices as supplier requires Intel to use.
+//
+// Include supplier trademarks or logos as supplier requires Intel to use,
+// preceded by an asterisk. An asterisked footnote can be added as follows:
+// *Third Party trademarks are the property of their respective owners.
+//
+// Unless otherwise agreed by Intel in writing, you may not remove or alter
+// this notice or any other notice embedded in Materials by Intel or Intel's
+// suppliers or licensors in any way.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <cpp_interfaces/ie_itask_executor.hpp>
+#include <vpu_logger.h>
+#include "myriad_executor.h"
+#include "myriad_resource_planner.h"
+
+namespace VPU {
+namespace MyriadPlugin {
+
+// Threads collecting the results of one graph. Results are read from the
+// device one at a time, so a second collector only serves to convert the
+// previous result while the next one is read.
+#define GRAPH_RESULT_COLLECTORS 2
+
+// The graph of a network allocated on one device.
+struct GraphSlot {
+    DevicePtr _device;
+    GraphDesc _graphDesc;
+    // collectors of the results, inference n goes to collector n % size;
+    // owned by the slot so that a graph never waits behind another graph
+    std::vector<InferenceEngine::ITaskExecutor::Ptr> _taskExecutorsGetResult;
+
+    // the output fifo returns results in the order inputs were written, so
+    // inferences are numbered when written and read back in that order
+    std::mutex _writeMutex;
+    uint64_t _written = 0;
+    std::mutex _readMutex;
+    std::condition_variable _readTurn;
+    uint64_t _read = 0;
+
+    // inferences written and not read yet, never more than the fifo depth
+    // so that writing to the fifo never waits for room
+    int _inFlight = 0;
+    // moving average of the time of one inference, 0 until measured
+    double _inferenceTimeMs = 0.0;
+    // no new inferences are queued, the graph is released once drained
+    bool _lost = false;
+
+    // the share of the device the graph is compiled for, registered with
+    // DeviceResourcePlanner when the network can be recompiled
+    DeviceGraphPtr _deviceGraph;
+    // metadata of the graph when it was recompiled for its share, the
+    // network metadata otherwise
+    std::shared_ptr<const std::vector<BlobMetaData>> _blobMetaData;
+};
+
+typedef std::shared_ptr<GraphSlot> GraphSlotPtr;
+
+// One inference queued to a slot.
+struct InferenceTicket {
+    GraphSlotPtr _slot;
+    std::chrono::steady_clock::time_point _queued;
+    // inferences in flight on the slot when this one was queued, itself included
+    int _depth = 0;
+    uint64_t _sequence = 0;
+
+    InferenceEngine::ITaskExecutor::Ptr taskExecutorGetResult() const {
+        return _slot->_taskExecutorsGetResult[_sequence % _slot->_taskExecutorsGetResult.size()];
+    }
+};
+
+// Allocates the graph of a network and chooses the device every inference
+// runs on. By default the graph is allocated on the network's device only.
+// In multi-device mode it is replicated on every device of that platform
+// and each inference is queued to the device expected to finish it first,
+// judging by its queue length and recent inference time. A device on which
+// an inference fails takes no new work and is released once its queue has
+// drained; devices plugged in later get a replica of the graph.
+//
+// Up to fifoDepth inferences can be queued on each device, counting those
+// of all requests: reserve() takes one of these places and getResult()
+// gives it back. getResult() waits until the results of all earlier
+// inferences on the device have been read, so collectors may call it in
+// any order. A caller holding unread inferences must not wait in
+// reserve(): the place it waits for may only be freed once another caller
+// has read past the caller's own results.
+//
+// Given a compiler, the scheduler compiles the graph for the share of each
+// device DeviceResourcePlanner gives it, and recompiles and reallocates it
+// when the planner repacks it for a graph joining the device.
+class MyriadScheduler {
+public:
+    typedef std::shared_ptr<MyriadScheduler> Ptr;
+
+    MyriadScheduler(const MyriadExecutorPtr &executor, const Common::LoggerPtr &log,
+                    std::vector<DevicePtr> &devicePool, DevicePtr &device,
+                    const std::vector<char> &graphBlob, size_t numStages,
+                    const std::string &networkName, bool multiDevice, int fifoDepth,
+                    const GraphCompiler &compiler, const GraphResources &resources,
+                    const GraphProfile &profile);
+    ~MyriadScheduler();
+
+    // Takes a place on the device expected to finish first. Returns false
+    // if no device has room and wait is false; waits for room otherwise.
+    bool reserve(InferenceTicket &ticket, bool wait);
+    // Gives back a place reserved but not queued.
+    void cancel(const InferenceTicket &ticket);
+    void queueInference(InferenceTicket &ticket, void *inputData, size_t inputBytes);
+
+    // Copies the result of the inference into result.
+    void getResult(const InferenceTicket &ticket, std::vector<uint8_t> &result);
+
+    // the slot of the first device still in use, for performance counters
+    GraphSlotPtr primarySlot();
+
+private:
+    void addSlot(DevicePtr &device);
+    void repack(const GraphSlotPtr &slot, const GraphResources &resources);
+    void releaseSlot(const GraphSlotPtr &slot);
+    void finish(const InferenceTicket &ticket, bool succeeded);
+    void rescan();
+    void rescanLoop();
+
+    MyriadExecutorPtr _executor;
+    Common::LoggerPtr _log;
+    std::vector<DevicePtr> *_devicePool;
+    // owned by the executable network, which outlives the scheduler
+    const std::vector<char> &_graphBlob;
+    size_t _numStages;
+    std::string _networkName;
+    int _platform;
+    bool _multiDevice;
+    int _fifoDepth;
+    GraphCompiler _compiler;
+    // what graphBlob is compiled for
+    GraphResources _resources;
+    GraphProfile _profile;
+
+    std::mutex _mutex;
+    std::vector<GraphSlotPtr> _slots;
+    size_t _slotsCreated = 0;
+    // signalled when an inference ends or a slot is added
+    std::condition_variable _slotFreed;
+
+    std::thread _rescanThread;
+    std::condition_variable _rescanCondition;
+    bool _stopRescan = false;
+};
+
+}  // namespace MyriadPlugin
+}  // namespace VPU
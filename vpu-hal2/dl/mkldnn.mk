@@ -0,0 +1,177 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+# CPU plugin of the inference engine, runs the subgraphs the Myriad cannot
+# (vendor.vpu.cpu_fallback). mkl-dnn generates x86 code, so it is built for
+# x86 targets only.
+LOCAL_MODULE := libmkldnn
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_MODULE_OWNER := intel
+LOCAL_MULTILIB := both
+LOCAL_MODULE_TARGET_ARCH := x86 x86_64
+LOCAL_SRC_FILES := \
+	inference-engine/thirdparty/mkl-dnn/src/common/batch_normalization.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/convolution_relu.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/eltwise.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/engine.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/inner_product.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/lrn.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/memory.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/memory_desc_wrapper.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/mkldnn_debug.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/primitive.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/primitive_attr.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/primitive_desc.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/primitive_iterator.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/query.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/reorder.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/roi_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/scratchpad.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/softmax.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/stream.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/common/verbose.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/cpu_barrier.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/cpu_concat.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/cpu_engine.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/cpu_reducer.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/cpu_reorder.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/cpu_sum.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/gemm_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/gemm_convolution_utils.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/gemm_inner_product.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/gemm_u8s8s32x_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx2_1x1_conv_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx2_1x1_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx2_conv_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx2_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx2_gemm_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_1x1_conv_kernel.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_1x1_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_conv_kernel.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_conv_winograd_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_convolution_winograd.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_gemm_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_common_lrn.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_core_i8i8_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_avx512_core_u8s8s32x_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_sse42_1x1_conv_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_sse42_1x1_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_sse42_conv_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_sse42_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_transpose_src_utils.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_batch_normalization.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_dw_conv_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_dw_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_eltwise.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_inner_product.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_lrn.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_lrn_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_pool_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_roi_pool_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_roi_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_softmax.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/jit_uni_softmax_kernel_f32.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/nchw_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/nhwc_concat.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_batch_normalization.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_convolution.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_eltwise.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_inner_product.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_lrn.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_roi_pooling.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/ref_softmax.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/simple_concat.cpp \
+	inference-engine/thirdparty/mkl-dnn/src/cpu/simple_sum.cpp
+
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)/inference-engine/thirdparty/mkl-dnn/include \
+	$(LOCAL_PATH)/inference-engine/thirdparty/mkl-dnn/src \
+	$(LOCAL_PATH)/inference-engine/thirdparty/mkl-dnn/src/common \
+	$(LOCAL_PATH)/inference-engine/thirdparty/mkl-dnn/src/cpu/xbyak
+
+
+LOCAL_CFLAGS += -std=c++11 -Wall -Wno-unknown-pragmas -Wno-strict-overflow -fPIC -Wformat -Wformat-security -fstack-protector-all
+LOCAL_CFLAGS += -Wno-unused-variable -Wno-unused-parameter -Wno-missing-field-initializers -fexceptions -frtti -Wno-error
+LOCAL_CFLAGS += -D__STDC_LIMIT_MACROS -D__STDC_CONSTANT_MACROS -std=gnu++11 -D_FORTIFY_SOURCE=2 -fPIE -fopenmp
+
+include $(BUILD_STATIC_LIBRARY)
+##############################################
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libMKLDNNPlugin
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_MODULE_OWNER := intel
+LOCAL_MULTILIB := both
+LOCAL_MODULE_TARGET_ARCH := x86 x86_64
+LOCAL_SRC_FILES := \
+	inference-engine/src/mkldnn_plugin/config.cpp \
+	inference-engine/src/mkldnn_plugin/mean_image.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn/iml_type_mapper.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn/os/lin/lin_omp_manager.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_async_infer_request.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_descriptor.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_edge.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_extension_mngr.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_extension_utils.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_graph.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_graph_optimizer.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_infer_request.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_inter_op_scheduler.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_memory.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_memory_solver.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_node.cpp \
+	inference-engine/src/mkldnn_plugin/mkldnn_plugin.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_activation_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_batchnorm_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_clamp_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_concat_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_conv_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_crop_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_deconv_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_eltwise_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_fullyconnected_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_generic_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_input_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_lrn_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_memory_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_permute_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_pooling_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_power_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_reorder_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_reshape_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_roi_pooling_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_scaleshift_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_softmax_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_split_node.cpp \
+	inference-engine/src/mkldnn_plugin/nodes/mkldnn_tile_node.cpp
+
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)/inference-engine/include \
+	$(LOCAL_PATH)/inference-engine/include/cpp \
+	$(LOCAL_PATH)/inference-engine/src/inference_engine \
+	$(LOCAL_PATH)/inference-engine/src/inference_engine/cpp_interfaces \
+	$(LOCAL_PATH)/inference-engine/src/inference_engine/cpp_interfaces/base \
+	$(LOCAL_PATH)/inference-engine/src/inference_engine/cpp_interfaces/impl \
+	$(LOCAL_PATH)/inference-engine/src/inference_engine/cpp_interfaces/interface \
+	$(LOCAL_PATH)/inference-engine/src/mkldnn_plugin \
+	$(LOCAL_PATH)/inference-engine/src/mkldnn_plugin/mkldnn \
+	$(LOCAL_PATH)/inference-engine/thirdparty/mkl-dnn/include
+
+
+LOCAL_CFLAGS += -std=c++11 -Wall -Wno-unknown-pragmas -Wno-strict-overflow -fPIC -Wformat -Wformat-security -fstack-protector-all
+LOCAL_CFLAGS += -Wno-unused-variable -Wno-unused-parameter -Wno-non-virtual-dtor -Wno-missing-field-initializers -fexceptions -frtti -Wno-error
+LOCAL_CFLAGS += -DAKS -DIMPLEMENT_INFERENCE_ENGINE_API -fvisibility=default -std=gnu++11 -D_FORTIFY_SOURCE=2 -fPIE -fopenmp
+LOCAL_LDFLAGS += -fopenmp
+
+LOCAL_STATIC_LIBRARIES := libmkldnn
+
+LOCAL_SHARED_LIBRARIES := libinference_engine liblog
+
+include $(BUILD_SHARED_LIBRARY)
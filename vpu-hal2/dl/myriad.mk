@@ -9,9 +9,12 @@ LOCAL_MODULE_OWNER := intel
 
 LOCAL_SRC_FILES := \
 	inference-engine/src/vpu/myriad_plugin/myriad_async_infer_request.cpp \
+	inference-engine/src/vpu/myriad_plugin/myriad_executable_network.cpp \
 	inference-engine/src/vpu/myriad_plugin/myriad_executor.cpp \
 	inference-engine/src/vpu/myriad_plugin/myriad_infer_request.cpp \
-	inference-engine/src/vpu/myriad_plugin/myriad_plugin.cpp
+	inference-engine/src/vpu/myriad_plugin/myriad_plugin.cpp \
+	inference-engine/src/vpu/myriad_plugin/myriad_resource_planner.cpp \
+	inference-engine/src/vpu/myriad_plugin/myriad_scheduler.cpp
 
 
 LOCAL_C_INCLUDES += \
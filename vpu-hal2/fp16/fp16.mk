@@ -0,0 +1,16 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libvpu_fp16
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_MODULE_OWNER := intel
+LOCAL_MULTILIB := both
+LOCAL_SRC_FILES := \
+    vpu_fp16.c
+
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)
+
+# the kernels must round x * scale + bias the way the scalar code does
+LOCAL_CFLAGS += -std=gnu99 -O2 -Wall -fPIC -ffp-contract=off -Wno-error
+
+include $(BUILD_STATIC_LIBRARY)
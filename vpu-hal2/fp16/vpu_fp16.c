@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include "vpu_fp16.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/*
+ * x * scale + bias must round twice, like the scalar callers always did;
+ * a fused multiply-add would change the low bit of some results. GCC
+ * ignores the pragma, it gets -ffp-contract=off from fp16.mk instead.
+ */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+// F32: exp_bias:127 SEEEEEEE EMMMMMMM MMMMMMMM MMMMMMMM.
+// F16: exp_bias:15  SEEEEEMM MMMMMMMM
+#define EXP_MASK_F32 0x7F800000U
+#define EXP_MASK_F16     0x7C00U
+
+// minimal positive normal f16 value: exp:-14,mantissa:0 -> 2^-14 * 1.0
+#define MIN16 0x1p-14F
+// maximal positive normal f16 value: exp:15,mantissa:11111 -> 2^15 * 1.(11111)
+#define MAX16 0x1.ffcp15F
+#define MAX16_F16 (((15U + 15U) << 10) | 0x3FFU)
+// halfULP of a f16 value relative to the f32 exponent: 2^(10 - 23 - 1 + 13)
+#define HALF_ULP_SCALE 0x1p-11F
+
+static inline float asfloat(uint32_t v)
+{
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static inline uint32_t asuint(float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return v;
+}
+
+// Function to convert F16 into F32
+float vpu_fp16_to_f32(uint16_t x)
+{
+    // this is storage for output result
+    uint32_t u = x;
+
+    // get sign in 32bit format
+    uint32_t s = ((u & 0x8000) << 16);
+
+    // check for NAN and INF
+    if ((u & EXP_MASK_F16) == EXP_MASK_F16) {
+        // keep mantissa only
+        u &= 0x03FF;
+
+        // check if it is NAN and raise 10 bit to be align with intrin
+        if (u) {
+            u |= 0x0200;
+        }
+
+        u <<= (23 - 10);
+        u |= EXP_MASK_F32;
+        u |= s;
+    } else if ((x & EXP_MASK_F16) == 0) {  // check for zero and denormals. both are converted to zero
+        u = s;
+    } else {
+        // abs
+        u = (u & 0x7FFF);
+
+        // shift mantissa and exp from f16 to f32 position
+        u <<= (23 - 10);
+
+        // new bias for exp (f16 bias is 15 and f32 bias is 127)
+        u += ((127 - 15) << 23);
+
+        // add sign
+        u |= s;
+    }
+
+    // finaly represent result as float and return
+    return asfloat(u);
+}
+
+// This function convert f32 to f16 with rounding to nearest value to minimize error
+// the denormal values are converted to 0.
+uint16_t vpu_fp16_from_f32(float x)
+{
+    uint32_t u = asuint(x);
+
+    // get sign in 16bit format
+    uint32_t s = (u >> 16) & 0x8000;  // sign 16:  00000000 00000000 10000000 00000000
+
+    // make it abs
+    u &= 0x7FFFFFFF;  // abs mask: 01111111 11111111 11111111 11111111
+
+    // check NAN and INF
+    // the result is truncated to 16 bits, which also sets the sign bit of INF
+    if ((u & EXP_MASK_F32) == EXP_MASK_F32) {
+        if (u & 0x007FFFFF) {
+            return (uint16_t)(s | (u >> (23 - 10)) | 0x0200);  // return NAN f16
+        } else {
+            return (uint16_t)(s | (u >> (23 - 10)));  // return INF f16
+        }
+    }
+
+    // to make f32 round to nearest f16
+    // create halfULP for f16 and add it to origin value
+    float halfULP = asfloat(u & EXP_MASK_F32) * HALF_ULP_SCALE;
+    float v = asfloat(u) + halfULP;
+
+    // if input value is not fit normalized f16 then return 0
+    // denormals are not covered by this code and just converted to 0
+    if (v < MIN16 * 0.5F) {
+        return (uint16_t)s;
+    }
+
+    // if input value between min16/2 and min16 then return min16
+    if (v < MIN16) {
+        return (uint16_t)(s | (1 << 10));
+    }
+
+    // if input value more than maximal allowed value for f16
+    // then return this maximal value
+    if (v >= MAX16) {
+        return (uint16_t)(MAX16_F16 | s);
+    }
+
+    u = asuint(v);
+
+    // change exp bias from 127 to 15
+    u -= ((127 - 15) << 23);
+
+    // round to f16
+    u >>= (23 - 10);
+
+    return (uint16_t)(u | s);
+}
+
+// Copied from Numpy
+
+uint32_t vpu_fp16_to_f32_ieee(uint16_t h)
+{
+    uint16_t h_exp, h_sig;
+    uint32_t f_sgn, f_exp, f_sig;
+
+    h_exp = (h&0x7c00u);
+    f_sgn = ((uint32_t)h&0x8000u) << 16;
+    switch (h_exp) {
+        case 0x0000u: /* 0 or subnormal */
+            h_sig = (h&0x03ffu);
+            /* Signed zero */
+            if (h_sig == 0) {
+                return f_sgn;
+            }
+            /* Subnormal */
+            h_sig <<= 1;
+            while ((h_sig&0x0400u) == 0) {
+                h_sig <<= 1;
+                h_exp++;
+            }
+            f_exp = ((uint32_t)(127 - 15 - h_exp)) << 23;
+            f_sig = ((uint32_t)(h_sig&0x03ffu)) << 13;
+            return f_sgn + f_exp + f_sig;
+        case 0x7c00u: /* inf or NaN */
+            /* All-ones exponent and a copy of the significand */
+            return f_sgn + 0x7f800000u + (((uint32_t)(h&0x03ffu)) << 13);
+        default: /* normalized */
+            /* Just need to adjust the exponent and shift */
+            return f_sgn + (((uint32_t)(h&0x7fffu) + 0x1c000u) << 13);
+    }
+}
+
+uint16_t vpu_fp16_from_f32_ieee(uint32_t f)
+{
+    uint32_t f_exp, f_sig;
+    uint16_t h_sgn, h_exp, h_sig;
+
+    h_sgn = (uint16_t) ((f&0x80000000u) >> 16);
+    f_exp = (f&0x7f800000u);
+
+    /* Exponent overflow/NaN converts to signed inf/NaN */
+    if (f_exp >= 0x47800000u) {
+        if (f_exp == 0x7f800000u) {
+            /* Inf or NaN */
+            f_sig = (f&0x007fffffu);
+            if (f_sig != 0) {
+                /* NaN - propagate the flag in the significand... */
+                uint16_t ret = (uint16_t) (0x7c00u + (f_sig >> 13));
+                /* ...but make sure it stays a NaN */
+                if (ret == 0x7c00u) {
+                    ret++;
+                }
+                return h_sgn + ret;
+            } else {
+                /* signed inf */
+                return (uint16_t) (h_sgn + 0x7c00u);
+            }
+        } else {
+            /* overflow to signed inf */
+            return (uint16_t) (h_sgn + 0x7c00u);
+        }
+    }
+
+    /* Exponent underflow converts to a subnormal half or signed zero */
+    if (f_exp <= 0x38000000u) {
+        /*
+         * Signed zeros, subnormal floats, and floats with small
+         * exponents all convert to signed zero halfs.
+         */
+        if (f_exp < 0x33000000u) {
+            return h_sgn;
+        }
+        /* Make the subnormal significand */
+        f_exp >>= 23;
+        f_sig = (0x00800000u + (f&0x007fffffu));
+        f_sig >>= (113 - f_exp);
+        /* Handle rounding by adding 1 to the bit beyond half precision */
+        f_sig += 0x00001000u;
+        h_sig = (uint16_t) (f_sig >> 13);
+        /*
+         * If the rounding causes a bit to spill into h_exp, it will
+         * increment h_exp from zero to one and h_sig will be zero.
+         * This is the correct result.
+         */
+        return (uint16_t) (h_sgn + h_sig);
+    }
+
+    /* Regular case with no overflow or underflow */
+    h_exp = (uint16_t) ((f_exp - 0x38000000u) >> 13);
+    /* Handle rounding by adding 1 to the bit beyond half precision */
+    f_sig = (f&0x007fffffu);
+    f_sig += 0x00001000u;
+    h_sig = (uint16_t) (f_sig >> 13);
+    /*
+     * If the rounding causes a bit to spill into h_exp, it will
+     * increment h_exp by one and h_sig will be zero.  This is the
+     * correct result.  h_exp may increment to 15, at greatest, in
+     * which case the result overflows to a signed inf.
+     */
+    return h_sgn + h_exp + h_sig;
+}
+
+static void scalar_from_f32_array(uint16_t *dst, const float *src, size_t nelem, float scale, float bias)
+{
+    for (size_t i = 0; i < nelem; i++) {
+        dst[i] = vpu_fp16_from_f32(src[i] * scale + bias);
+    }
+}
+
+static void scalar_to_f32_array(float *dst, const uint16_t *src, size_t nelem, float scale, float bias)
+{
+    for (size_t i = 0; i < nelem; i++) {
+        dst[i] = vpu_fp16_to_f32(src[i]) * scale + bias;
+    }
+}
+
+static void scalar_from_f32_ieee_array(uint16_t *dst, const float *src, size_t nelem)
+{
+    for (size_t i = 0; i < nelem; i++) {
+        dst[i] = vpu_fp16_from_f32_ieee(asuint(src[i]));
+    }
+}
+
+static void scalar_to_f32_ieee_array(float *dst, const uint16_t *src, size_t nelem)
+{
+    for (size_t i = 0; i < nelem; i++) {
+        dst[i] = asfloat(vpu_fp16_to_f32_ieee(src[i]));
+    }
+}
+
+/*
+ * Vector kernels. SSE2 is part of every x86 Android ABI and NEON of arm64,
+ * so those are built unconditionally; AVX2 is built with a function target
+ * and only used when cpuid reports it. 32-bit ARM keeps the scalar code
+ * because its NEON unit flushes denormal results of scale/bias to zero.
+ */
+#if defined(__SSE2__) || defined(__aarch64__)
+#define VPU_FP16_HAVE_VEC128 1
+#define FP16_LANES 4
+#define FP16_TARGET
+#define FP16_NAME(name) vec128_##name
+#include "vpu_fp16_kernels.inc"
+#undef FP16_LANES
+#undef FP16_TARGET
+#undef FP16_NAME
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VPU_FP16_HAVE_AVX2 1
+#define FP16_LANES 8
+#define FP16_TARGET __attribute__((target("avx2")))
+#define FP16_NAME(name) avx2_##name
+#include "vpu_fp16_kernels.inc"
+#undef FP16_LANES
+#undef FP16_TARGET
+#undef FP16_NAME
+
+static int cpu_has_avx2(void)
+{
+    unsigned eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    // the OS must save the YMM state, see OSXSAVE and XCR0
+    if (!(ecx & bit_OSXSAVE)) {
+        return 0;
+    }
+    unsigned xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) {
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (ebx & bit_AVX2) != 0;
+}
+#endif
+
+struct vpu_fp16_kernels {
+    const char *isa;
+    void (*from_f32_array)(uint16_t *, const float *, size_t, float, float);
+    void (*to_f32_array)(float *, const uint16_t *, size_t, float, float);
+    void (*from_f32_ieee_array)(uint16_t *, const float *, size_t);
+    void (*to_f32_ieee_array)(float *, const uint16_t *, size_t);
+};
+
+static struct vpu_fp16_kernels kernels = {
+    "scalar",
+    scalar_from_f32_array,
+    scalar_to_f32_array,
+    scalar_from_f32_ieee_array,
+    scalar_to_f32_ieee_array,
+};
+
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+static void select_kernels(void)
+{
+#if VPU_FP16_HAVE_AVX2
+    if (cpu_has_avx2()) {
+        kernels.isa = "avx2";
+        kernels.from_f32_array = avx2_from_f32_array;
+        kernels.to_f32_array = avx2_to_f32_array;
+        kernels.from_f32_ieee_array = avx2_from_f32_ieee_array;
+        kernels.to_f32_ieee_array = avx2_to_f32_ieee_array;
+        return;
+    }
+#endif
+#if VPU_FP16_HAVE_VEC128
+#if defined(__aarch64__)
+    kernels.isa = "neon";
+#else
+    kernels.isa = "sse2";
+#endif
+    kernels.from_f32_array = vec128_from_f32_array;
+    kernels.to_f32_array = vec128_to_f32_array;
+    kernels.from_f32_ieee_array = vec128_from_f32_ieee_array;
+    kernels.to_f32_ieee_array = vec128_to_f32_ieee_array;
+#endif
+}
+
+static inline const struct vpu_fp16_kernels *get_kernels(void)
+{
+    pthread_once(&kernels_once, select_kernels);
+    return &kernels;
+}
+
+void vpu_fp16_from_f32_array(uint16_t *dst, const float *src, size_t nelem, float scale, float bias)
+{
+    get_kernels()->from_f32_array(dst, src, nelem, scale, bias);
+}
+
+void vpu_fp16_to_f32_array(float *dst, const uint16_t *src, size_t nelem, float scale, float bias)
+{
+    get_kernels()->to_f32_array(dst, src, nelem, scale, bias);
+}
+
+void vpu_fp16_from_f32_ieee_array(uint16_t *dst, const float *src, size_t nelem)
+{
+    get_kernels()->from_f32_ieee_array(dst, src, nelem);
+}
+
+void vpu_fp16_to_f32_ieee_array(float *dst, const uint16_t *src, size_t nelem)
+{
+    get_kernels()->to_f32_ieee_array(dst, src, nelem);
+}
+
+const char *vpu_fp16_isa(void)
+{
+    return get_kernels()->isa;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPU_FP16_H
+#define VPU_FP16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * fp32 <-> fp16 conversions shared by the HAL, the Inference Engine and
+ * libmvnc. The array functions pick the widest kernel the CPU supports at
+ * first use (AVX2 or SSE2 on x86, NEON on arm64, scalar otherwise); every
+ * kernel produces the same bits as the scalar functions below.
+ *
+ * Two rounding flavours are provided because the callers already disagree
+ * and the results must not change:
+ *
+ *  - vpu_fp16_* follow the Inference Engine: rounding adds half an ulp,
+ *    fp16 denormals are flushed to zero in both directions and finite
+ *    values beyond the fp16 range saturate to the largest normal.
+ *
+ *  - vpu_fp16_*_ieee follow the numpy code libmvnc was built on: fp16
+ *    denormals are produced and decoded, rounding adds half an ulp and
+ *    finite values beyond the fp16 range overflow to infinity.
+ */
+
+uint16_t vpu_fp16_from_f32(float x);
+float vpu_fp16_to_f32(uint16_t h);
+
+/* dst[i] = vpu_fp16_from_f32(src[i] * scale + bias) */
+void vpu_fp16_from_f32_array(uint16_t *dst, const float *src, size_t nelem, float scale, float bias);
+
+/* dst[i] = vpu_fp16_to_f32(src[i]) * scale + bias */
+void vpu_fp16_to_f32_array(float *dst, const uint16_t *src, size_t nelem, float scale, float bias);
+
+uint16_t vpu_fp16_from_f32_ieee(uint32_t f);
+uint32_t vpu_fp16_to_f32_ieee(uint16_t h);
+
+void vpu_fp16_from_f32_ieee_array(uint16_t *dst, const float *src, size_t nelem);
+void vpu_fp16_to_f32_ieee_array(float *dst, const uint16_t *src, size_t nelem);
+
+/* Name of the kernel set the array functions dispatch to. */
+const char *vpu_fp16_isa(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VPU_FP16_H */
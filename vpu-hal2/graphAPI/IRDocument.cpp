@@ -36,6 +36,7 @@
 #include "cnn_network_impl.hpp"
 #include <locale>
 #include "IRLayers.h"
+#include "precision_utils.h"
 #include <fstream>
 
 #ifdef NNLOG
@@ -169,10 +170,49 @@ void IRDocument::optimize()
     }
 }
 
+void IRDocument::convertToFP32()
+{
+    InputsDataMap inputs;
+    network->getInputsInfo(inputs);
+    for(auto i : inputs)
+    {
+        i.second->getInputData()->setPrecision(Precision::FP32);
+    }
+
+    for(auto &l : _layers)
+    {
+        l->precision = Precision::FP32;
+        for(auto o : l->outData)
+        {
+            if(o->getPrecision() == Precision::FP16) o->setPrecision(Precision::FP32);
+        }
+
+        std::map<Blob::Ptr, Blob::Ptr> converted;
+        for(auto &kvp : l->blobs)
+        {
+            auto src = kvp.second;
+            if(!src || src->precision() != Precision::FP16) continue;
+            TensorDesc td(Precision::FP32, src->getTensorDesc().getDims(), src->getTensorDesc().getLayout());
+            auto dst = std::make_shared<TBlob<float>>(td);
+            dst->allocate();
+            PrecisionUtils::f16tof32Arrays(dst->buffer().as<float *>(), src->cbuffer().as<const short *>(), src->size());
+            converted[src] = dst;
+            kvp.second = dst;
+        }
+
+        auto weightable = std::dynamic_pointer_cast<WeightableLayer>(l);
+        if(weightable)
+        {
+            if(converted.count(weightable->_weights)) weightable->_weights = converted[weightable->_weights];
+            if(converted.count(weightable->_biases)) weightable->_biases = converted[weightable->_biases];
+        }
+    }
+}
+
 void IRDocument::build()
 {
     if(_processed) return;
-    network->setPrecision(Precision::FP16);
+    network->setPrecision(_precision);
     InputsDataMap inputs;
     network->getInputsInfo(inputs);
     for(auto i : inputs)
@@ -186,6 +226,7 @@ void IRDocument::build()
         process(l.second);
     }
     optimize();
+    if(_precision == Precision::FP32) convertToFP32();
     _processed = true;
 }
 
@@ -418,7 +459,7 @@ void IRDocument::saveToIR(std::ostream &binFile, pugi::xml_node &parent, const I
     layer.append_attribute("name").set_value(irLayer->name.c_str());
     layer.append_attribute("type").set_value(irLayer->type.c_str());
     layer.append_attribute("id").set_value(irLayer->userValue.v_int);
-    layer.append_attribute("precision").set_value("FP16");
+    layer.append_attribute("precision").set_value(_precision.name());
 
     if(!irLayer->params.empty())
     {
@@ -479,6 +520,11 @@ void IRDocument::saveLayerToDot(std::ostream &dot, const IRLayer &irLayer) const
     dot << "\"";
     dot << "\t\tshape = \"record\" ];" << std::endl;
 }
+void IRDocument::setPrecision(Precision precision)
+{
+    _precision = precision;
+}
+
 void IRDocument::setName(const char *name)
 {
     _name = name;
@@ -58,12 +58,14 @@ private:
     std::string _name;
     size_t _layer_id_cnt = 1;
     bool _processed = false;
+    InferenceEngine::Precision _precision = InferenceEngine::Precision::FP16;
 
     std::map<const float *, size_t> _segmentsMap;
 
     static bool shouldRemove(const IRLayer &l);
     void process(const IRLayer &value);
     void optimize();
+    void convertToFP32();
     void build();
 
     // saving functions
@@ -99,6 +101,10 @@ public:
     void addOutput(const IRLayer &src, int outIndx = 0);
     void addOutput(const InferenceEngine::DataPtr &src);
     void setName(const char *name);
+    // Precision of the built network. Layers are created in FP16 for the
+    // Myriad; FP32 converts them and their blobs for the CPU plugin.
+    // Must be set before the network is built.
+    void setPrecision(InferenceEngine::Precision precision);
     InferenceEngine::ICNNNetwork *getNetwork();
 };
 
@@ -34,6 +34,8 @@ LOCAL_SRC_FILES := \
 	fp16.c \
 	mvnc_api_highclass.c \
 	common/components/XLink/pc/UsbLinkPlatform.cpp \
+	common/components/XLink/pc/LoopbackLinkPlatform.c \
+	common/components/XLink/pc/LoopbackDevice.c \
 	common/components/XLink/pc/usb_boot.c \
 	common/components/XLink/shared/XLink.c \
 	common/components/XLink/shared/XLinkDispatcher.c \
@@ -51,6 +53,7 @@ LOCAL_CFLAGS += $(XLINK_CFLAGS) -D__PC__ -DUSE_USB_VSC -DDEVICE_SHELL_ENABLED -W
 LOCAL_CFLAGS += -O2 -Wall -pthread -fPIC -MMD -MP
 
 LOCAL_SHARED_LIBRARIES := libusb1.0 liblog
+LOCAL_STATIC_LIBRARIES := libvpu_fp16
 
 include $(BUILD_SHARED_LIBRARY)
 
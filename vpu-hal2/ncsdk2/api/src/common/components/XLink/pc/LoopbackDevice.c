@@ -0,0 +1,553 @@
+/*
+* Copyright 2017 Intel Corporation.
+* The source code, information and material ("Material") contained herein is
+* owned by Intel Corporation or its suppliers or licensors, and title to such
+* Material remains with Intel Corporation or its suppliers or licensors.
+* The Material contains proprietary information of Intel or its suppliers and
+* licensors. The Material is protected by worldwide copyright laws and treaty
+* provisions.
+* No part of the Material may be used, copied, reproduced, modified, published,
+* uploaded, posted, transmitted, distributed or disclosed in any way without
+* Intel's prior express written permission. No license under any patent,
+* copyright or other intellectual property rights in the Material is granted to
+* or conferred upon you, either expressly, by implication, inducement, estoppel
+* or otherwise.
+* Any license under such intellectual property rights must be express and
+* approved by Intel in writing.
+*/
+
+///
+/// @brief     Simulated mvnc firmware behind the loopback XLink backend
+///
+/// Serves the deviceMonitor and graphMonitor streams like the firmware does,
+/// and runs the inferences queued with GRAPH_TRIGGER_CMD in order on one
+/// executor: the input element is taken from the input fifo stream, the
+/// configured compute time is spent, and the output is written to the
+/// output fifo stream once the host has room for it. Graph files are only parsed for the input and output
+/// sizes and the number of stages.
+///
+
+#include "LoopbackDevice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "mvnc.h"
+#include "ncCommPrivate.h"
+#define MVLOG_UNIT_NAME xLinkLoopback
+#include "mvLog.h"
+
+#define FW_MAX_GRAPHS       10
+#define FW_MAX_FIFOS        20
+#define FW_MAX_EXECUTORS    4
+#define FW_MEMORY_SIZE      (512 * 1024 * 1024)
+
+// sizes of the replies mvnc_api.c checks for
+#define FW_OPTIMISATION_LIST_SIZE   (40 * 50)
+#define FW_THERMAL_STATS_SIZE       (100 + sizeof(float))
+#define FW_DEBUG_BUFFER_SIZE        120
+
+#define BLOB_MAGIC_NUMBER   8708
+
+// mirrors of the graph file headers written by the graph transformer
+typedef struct __attribute__((packed)) {
+    uint8_t  e_ident[2];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint16_t e_version;
+    uint32_t e_entry;
+    uint32_t e_phoff;
+    uint32_t e_shoff;
+    uint16_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+} blobElfHeader_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic_number;
+    uint32_t file_size;
+    uint32_t blob_ver_major;
+    uint32_t blob_ver_minor;
+    uint32_t num_shaves;
+    uint32_t bss_mem_size;
+    uint32_t stage_section_offset;
+    uint32_t buffer_section_offset;
+    uint32_t relocation_section_offset;
+} blobHeader_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t stage_count;
+    uint32_t stage_section_size;
+    uint32_t input_size;
+    uint32_t output_size;
+} blobStageSectionHeader_t;
+
+typedef struct {
+    int used;
+    uint32_t id;
+    uint32_t stages;
+    uint32_t inputSize;
+    uint32_t outputSize;
+    uint32_t fileSize;
+} fwGraph_t;
+
+typedef struct {
+    int used;
+    uint32_t id;
+    char name[16];
+    struct tensorDescriptor_t desc;
+    uint32_t elemCnt;
+} fwFifo_t;
+
+typedef struct fwJob_t {
+    struct fwJob_t* next;
+    uint32_t graphId;
+    char input[16];
+    char output[16];
+    uint32_t outputSize;
+    uint32_t outputElements;
+} fwJob_t;
+
+typedef struct {
+    loopbackDevice_t* dev;
+    const loopbackLinkConfig_t* config;
+    pthread_t deviceMonitor;
+    pthread_t graphMonitor;
+    pthread_t executor;
+
+    // guards the job queue and memoryUsed
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int stop;
+    int busy;
+    fwJob_t* jobsHead;
+    fwJob_t* jobsTail;
+    uint32_t memoryUsed;
+
+    // only touched by the graph monitor
+    fwGraph_t graphs[FW_MAX_GRAPHS];
+    fwFifo_t fifos[FW_MAX_FIFOS];
+} firmware_t;
+
+static int parseGraphFile(const uint8_t* data, uint32_t length, fwGraph_t* graph)
+{
+    blobHeader_t header;
+    blobStageSectionHeader_t stages;
+
+    if (length < sizeof(blobElfHeader_t) + sizeof(header))
+        return -1;
+    memcpy(&header, data + sizeof(blobElfHeader_t), sizeof(header));
+    if (header.magic_number != BLOB_MAGIC_NUMBER ||
+        header.stage_section_offset > length - sizeof(stages))
+        return -1;
+    memcpy(&stages, data + header.stage_section_offset, sizeof(stages));
+
+    graph->stages = stages.stage_count;
+    graph->inputSize = stages.input_size;
+    graph->outputSize = stages.output_size;
+    graph->fileSize = length;
+    return 0;
+}
+
+static fwGraph_t* findGraph(firmware_t* fw, uint32_t id)
+{
+    int i;
+    for (i = 0; i < FW_MAX_GRAPHS; i++) {
+        if (fw->graphs[i].used && fw->graphs[i].id == id)
+            return &fw->graphs[i];
+    }
+    return NULL;
+}
+
+static fwFifo_t* findFifo(firmware_t* fw, uint32_t id)
+{
+    int i;
+    for (i = 0; i < FW_MAX_FIFOS; i++) {
+        if (fw->fifos[i].used && fw->fifos[i].id == id)
+            return &fw->fifos[i];
+    }
+    return NULL;
+}
+
+// Waits until every queued inference has run, so that the graphs and fifos
+// they use can go away.
+static void waitIdle(firmware_t* fw)
+{
+    pthread_mutex_lock(&fw->lock);
+    while (!fw->stop && (fw->jobsHead || fw->busy))
+        pthread_cond_wait(&fw->cond, &fw->lock);
+    pthread_mutex_unlock(&fw->lock);
+}
+
+static struct tensorDescriptor_t tensorOfSize(uint32_t size)
+{
+    struct tensorDescriptor_t desc;
+    desc.n = 1;
+    desc.c = 1;
+    desc.h = 1;
+    desc.w = size / sizeof(uint16_t);
+    desc.totalSize = size;
+    return desc;
+}
+
+static int32_t graphAllocate(firmware_t* fw, const graphCommand_t* cmd)
+{
+    char streamName[16];
+    fwGraph_t graph;
+    fwGraph_t* slot = NULL;
+    int i;
+
+    strncpy(streamName, cmd->streamName, sizeof(streamName));
+    streamName[sizeof(streamName) - 1] = '\0';
+    loopbackPacket_t* file = loopbackDeviceRead(fw->dev, streamName);
+    if (file == NULL)
+        return -1;
+
+    memset(&graph, 0, sizeof(graph));
+    int rc = parseGraphFile(file->data, file->length, &graph);
+    loopbackDeviceRelease(fw->dev, streamName, file);
+    if (rc)
+        mvLog(MVLOG_WARN, "graph %u is not a graph file\n", cmd->id);
+
+    for (i = 0; i < FW_MAX_GRAPHS && rc == 0; i++) {
+        if (!fw->graphs[i].used) {
+            slot = &fw->graphs[i];
+            break;
+        }
+    }
+    if (rc == 0 && slot == NULL) {
+        mvLog(MVLOG_WARN, "no room for graph %u\n", cmd->id);
+        rc = -1;
+    }
+
+    // the host reads the three descriptors before it checks the status
+    struct tensorDescriptor_t input = tensorOfSize(graph.inputSize);
+    struct tensorDescriptor_t output = tensorOfSize(graph.outputSize);
+    loopbackDeviceWrite(fw->dev, streamName, &input, sizeof(input));
+    loopbackDeviceWrite(fw->dev, streamName, &output, sizeof(output));
+    loopbackDeviceWrite(fw->dev, streamName, &graph.stages, sizeof(graph.stages));
+    if (rc)
+        return rc;
+
+    graph.used = 1;
+    graph.id = cmd->id;
+    *slot = graph;
+    pthread_mutex_lock(&fw->lock);
+    fw->memoryUsed += graph.fileSize;
+    pthread_mutex_unlock(&fw->lock);
+    return 0;
+}
+
+static int32_t graphTrigger(firmware_t* fw, const graphCommand_t* cmd)
+{
+    fwGraph_t* graph = findGraph(fw, cmd->id);
+    fwFifo_t* input = findFifo(fw, cmd->buffId1);
+    fwFifo_t* output = findFifo(fw, cmd->buffId2);
+    if (graph == NULL || input == NULL || output == NULL) {
+        mvLog(MVLOG_WARN, "trigger of unknown graph %u or fifos %u %u\n",
+              cmd->id, cmd->buffId1, cmd->buffId2);
+        return -1;
+    }
+
+    fwJob_t* job = calloc(1, sizeof(*job));
+    if (job == NULL)
+        return -1;
+    job->graphId = graph->id;
+    memcpy(job->input, input->name, sizeof(job->input));
+    memcpy(job->output, output->name, sizeof(job->output));
+    job->outputSize = output->desc.totalSize;
+    job->outputElements = output->elemCnt;
+
+    pthread_mutex_lock(&fw->lock);
+    if (fw->jobsTail)
+        fw->jobsTail->next = job;
+    else
+        fw->jobsHead = job;
+    fw->jobsTail = job;
+    pthread_cond_broadcast(&fw->cond);
+    pthread_mutex_unlock(&fw->lock);
+    return 0;
+}
+
+static int32_t graphCommand(firmware_t* fw, const graphCommand_t* cmd)
+{
+    fwGraph_t* graph;
+
+    switch (cmd->type) {
+    case GRAPH_ALLOCATE_CMD:
+        return graphAllocate(fw, cmd);
+    case GRAPH_DEALLOCATE_CMD:
+        graph = findGraph(fw, cmd->id);
+        if (graph == NULL)
+            return -1;
+        waitIdle(fw);
+        pthread_mutex_lock(&fw->lock);
+        fw->memoryUsed -= graph->fileSize;
+        pthread_mutex_unlock(&fw->lock);
+        graph->used = 0;
+        return 0;
+    case GRAPH_TRIGGER_CMD:
+        return graphTrigger(fw, cmd);
+    default:
+        return -1;
+    }
+}
+
+static int32_t bufferCommand(firmware_t* fw, const bufferCommand_t* cmd)
+{
+    fwFifo_t* fifo;
+    int i;
+
+    switch (cmd->type) {
+    case BUFFER_ALLOCATE_CMD:
+        for (i = 0; i < FW_MAX_FIFOS; i++) {
+            fifo = &fw->fifos[i];
+            if (!fifo->used) {
+                fifo->used = 1;
+                fifo->id = cmd->id;
+                memcpy(fifo->name, cmd->name, sizeof(fifo->name));
+                fifo->name[sizeof(fifo->name) - 1] = '\0';
+                fifo->desc = cmd->desc;
+                fifo->elemCnt = cmd->elemCnt;
+                return 0;
+            }
+        }
+        mvLog(MVLOG_WARN, "no room for fifo %u\n", cmd->id);
+        return -1;
+    case BUFFER_DEALLOCATE_CMD:
+        fifo = findFifo(fw, cmd->id);
+        if (fifo == NULL)
+            return -1;
+        waitIdle(fw);
+        // also drops the message ncFifoDelete writes to stop the fifo
+        loopbackDeviceDrain(fw->dev, fifo->name);
+        fifo->used = 0;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static int32_t graphGetOption(firmware_t* fw, const graphOptionSet_t* cmd)
+{
+    fwGraph_t* graph = findGraph(fw, cmd->id);
+    if (graph == NULL)
+        return -1;
+
+    switch (cmd->type.c0) {
+    case CLASS0_TIMING_DATA: {
+        float* timing = calloc(graph->stages ? graph->stages : 1, sizeof(float));
+        uint32_t i;
+        if (timing == NULL)
+            return -1;
+        for (i = 0; i < graph->stages; i++)
+            timing[i] = fw->config->inferenceUs / 1000.0f / graph->stages;
+        loopbackDeviceWrite(fw->dev, "graphMonitor", timing, graph->stages * sizeof(float));
+        free(timing);
+        return 0;
+    }
+    case CLASS0_DEBUG_DATA: {
+        char debug[FW_DEBUG_BUFFER_SIZE] = "loopback";
+        loopbackDeviceWrite(fw->dev, "graphMonitor", debug, sizeof(debug));
+        return 0;
+    }
+    default:
+        return -1;
+    }
+}
+
+static void* graphMonitor(void* ctx)
+{
+    firmware_t* fw = (firmware_t*)ctx;
+    loopbackPacket_t* packet;
+
+    while ((packet = loopbackDeviceRead(fw->dev, "graphMonitor")) != NULL) {
+        graphMonCommand_t cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        memcpy(&cmd, packet->data, packet->length < sizeof(cmd) ? packet->length : sizeof(cmd));
+        loopbackDeviceRelease(fw->dev, "graphMonitor", packet);
+
+        int32_t status;
+        switch (cmd.cmdClass) {
+        case GRAPH_MON_CLASS_GRAPH_CMD:
+            status = graphCommand(fw, &cmd.cmd.graphCmd);
+            break;
+        case GRAPH_MON_CLASS_BUFFER_CMD:
+            status = bufferCommand(fw, &cmd.cmd.buffCmd);
+            break;
+        case GRAPH_MON_CLASS_GET_CLASS0:
+            status = graphGetOption(fw, &cmd.cmd.optionCmd);
+            break;
+        default:
+            mvLog(MVLOG_WARN, "unsupported graph monitor class %d\n", (int)cmd.cmdClass);
+            status = -1;
+            break;
+        }
+        loopbackDeviceWrite(fw->dev, "graphMonitor", &status, sizeof(status));
+    }
+    return NULL;
+}
+
+static void* deviceMonitor(void* ctx)
+{
+    firmware_t* fw = (firmware_t*)ctx;
+    loopbackPacket_t* packet;
+
+    while ((packet = loopbackDeviceRead(fw->dev, "deviceMonitor")) != NULL) {
+        deviceCommand_t cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        memcpy(&cmd, packet->data, packet->length < sizeof(cmd) ? packet->length : sizeof(cmd));
+        loopbackDeviceRelease(fw->dev, "deviceMonitor", packet);
+
+        // the other classes only set options and get no reply
+        if (cmd.optionClass != NC_OPTION_CLASS0)
+            continue;
+
+        switch (cmd.type.c0) {
+        case CLASS0_DEVICE_CAPABILITIES: {
+            deviceCapabilities_t caps;
+            memset(&caps, 0, sizeof(caps));
+            caps.max_graphs = FW_MAX_GRAPHS;
+            caps.max_fifos = FW_MAX_FIFOS;
+            caps.max_memory = FW_MEMORY_SIZE;
+            caps.max_device_opt_class = NC_OPTION_CLASS2;
+            caps.max_graph_opt_class = NC_OPTION_CLASS1;
+            caps.max_executors = FW_MAX_EXECUTORS;
+            loopbackDeviceWrite(fw->dev, "deviceMonitor", &caps, sizeof(caps));
+            break;
+        }
+        case CLASS0_OPT_LIST: {
+            char* list = calloc(1, FW_OPTIMISATION_LIST_SIZE);
+            if (list) {
+                loopbackDeviceWrite(fw->dev, "deviceMonitor", list, FW_OPTIMISATION_LIST_SIZE);
+                free(list);
+            }
+            break;
+        }
+        case CLASS0_THERMAL_STATS: {
+            char stats[FW_THERMAL_STATS_SIZE];
+            memset(stats, 0, sizeof(stats));
+            loopbackDeviceWrite(fw->dev, "deviceMonitor", stats, sizeof(stats));
+            break;
+        }
+        case CLASS0_DEVICE_USED_MEMORY: {
+            pthread_mutex_lock(&fw->lock);
+            uint32_t used = fw->memoryUsed;
+            pthread_mutex_unlock(&fw->lock);
+            loopbackDeviceWrite(fw->dev, "deviceMonitor", &used, sizeof(used));
+            break;
+        }
+        default:
+            mvLog(MVLOG_WARN, "unsupported device option %d\n", (int)cmd.type.c0);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void runJob(firmware_t* fw, const fwJob_t* job)
+{
+    loopbackPacket_t* input = loopbackDeviceRead(fw->dev, job->input);
+    if (input == NULL)
+        return;
+
+    uint8_t* output = calloc(1, job->outputSize ? job->outputSize : 1);
+    if (output == NULL) {
+        loopbackDeviceRelease(fw->dev, job->input, input);
+        return;
+    }
+    if (fw->config->inferenceUs)
+        usleep(fw->config->inferenceUs);
+    if (fw->config->infer) {
+        fw->config->infer(fw->config->inferCtx, job->graphId,
+                          input->data, input->length, output, job->outputSize);
+    } else {
+        memcpy(output, input->data,
+               input->length < job->outputSize ? input->length : job->outputSize);
+    }
+    loopbackDeviceRelease(fw->dev, job->input, input);
+    if (loopbackDeviceWaitReleased(fw->dev, job->output, job->outputElements) == 0)
+        loopbackDeviceWrite(fw->dev, job->output, output, job->outputSize);
+    free(output);
+}
+
+static void* executor(void* ctx)
+{
+    firmware_t* fw = (firmware_t*)ctx;
+
+    pthread_mutex_lock(&fw->lock);
+    while (!fw->stop) {
+        fwJob_t* job = fw->jobsHead;
+        if (job == NULL) {
+            pthread_cond_wait(&fw->cond, &fw->lock);
+            continue;
+        }
+        fw->jobsHead = job->next;
+        if (fw->jobsHead == NULL)
+            fw->jobsTail = NULL;
+        fw->busy = 1;
+        pthread_mutex_unlock(&fw->lock);
+
+        runJob(fw, job);
+        free(job);
+
+        pthread_mutex_lock(&fw->lock);
+        fw->busy = 0;
+        pthread_cond_broadcast(&fw->cond);
+    }
+    pthread_mutex_unlock(&fw->lock);
+    return NULL;
+}
+
+void* loopbackFirmwareStart(loopbackDevice_t* dev)
+{
+    firmware_t* fw = calloc(1, sizeof(*fw));
+    if (fw == NULL) {
+        mvLog(MVLOG_FATAL, "out of memory\n");
+        abort();
+    }
+    fw->dev = dev;
+    fw->config = loopbackDeviceConfig(dev);
+    pthread_mutex_init(&fw->lock, NULL);
+    pthread_cond_init(&fw->cond, NULL);
+
+    if (pthread_create(&fw->deviceMonitor, NULL, deviceMonitor, fw) ||
+        pthread_create(&fw->graphMonitor, NULL, graphMonitor, fw) ||
+        pthread_create(&fw->executor, NULL, executor, fw)) {
+        mvLog(MVLOG_FATAL, "Thread creation failed\n");
+        abort();
+    }
+    return fw;
+}
+
+void loopbackFirmwareStop(void* firmware)
+{
+    firmware_t* fw = (firmware_t*)firmware;
+    if (fw == NULL)
+        return;
+
+    pthread_mutex_lock(&fw->lock);
+    fw->stop = 1;
+    pthread_cond_broadcast(&fw->cond);
+    pthread_mutex_unlock(&fw->lock);
+
+    pthread_join(fw->deviceMonitor, NULL);
+    pthread_join(fw->graphMonitor, NULL);
+    pthread_join(fw->executor, NULL);
+
+    while (fw->jobsHead) {
+        fwJob_t* job = fw->jobsHead;
+        fw->jobsHead = job->next;
+        free(job);
+    }
+    pthread_cond_destroy(&fw->cond);
+    pthread_mutex_destroy(&fw->lock);
+    free(fw);
+}
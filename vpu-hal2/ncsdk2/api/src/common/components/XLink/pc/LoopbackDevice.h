@@ -0,0 +1,75 @@
+/*
+* Copyright 2017 Intel Corporation.
+* The source code, information and material ("Material") contained herein is
+* owned by Intel Corporation or its suppliers or licensors, and title to such
+* Material remains with Intel Corporation or its suppliers or licensors.
+* The Material contains proprietary information of Intel or its suppliers and
+* licensors. The Material is protected by worldwide copyright laws and treaty
+* provisions.
+* No part of the Material may be used, copied, reproduced, modified, published,
+* uploaded, posted, transmitted, distributed or disclosed in any way without
+* Intel's prior express written permission. No license under any patent,
+* copyright or other intellectual property rights in the Material is granted to
+* or conferred upon you, either expressly, by implication, inducement, estoppel
+* or otherwise.
+* Any license under such intellectual property rights must be express and
+* approved by Intel in writing.
+*/
+
+///
+/// @brief     Device side of the loopback XLink backend
+///
+/// The link half (LoopbackLinkPlatform.c) terminates the XLink event
+/// protocol and queues the packets the host writes per stream. The firmware
+/// half (LoopbackDevice.c) plays the mvnc firmware on top of these streams,
+/// the same way the real firmware uses XLinkReadData/XLinkWriteData.
+///
+#ifndef _XLINK_LOOPBACKDEVICE_H
+#define _XLINK_LOOPBACKDEVICE_H
+#include <stdint.h>
+#include "LoopbackLinkPlatform.h"
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct loopbackDevice_t loopbackDevice_t;
+
+typedef struct loopbackPacket_t {
+    struct loopbackPacket_t* next;
+    uint8_t* data;
+    uint32_t length;
+} loopbackPacket_t;
+
+/*
+Implemented by the link half. Streams are addressed by name, as the host
+names them in XLinkOpenStream.
+*/
+// Blocks until the host writes to the stream. Returns NULL once the link is down.
+loopbackPacket_t* loopbackDeviceRead(loopbackDevice_t* dev, const char* streamName);
+// Frees the packet and lets the host reuse its space in the stream.
+void loopbackDeviceRelease(loopbackDevice_t* dev, const char* streamName,
+                           loopbackPacket_t* packet);
+// Releases every packet queued on the stream.
+void loopbackDeviceDrain(loopbackDevice_t* dev, const char* streamName);
+int loopbackDeviceWrite(loopbackDevice_t* dev, const char* streamName,
+                        const void* data, uint32_t size);
+// Blocks while the host holds maxUnreleased or more packets of the stream.
+int loopbackDeviceWaitReleased(loopbackDevice_t* dev, const char* streamName,
+                               uint32_t maxUnreleased);
+const loopbackLinkConfig_t* loopbackDeviceConfig(loopbackDevice_t* dev);
+
+/*
+Implemented by the firmware half. Start runs when the host connects, stop
+after the link is down and every loopbackDeviceRead has returned NULL.
+*/
+void* loopbackFirmwareStart(loopbackDevice_t* dev);
+void loopbackFirmwareStop(void* firmware);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/* end of include file */
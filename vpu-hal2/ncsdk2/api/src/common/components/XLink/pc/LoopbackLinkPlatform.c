@@ -0,0 +1,579 @@
+/*
+* Copyright 2017 Intel Corporation.
+* The source code, information and material ("Material") contained herein is
+* owned by Intel Corporation or its suppliers or licensors, and title to such
+* Material remains with Intel Corporation or its suppliers or licensors.
+* The Material contains proprietary information of Intel or its suppliers and
+* licensors. The Material is protected by worldwide copyright laws and treaty
+* provisions.
+* No part of the Material may be used, copied, reproduced, modified, published,
+* uploaded, posted, transmitted, distributed or disclosed in any way without
+* Intel's prior express written permission. No license under any patent,
+* copyright or other intellectual property rights in the Material is granted to
+* or conferred upon you, either expressly, by implication, inducement, estoppel
+* or otherwise.
+* Any license under such intellectual property rights must be express and
+* approved by Intel in writing.
+*/
+
+///
+/// @brief     In-process loopback backend of the XLink platform layer
+///
+
+#include "LoopbackLinkPlatform.h"
+#include "LoopbackDevice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "UsbLinkPlatform.h"
+#define _USBLINK_ENABLE_PRIVATE_INCLUDE_
+#include "XLinkPrivateDefines.h"
+#define MVLOG_UNIT_NAME xLinkLoopback
+#include "mvLog.h"
+
+// Unbooted devices carry the product name after the dash, booted ones
+// don't, like the names usb_find_device reports.
+#define LOOPBACK_NAME_PREFIX "lo."
+#define LOOPBACK_PRODUCT_NAME "ma2450"
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    streamId_t id;
+    loopbackPacket_t* head;
+    loopbackPacket_t* tail;
+    // packets written to the host and not released by it yet
+    uint32_t unreleased;
+} loopbackStream_t;
+
+struct loopbackDevice_t {
+    int booted;
+    int connected;
+    int hostFd;
+    int deviceFd;
+    pthread_t reader;
+    void* firmware;
+
+    // guards the streams and linkDown
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int linkDown;
+    streamId_t nextStreamId;
+    loopbackStream_t streams[USB_LINK_MAX_STREAMS];
+
+    // events from the device are written one at a time
+    pthread_mutex_t sendLock;
+    eventId_t nextEventId;
+};
+
+static loopbackLinkConfig_t config;
+static int configured = 0;
+static int initialized = 0;
+static pthread_mutex_t devicesLock = PTHREAD_MUTEX_INITIALIZER;
+static loopbackDevice_t devices[MAX_LINKS];
+
+static uint32_t getEnvValue(const char* name, uint32_t defaultValue)
+{
+    const char* value = getenv(name);
+    if (value == NULL || *value == '\0')
+        return defaultValue;
+    return (uint32_t)strtoul(value, NULL, 10);
+}
+
+// Time the transfer of size bytes occupies the wire, spent by the sender.
+static void wireDelay(uint32_t size)
+{
+    uint64_t ns = (uint64_t)config.latencyUs * 1000;
+    if (config.bandwidthMBps > 0)
+        ns += (uint64_t)(size * 1000.0 / config.bandwidthMBps);
+    if (ns == 0)
+        return;
+
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+static int readAll(int fd, void* data, uint32_t size)
+{
+    uint8_t* p = (uint8_t*)data;
+    while (size > 0) {
+        ssize_t rc = recv(fd, p, size, 0);
+        if (rc < 0 && errno == EINTR)
+            continue;
+        if (rc <= 0)
+            return -1;
+        p += rc;
+        size -= rc;
+    }
+    return 0;
+}
+
+static int writeAll(int fd, const void* data, uint32_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    wireDelay(size);
+    while (size > 0) {
+        // the peer may already be gone, which must not raise SIGPIPE
+        ssize_t rc = send(fd, p, size, MSG_NOSIGNAL);
+        if (rc < 0 && errno == EINTR)
+            continue;
+        if (rc <= 0)
+            return -1;
+        p += rc;
+        size -= rc;
+    }
+    return 0;
+}
+
+static loopbackDevice_t* getDeviceByName(const char* name)
+{
+    int index;
+    if (name == NULL ||
+        sscanf(name, LOOPBACK_NAME_PREFIX "%d-", &index) != 1 ||
+        index < 0 || index >= config.devices)
+        return NULL;
+    return &devices[index];
+}
+
+// Must be called with dev->lock held.
+static loopbackStream_t* getStreamByName(loopbackDevice_t* dev, const char* name)
+{
+    int i;
+    for (i = 0; i < USB_LINK_MAX_STREAMS; i++) {
+        if (dev->streams[i].id != INVALID_STREAM_ID &&
+            strncmp(dev->streams[i].name, name, MAX_NAME_LENGTH) == 0)
+            return &dev->streams[i];
+    }
+    return NULL;
+}
+
+// Must be called with dev->lock held.
+static loopbackStream_t* getStreamById(loopbackDevice_t* dev, streamId_t id)
+{
+    int i;
+    for (i = 0; i < USB_LINK_MAX_STREAMS; i++) {
+        if (dev->streams[i].id == id)
+            return &dev->streams[i];
+    }
+    return NULL;
+}
+
+static void freePackets(loopbackStream_t* stream)
+{
+    while (stream->head) {
+        loopbackPacket_t* packet = stream->head;
+        stream->head = packet->next;
+        free(packet->data);
+        free(packet);
+    }
+    stream->tail = NULL;
+}
+
+static int sendEvent(loopbackDevice_t* dev, xLinkEventHeader_t* header, const void* data)
+{
+    pthread_mutex_lock(&dev->sendLock);
+    if (header->type < USB_REQUEST_LAST)
+        header->id = dev->nextEventId++;
+    int rc = writeAll(dev->deviceFd, header, sizeof(*header));
+    if (rc == 0 && header->type == USB_WRITE_REQ)
+        rc = writeAll(dev->deviceFd, data, header->size);
+    pthread_mutex_unlock(&dev->sendLock);
+    return rc;
+}
+
+static streamId_t createStream(loopbackDevice_t* dev, const char* name)
+{
+    streamId_t id = INVALID_STREAM_ID;
+    int i;
+
+    pthread_mutex_lock(&dev->lock);
+    loopbackStream_t* stream = getStreamByName(dev, name);
+    if (stream == NULL) {
+        for (i = 0; i < USB_LINK_MAX_STREAMS; i++) {
+            if (dev->streams[i].id == INVALID_STREAM_ID) {
+                stream = &dev->streams[i];
+                strncpy(stream->name, name, MAX_NAME_LENGTH);
+                stream->id = dev->nextStreamId++;
+                break;
+            }
+        }
+    }
+    if (stream)
+        id = stream->id;
+    pthread_mutex_unlock(&dev->lock);
+    return id;
+}
+
+static int receivePacket(loopbackDevice_t* dev, const xLinkEventHeader_t* header)
+{
+    loopbackPacket_t* packet = calloc(1, sizeof(*packet));
+    uint8_t* data = malloc(header->size ? header->size : 1);
+    if (packet == NULL || data == NULL) {
+        mvLog(MVLOG_FATAL, "out of memory\n");
+        ASSERT_X_LINK(0);
+    }
+    if (readAll(dev->deviceFd, data, header->size)) {
+        free(data);
+        free(packet);
+        return -1;
+    }
+    packet->data = data;
+    packet->length = header->size;
+
+    pthread_mutex_lock(&dev->lock);
+    loopbackStream_t* stream = getStreamById(dev, header->streamId);
+    if (stream == NULL) {
+        mvLog(MVLOG_WARN, "write to unknown stream %d dropped\n", (int)header->streamId);
+        free(data);
+        free(packet);
+    } else {
+        if (stream->tail)
+            stream->tail->next = packet;
+        else
+            stream->head = packet;
+        stream->tail = packet;
+        pthread_cond_broadcast(&dev->cond);
+    }
+    pthread_mutex_unlock(&dev->lock);
+    return 0;
+}
+
+// Remote end of the link: answers the XLink requests of the host and
+// queues the data it writes for the firmware.
+static void* deviceReader(void* ctx)
+{
+    loopbackDevice_t* dev = (loopbackDevice_t*)ctx;
+    loopbackStream_t* stream;
+    xLinkEventHeader_t event;
+
+    while (readAll(dev->deviceFd, &event, sizeof(event)) == 0) {
+        xLinkEventHeader_t response;
+        memset(&response, 0, sizeof(response));
+        response.id = event.id;
+        response.streamId = event.streamId;
+        response.flags.bitField.ack = 1;
+
+        switch (event.type) {
+        case USB_WRITE_REQ:
+            if (receivePacket(dev, &event))
+                goto link_down;
+            response.type = USB_WRITE_RESP;
+            response.size = event.size;
+            break;
+        case USB_READ_REL_REQ:
+            response.type = USB_READ_REL_RESP;
+            pthread_mutex_lock(&dev->lock);
+            stream = getStreamById(dev, event.streamId);
+            if (stream && stream->unreleased)
+                stream->unreleased--;
+            pthread_cond_broadcast(&dev->cond);
+            pthread_mutex_unlock(&dev->lock);
+            break;
+        case USB_CREATE_STREAM_REQ:
+            response.type = USB_CREATE_STREAM_RESP;
+            response.streamId = createStream(dev, event.streamName);
+            if (response.streamId == INVALID_STREAM_ID) {
+                mvLog(MVLOG_ERROR, "no more streams for %s\n", event.streamName);
+                response.flags.bitField.ack = 0;
+                response.flags.bitField.nack = 1;
+            }
+            strncpy(response.streamName, event.streamName, MAX_NAME_LENGTH);
+            response.size = event.size;
+            break;
+        case USB_CLOSE_STREAM_REQ:
+            response.type = USB_CLOSE_STREAM_RESP;
+            break;
+        case USB_PING_REQ:
+            response.type = USB_PING_RESP;
+            break;
+        case USB_RESET_REQ:
+            response.type = USB_RESET_RESP;
+            sendEvent(dev, &response, NULL);
+            goto link_down;
+        default:
+            // responses to the requests of the device need no action
+            continue;
+        }
+        if (sendEvent(dev, &response, NULL))
+            break;
+    }
+
+link_down:
+    pthread_mutex_lock(&dev->lock);
+    dev->linkDown = 1;
+    pthread_cond_broadcast(&dev->cond);
+    pthread_mutex_unlock(&dev->lock);
+    // the host reader sees the end of the stream, as after a USB reset
+    shutdown(dev->deviceFd, SHUT_RDWR);
+    return NULL;
+}
+
+loopbackPacket_t* loopbackDeviceRead(loopbackDevice_t* dev, const char* streamName)
+{
+    loopbackPacket_t* packet = NULL;
+
+    pthread_mutex_lock(&dev->lock);
+    while (!dev->linkDown) {
+        loopbackStream_t* stream = getStreamByName(dev, streamName);
+        if (stream && stream->head) {
+            packet = stream->head;
+            stream->head = packet->next;
+            if (stream->head == NULL)
+                stream->tail = NULL;
+            packet->next = NULL;
+            break;
+        }
+        pthread_cond_wait(&dev->cond, &dev->lock);
+    }
+    pthread_mutex_unlock(&dev->lock);
+    return packet;
+}
+
+void loopbackDeviceRelease(loopbackDevice_t* dev, const char* streamName,
+                           loopbackPacket_t* packet)
+{
+    xLinkEventHeader_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = USB_READ_REL_REQ;
+    event.size = packet->length;
+
+    pthread_mutex_lock(&dev->lock);
+    loopbackStream_t* stream = getStreamByName(dev, streamName);
+    event.streamId = stream ? stream->id : INVALID_STREAM_ID;
+    pthread_mutex_unlock(&dev->lock);
+
+    if (event.streamId != INVALID_STREAM_ID)
+        sendEvent(dev, &event, NULL);
+    free(packet->data);
+    free(packet);
+}
+
+void loopbackDeviceDrain(loopbackDevice_t* dev, const char* streamName)
+{
+    loopbackPacket_t* packets = NULL;
+
+    pthread_mutex_lock(&dev->lock);
+    loopbackStream_t* stream = getStreamByName(dev, streamName);
+    if (stream) {
+        packets = stream->head;
+        stream->head = NULL;
+        stream->tail = NULL;
+    }
+    pthread_mutex_unlock(&dev->lock);
+
+    while (packets) {
+        loopbackPacket_t* next = packets->next;
+        loopbackDeviceRelease(dev, streamName, packets);
+        packets = next;
+    }
+}
+
+int loopbackDeviceWrite(loopbackDevice_t* dev, const char* streamName,
+                        const void* data, uint32_t size)
+{
+    xLinkEventHeader_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = USB_WRITE_REQ;
+    event.size = size;
+    strncpy(event.streamName, streamName, MAX_NAME_LENGTH);
+
+    pthread_mutex_lock(&dev->lock);
+    loopbackStream_t* stream = getStreamByName(dev, streamName);
+    event.streamId = stream ? stream->id : INVALID_STREAM_ID;
+    if (stream)
+        stream->unreleased++;
+    pthread_mutex_unlock(&dev->lock);
+
+    if (event.streamId == INVALID_STREAM_ID) {
+        mvLog(MVLOG_ERROR, "stream %s is not open\n", streamName);
+        return -1;
+    }
+    return sendEvent(dev, &event, data);
+}
+
+int loopbackDeviceWaitReleased(loopbackDevice_t* dev, const char* streamName,
+                               uint32_t maxUnreleased)
+{
+    pthread_mutex_lock(&dev->lock);
+    for (;;) {
+        loopbackStream_t* stream = getStreamByName(dev, streamName);
+        if (dev->linkDown || stream == NULL || maxUnreleased == 0 ||
+            stream->unreleased < maxUnreleased)
+            break;
+        pthread_cond_wait(&dev->cond, &dev->lock);
+    }
+    int rc = dev->linkDown ? -1 : 0;
+    pthread_mutex_unlock(&dev->lock);
+    return rc;
+}
+
+const loopbackLinkConfig_t* loopbackDeviceConfig(loopbackDevice_t* dev)
+{
+    (void)dev;
+    return &config;
+}
+
+void LoopbackLinkConfigure(const loopbackLinkConfig_t* newConfig)
+{
+    config = *newConfig;
+    configured = 1;
+}
+
+int LoopbackLinkEnabled(void)
+{
+    return config.devices > 0;
+}
+
+int LoopbackLinkPlatformInit(void)
+{
+    int i;
+
+    pthread_mutex_lock(&devicesLock);
+    if (!initialized) {
+        if (!configured) {
+            config.devices = getEnvValue("XLINK_LOOPBACK_DEVICES", 0);
+            config.bandwidthMBps = getEnvValue("XLINK_LOOPBACK_BANDWIDTH", 0);
+            config.latencyUs = getEnvValue("XLINK_LOOPBACK_LATENCY_US", 0);
+            config.inferenceUs = getEnvValue("XLINK_LOOPBACK_INFER_US", 0);
+        }
+        if (config.devices > MAX_LINKS)
+            config.devices = MAX_LINKS;
+
+        for (i = 0; i < MAX_LINKS; i++) {
+            pthread_mutex_init(&devices[i].lock, NULL);
+            pthread_cond_init(&devices[i].cond, NULL);
+            pthread_mutex_init(&devices[i].sendLock, NULL);
+            devices[i].hostFd = -1;
+            devices[i].deviceFd = -1;
+        }
+        initialized = 1;
+        if (config.devices > 0)
+            mvLog(MVLOG_INFO, "%d loopback devices, %.1f MB/s, %u us latency\n",
+                  config.devices, config.bandwidthMBps, config.latencyUs);
+    }
+    pthread_mutex_unlock(&devicesLock);
+    return 0;
+}
+
+int LoopbackLinkWrite(void* fd, void* data, int size, unsigned int timeout)
+{
+    loopbackDevice_t* dev = (loopbackDevice_t*)fd;
+    (void)timeout;
+    return writeAll(dev->hostFd, data, size);
+}
+
+int LoopbackLinkRead(void* fd, void* data, int size, unsigned int timeout)
+{
+    loopbackDevice_t* dev = (loopbackDevice_t*)fd;
+    (void)timeout;
+    return readAll(dev->hostFd, data, size);
+}
+
+int LoopbackLinkPlatformGetDeviceName(int index, char* name, int nameSize)
+{
+    if (index < 0 || index >= config.devices)
+        return USB_LINK_PLATFORM_DEVICE_NOT_FOUND;
+
+    pthread_mutex_lock(&devicesLock);
+    snprintf(name, nameSize, LOOPBACK_NAME_PREFIX "%d-%s", index,
+             devices[index].booted ? "" : LOOPBACK_PRODUCT_NAME);
+    pthread_mutex_unlock(&devicesLock);
+    return USB_LINK_PLATFORM_SUCCESS;
+}
+
+int LoopbackLinkPlatformBootRemote(const char* deviceName, const char* binaryPath)
+{
+    // there is no firmware to load, the simulated one starts on connect
+    (void)binaryPath;
+    loopbackDevice_t* dev = getDeviceByName(deviceName);
+    if (dev == NULL)
+        return -1;
+
+    int rc = 0;
+    pthread_mutex_lock(&devicesLock);
+    if (dev->booted)
+        rc = -1;
+    dev->booted = 1;
+    pthread_mutex_unlock(&devicesLock);
+    return rc;
+}
+
+int LoopbackLinkPlatformConnect(const char* devPathRead, const char* devPathWrite, void** fd)
+{
+    (void)devPathRead;
+    loopbackDevice_t* dev = getDeviceByName(devPathWrite);
+    if (dev == NULL)
+        return -1;
+
+    pthread_mutex_lock(&devicesLock);
+    if (!dev->booted || dev->connected) {
+        pthread_mutex_unlock(&devicesLock);
+        return -1;
+    }
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+        pthread_mutex_unlock(&devicesLock);
+        mvLog(MVLOG_ERROR, "socketpair failed %d\n", errno);
+        return -1;
+    }
+    dev->hostFd = fds[0];
+    dev->deviceFd = fds[1];
+    dev->linkDown = 0;
+    dev->nextStreamId = 0;
+    dev->nextEventId = 0;
+    int i;
+    for (i = 0; i < USB_LINK_MAX_STREAMS; i++) {
+        memset(&dev->streams[i], 0, sizeof(dev->streams[i]));
+        dev->streams[i].id = INVALID_STREAM_ID;
+    }
+    dev->connected = 1;
+    pthread_mutex_unlock(&devicesLock);
+
+    if (pthread_create(&dev->reader, NULL, deviceReader, dev)) {
+        mvLog(MVLOG_ERROR, "Thread creation failed\n");
+        ASSERT_X_LINK(0);
+    }
+    dev->firmware = loopbackFirmwareStart(dev);
+    *fd = dev;
+    return 0;
+}
+
+int LoopbackLinkPlatformResetRemote(void* fd)
+{
+    loopbackDevice_t* dev = (loopbackDevice_t*)fd;
+    int i;
+
+    pthread_mutex_lock(&devicesLock);
+    if (dev == NULL || !dev->connected) {
+        pthread_mutex_unlock(&devicesLock);
+        return -1;
+    }
+    pthread_mutex_unlock(&devicesLock);
+
+    // ends the device reader if the device did not go down by itself
+    shutdown(dev->hostFd, SHUT_RDWR);
+    pthread_join(dev->reader, NULL);
+    loopbackFirmwareStop(dev->firmware);
+    dev->firmware = NULL;
+
+    pthread_mutex_lock(&devicesLock);
+    close(dev->hostFd);
+    close(dev->deviceFd);
+    dev->hostFd = -1;
+    dev->deviceFd = -1;
+    for (i = 0; i < USB_LINK_MAX_STREAMS; i++)
+        freePackets(&dev->streams[i]);
+    dev->connected = 0;
+    dev->booted = 0;
+    pthread_mutex_unlock(&devicesLock);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+* Copyright 2017 Intel Corporation.
+* The source code, information and material ("Material") contained herein is
+* owned by Intel Corporation or its suppliers or licensors, and title to such
+* Material remains with Intel Corporation or its suppliers or licensors.
+* The Material contains proprietary information of Intel or its suppliers and
+* licensors. The Material is protected by worldwide copyright laws and treaty
+* provisions.
+* No part of the Material may be used, copied, reproduced, modified, published,
+* uploaded, posted, transmitted, distributed or disclosed in any way without
+* Intel's prior express written permission. No license under any patent,
+* copyright or other intellectual property rights in the Material is granted to
+* or conferred upon you, either expressly, by implication, inducement, estoppel
+* or otherwise.
+* Any license under such intellectual property rights must be express and
+* approved by Intel in writing.
+*/
+
+///
+/// @brief     In-process loopback backend of the XLink platform layer
+///
+/// When enabled, UsbLinkPlatform.cpp forwards every platform call here
+/// instead of libusb. Each enumerated device is a socketpair whose far end
+/// is served by a simulated Myriad that speaks the XLink event protocol and
+/// the mvnc device/graph monitor and fifo protocol (LoopbackDevice.c).
+///
+/// The backend is enabled either by calling LoopbackLinkConfigure() before
+/// the first mvnc call, or from the environment when XLink is initialized:
+///   XLINK_LOOPBACK_DEVICES    number of simulated devices, 0 disables
+///   XLINK_LOOPBACK_BANDWIDTH  MB/s of each direction of the link, 0 unlimited
+///   XLINK_LOOPBACK_LATENCY_US added to every USB transfer
+///   XLINK_LOOPBACK_INFER_US   device compute time of one inference
+///
+#ifndef _XLINK_LOOPBACKLINKPLATFORM_H
+#define _XLINK_LOOPBACKLINKPLATFORM_H
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Computes the output tensor of one inference on the simulated device.
+// Both tensors are in the device format (fp16).
+typedef void (*loopbackInferFunc_t)(void* ctx, uint32_t graphId,
+                                    const void* input, uint32_t inputSize,
+                                    void* output, uint32_t outputSize);
+
+typedef struct {
+    int devices;
+    double bandwidthMBps;
+    uint32_t latencyUs;
+    uint32_t inferenceUs;
+    // NULL copies the input to the output and zero fills the rest
+    loopbackInferFunc_t infer;
+    void* inferCtx;
+} loopbackLinkConfig_t;
+
+// Overrides the environment. Must be called before XLink is initialized.
+void LoopbackLinkConfigure(const loopbackLinkConfig_t* config);
+int LoopbackLinkEnabled(void);
+
+int LoopbackLinkPlatformInit(void);
+int LoopbackLinkWrite(void* fd, void* data, int size, unsigned int timeout);
+int LoopbackLinkRead(void* fd, void* data, int size, unsigned int timeout);
+int LoopbackLinkPlatformConnect(const char* devPathRead,
+                                const char* devPathWrite, void** fd);
+int LoopbackLinkPlatformGetDeviceName(int index, char* name, int nameSize);
+int LoopbackLinkPlatformBootRemote(const char* deviceName,
+                                   const char* binaryPath);
+int LoopbackLinkPlatformResetRemote(void* fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/* end of include file */
@@ -21,6 +21,7 @@
 ///
 
 #include "UsbLinkPlatform.h"
+#include "LoopbackLinkPlatform.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -169,6 +170,8 @@ void usblink_close(libusb_device_handle *f)
 
 int USBLinkWrite(void* fd, void* data, int size, unsigned int timeout)
 {
+    if (LoopbackLinkEnabled())
+        return LoopbackLinkWrite(fd, data, size, timeout);
     int rc = 0;
 #ifndef USE_USB_VSC
     int byteCount = 0;
@@ -222,6 +225,8 @@ int USBLinkWrite(void* fd, void* data, int size, unsigned int timeout)
  int USBLinkRead(void* fd, void* data, int size, unsigned int timeout)
 {
     //printf("%s() fd %p size %d\n", __func__, fd, size);
+    if (LoopbackLinkEnabled())
+        return LoopbackLinkRead(fd, data, size, timeout);
     int rc = 0;
 #ifndef USE_USB_VSC
     int nread =  0;
@@ -272,6 +277,8 @@ int USBLinkWrite(void* fd, void* data, int size, unsigned int timeout)
 
 int UsbLinkPlatformGetDeviceName(int index, char* name, int nameSize)
 {
+    if (LoopbackLinkEnabled())
+        return LoopbackLinkPlatformGetDeviceName(index, name, nameSize);
     usbBootError_t rc = usb_find_device(index, name, nameSize, 0, 0, 0);
     switch(rc) {
         case USB_BOOT_SUCCESS:
@@ -287,6 +294,8 @@ int UsbLinkPlatformGetDeviceName(int index, char* name, int nameSize)
 //#define XLINK_NO_BOOT
 int UsbLinkPlatformBootRemote(const char* deviceName, const char* binaryPath)
 {
+    if (LoopbackLinkEnabled())
+        return LoopbackLinkPlatformBootRemote(deviceName, binaryPath);
 #ifndef XLINK_NO_BOOT
 
     unsigned filesize;
@@ -354,6 +363,8 @@ int UsbLinkPlatformBootRemote(const char* deviceName, const char* binaryPath)
 
 int USBLinkPlatformResetRemote(void* fd)
 {
+    if (LoopbackLinkEnabled())
+        return LoopbackLinkPlatformResetRemote(fd);
 #ifndef USE_USB_VSC
 #ifdef USE_LINK_JTAG
     /*Nothing*/
@@ -374,6 +385,8 @@ int USBLinkPlatformResetRemote(void* fd)
 }
 int UsbLinkPlatformConnect(const char* devPathRead, const char* devPathWrite, void** fd)
 {
+    if (LoopbackLinkEnabled())
+        return LoopbackLinkPlatformConnect(devPathRead, devPathWrite, fd);
     #ifndef USE_USB_VSC
 #ifdef USE_LINK_JTAG
     struct sockaddr_in serv_addr;
@@ -467,6 +480,7 @@ int UsbLinkPlatformConnect(const char* devPathRead, const char* devPathWrite, vo
 }
 int UsbLinkPlatformInit(int loglevel)
 {
+    LoopbackLinkPlatformInit();
     usb_loglevel = loglevel;
     return 0;
 }
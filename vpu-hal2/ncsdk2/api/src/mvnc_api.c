@@ -401,6 +401,8 @@ ncStatus_t ncDeviceOpen(struct deviceHandle_t *deviceHandle) {
 
 		if (rc != X_LINK_SUCCESS) {
 			mvLog(MVLOG_WARN, "failed to find device\n");
+			free(handler);
+			pthread_mutex_unlock(&globalMutex);
 			return NC_ERROR;
 		}
 		mvLog(MVLOG_INFO, "XLinkConnect done - link Id %d\n", handler->linkId);
@@ -593,8 +595,15 @@ ncStatus_t ncDeviceClose(struct deviceHandle_t *deviceHandle){
 
 	pthread_mutex_lock(&globalMutex);
 	if (findDevice(deviceHandle->private_data)) {
+		struct _devicePrivate_t *d = deviceHandle->private_data;
 		pthread_mutex_unlock(&globalMutex);
-		return NC_INVALID_PARAMETERS;
+		// a handle of ncDeviceInit that was never opened is only released
+		if (d->state != NC_DEVICE_INITIALIZED)
+			return NC_INVALID_PARAMETERS;
+		free(d->dev_addr);
+		free(d);
+		free(deviceHandle);
+		return NC_OK;
 	}
 	mvLog(MVLOG_INFO, "closing device\n");
 
@@ -1358,8 +1367,12 @@ ncStatus_t ncDeviceGetOption(struct deviceHandle_t *deviceHandle,
 
 	pthread_mutex_lock(&globalMutex);
 	if (findDevice(d)) {
-        mvLog(MVLOG_ERROR, "This device handle is corrupt");
 		pthread_mutex_unlock(&globalMutex);
+		// the name of a device that is not opened yet tells which one it is
+		if (d->state == NC_DEVICE_INITIALIZED && opClass == NC_OPTION_CLASS0 &&
+		    option == NC_RO_DEVICE_NAME)
+			return getDeviceOptionClass0(d, option, data, dataLength);
+        mvLog(MVLOG_ERROR, "This device handle is corrupt");
 		return NC_INVALID_PARAMETERS;
 	}
 	pthread_mutex_unlock(&globalMutex);
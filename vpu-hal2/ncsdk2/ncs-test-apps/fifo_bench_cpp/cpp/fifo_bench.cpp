@@ -0,0 +1,182 @@
+// Copyright 2017 Intel Corporation.
+// The source code, information and material ("Material") contained herein is
+// owned by Intel Corporation or its suppliers or licensors, and title to such
+// Material remains with Intel Corporation or its suppliers or licensors.
+// The Material contains proprietary information of Intel or its suppliers and
+// licensors. The Material is protected by worldwide copyright laws and treaty
+// provisions.
+// No part of the Material may be used, copied, reproduced, modified, published,
+// uploaded, posted, transmitted, distributed or disclosed in any way without
+// Intel's prior express written permission. No license under any patent,
+// copyright or other intellectual property rights in the Material is granted to
+// or conferred upon you, either expressly, by implication, inducement, estoppel
+// or otherwise.
+// Any license under such intellectual property rights must be express and
+// approved by Intel in writing.
+
+// Fifo throughput benchmark against the simulated devices of the loopback
+// XLink backend. Every device gets the same synthetic graph, one thread
+// writing inputs and queueing inferences and one thread reading results,
+// with up to the fifo depth of inferences in flight per device.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <mvnc.h>
+#include <LoopbackLinkPlatform.h>
+
+// graph file layout, see mv_blob_format.h of the Myriad graph transformer
+#define ELF_HEADER_SIZE         34
+#define BLOB_MAGIC_NUMBER       8708
+#define STAGE_SECTION_OFFSET    64
+
+struct Device {
+    struct deviceHandle_t* device = nullptr;
+    struct graphHandle_t* graph = nullptr;
+    struct fifoHandle_t* input = nullptr;
+    struct fifoHandle_t* output = nullptr;
+    int errors = 0;
+};
+
+static std::vector<uint8_t> makeGraphFile(uint32_t inputSize, uint32_t outputSize, uint32_t stages)
+{
+    std::vector<uint8_t> blob(STAGE_SECTION_OFFSET + 4 * sizeof(uint32_t), 0);
+    uint32_t header[9] = {BLOB_MAGIC_NUMBER, static_cast<uint32_t>(blob.size()), 2, 1, 1, 0,
+                          STAGE_SECTION_OFFSET, 0, 0};
+    uint32_t stageSection[4] = {stages, sizeof(stageSection), inputSize, outputSize};
+    memcpy(&blob[ELF_HEADER_SIZE], header, sizeof(header));
+    memcpy(&blob[STAGE_SECTION_OFFSET], stageSection, sizeof(stageSection));
+    return blob;
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-d devices] [-n inferences] [-q fifo depth] [-b MB/s] [-l latency us]\n"
+           "          [-t inference us] [-i input bytes] [-o output bytes]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    loopbackLinkConfig_t config = {};
+    config.devices = 1;
+    config.bandwidthMBps = 300;
+    config.latencyUs = 100;
+    config.inferenceUs = 5000;
+    int inferences = 500;
+    int depth = 4;
+    uint32_t inputSize = 3 * 224 * 224 * 2;
+    uint32_t outputSize = 1000 * 2;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:q:b:l:t:i:o:h")) != -1) {
+        switch (opt) {
+        case 'd': config.devices = atoi(optarg); break;
+        case 'n': inferences = atoi(optarg); break;
+        case 'q': depth = atoi(optarg); break;
+        case 'b': config.bandwidthMBps = atof(optarg); break;
+        case 'l': config.latencyUs = atoi(optarg); break;
+        case 't': config.inferenceUs = atoi(optarg); break;
+        case 'i': inputSize = atoi(optarg); break;
+        case 'o': outputSize = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+    if (config.devices < 1 || depth < 1 || inferences < 1) {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    // must come before the first NC API call initializes XLink
+    LoopbackLinkConfigure(&config);
+    int loglevel = 2;
+    ncGlobalSetOption(NC_RW_LOG_LEVEL, &loglevel, sizeof(loglevel));
+
+    std::vector<uint8_t> graphFile = makeGraphFile(inputSize, outputSize, 10);
+    std::vector<Device> devices(config.devices);
+    for (int i = 0; i < config.devices; i++) {
+        Device& d = devices[i];
+        struct ncTensorDescriptor_t* inputDesc;
+        struct ncTensorDescriptor_t* outputDesc;
+        unsigned int length;
+        ncStatus_t retCode = ncDeviceInit(i, &d.device);
+        if (retCode == NC_OK)
+            retCode = ncDeviceOpen(d.device);
+        if (retCode == NC_OK)
+            retCode = ncGraphInit("bench", &d.graph);
+        if (retCode == NC_OK)
+            retCode = ncGraphAllocate(d.device, d.graph, graphFile.data(), graphFile.size());
+        if (retCode == NC_OK)
+            retCode = ncGraphGetOption(d.graph, NC_OPTION_CLASS0, NC_RO_GRAPH_INPUT_TENSOR_DESCRIPTORS, &inputDesc, &length);
+        if (retCode == NC_OK)
+            retCode = ncGraphGetOption(d.graph, NC_OPTION_CLASS0, NC_RO_GRAPH_OUTPUT_TENSOR_DESCRIPTORS, &outputDesc, &length);
+        if (retCode == NC_OK)
+            retCode = ncFifoInit(NC_FIFO_HOST_WO, &d.input);
+        if (retCode == NC_OK)
+            retCode = ncFifoInit(NC_FIFO_HOST_RO, &d.output);
+        if (retCode == NC_OK)
+            retCode = ncFifoCreate(d.input, d.device, inputDesc, depth);
+        if (retCode == NC_OK)
+            retCode = ncFifoCreate(d.output, d.device, outputDesc, depth);
+        if (retCode != NC_OK) {
+            printf("Error - could not set up device %d\n", i);
+            printf("    ncStatus value: %d\n", retCode);
+            exit(-1);
+        }
+    }
+
+    std::vector<uint8_t> input(inputSize);
+    for (uint32_t i = 0; i < inputSize; i++)
+        input[i] = static_cast<uint8_t>(i * 7);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < config.devices; i++) {
+        int count = inferences / config.devices + (i < inferences % config.devices ? 1 : 0);
+        Device* d = &devices[i];
+        threads.emplace_back([d, count, &input]() {
+            for (int n = 0; n < count; n++) {
+                if (ncGraphQueueInferenceWithFifoElem(d->graph, &d->input, &d->output,
+                                                      input.data(), NULL, NULL) != NC_OK)
+                    d->errors++;
+            }
+        });
+        threads.emplace_back([d, count, outputSize, &input]() {
+            for (int n = 0; n < count; n++) {
+                void* result;
+                void* userParam;
+                struct ncTensorDescriptor_t desc;
+                if (ncFifoReadElem(d->output, &result, &desc, &userParam) != NC_OK ||
+                    memcmp(result, input.data(), outputSize < input.size() ? outputSize : input.size()))
+                    d->errors++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int errors = 0;
+    for (auto& d : devices) {
+        errors += d.errors;
+        ncFifoDelete(d.input);
+        ncFifoDelete(d.output);
+        ncGraphDeallocate(d.graph);
+        ncDeviceClose(d.device);
+    }
+
+    double transfer = inputSize / config.bandwidthMBps / 1000.0;
+    printf("%d devices, fifo depth %d, %u us inference, %.2f ms input transfer\n",
+           config.devices, depth, config.inferenceUs, config.bandwidthMBps > 0 ? transfer : 0.0);
+    printf("%d inferences in %.3f s: %.1f inferences/s, %.3f ms each, %d errors\n",
+           inferences, seconds, inferences / seconds, seconds * 1000.0 / inferences, errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+LOCAL_PATH:= $(call my-dir)
+
+# ==================================
+
+# executable: fp16_bench
+$(info LOCAL_PATH =$(LOCAL_PATH))
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := fp16_bench.cpp
+
+LOCAL_MODULE := fp16_bench
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)
+
+# the reference converters must round x * scale + bias the way libvpu_fp16 does
+LOCAL_CFLAGS += -O2 -Wall -fPIE -ffp-contract=off -std=c++11
+
+LOCAL_STATIC_LIBRARIES := libvpu_fp16
+
+include $(BUILD_EXECUTABLE)
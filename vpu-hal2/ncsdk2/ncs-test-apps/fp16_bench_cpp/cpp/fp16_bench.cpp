@@ -0,0 +1,416 @@
+// Copyright 2017 Intel Corporation.
+// The source code, information and material ("Material") contained herein is
+// owned by Intel Corporation or its suppliers or licensors, and title to such
+// Material remains with Intel Corporation or its suppliers or licensors.
+// The Material contains proprietary information of Intel or its suppliers and
+// licensors. The Material is protected by worldwide copyright laws and treaty
+// provisions.
+// No part of the Material may be used, copied, reproduced, modified, published,
+// uploaded, posted, transmitted, distributed or disclosed in any way without
+// Intel's prior express written permission. No license under any patent,
+// copyright or other intellectual property rights in the Material is granted to
+// or conferred upon you, either expressly, by implication, inducement, estoppel
+// or otherwise.
+// Any license under such intellectual property rights must be express and
+// approved by Intel in writing.
+
+// Checks libvpu_fp16 against the scalar converters it replaced, the
+// Inference Engine PrecisionUtils ones and the numpy ones of libmvnc, and
+// times both. Every fp16 value is converted to fp32, and every fp16 value,
+// the fp32 values next to it and the rounding boundaries around it are
+// converted to fp16, by the scalar functions and by the array kernels.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <vpu_fp16.h>
+
+// The converters as they were before libvpu_fp16, kept bit for bit.
+namespace reference {
+
+#define EXP_MASK_F32 0x7F800000U
+#define EXP_MASK_F16     0x7C00U
+
+static inline float asfloat(uint32_t v)
+{
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+// PrecisionUtils::f16tof32
+static float f16tof32(uint16_t x)
+{
+    uint32_t u = x;
+    uint32_t s = ((u & 0x8000) << 16);
+
+    if ((u & EXP_MASK_F16) == EXP_MASK_F16) {
+        u &= 0x03FF;
+        if (u) {
+            u |= 0x0200;
+        }
+        u <<= (23 - 10);
+        u |= EXP_MASK_F32;
+        u |= s;
+    } else if ((x & EXP_MASK_F16) == 0) {
+        u = s;
+    } else {
+        u = (u & 0x7FFF);
+        u <<= (23 - 10);
+        u += ((127 - 15) << 23);
+        u |= s;
+    }
+    return asfloat(u);
+}
+
+// PrecisionUtils::f32tof16
+static uint16_t f32tof16(float x)
+{
+    static float min16 = asfloat((127 - 14) << 23);
+    static float max16 = asfloat(((127 + 15) << 23) | 0x007FE000);
+    static uint32_t max16f16 = ((15 + 15) << 10) | 0x3FF;
+
+    union {
+        float f;
+        uint32_t u;
+    } v;
+    v.f = x;
+
+    uint32_t s = (v.u >> 16) & 0x8000;
+    v.u &= 0x7FFFFFFF;
+
+    if ((v.u & EXP_MASK_F32) == EXP_MASK_F32) {
+        if (v.u & 0x007FFFFF) {
+            return s | (v.u >> (23 - 10)) | 0x0200;
+        } else {
+            return s | (v.u >> (23 - 10));
+        }
+    }
+
+    float halfULP = asfloat(v.u & EXP_MASK_F32) * asfloat((127 - 11) << 23);
+    v.f += halfULP;
+
+    if (v.f < min16 * 0.5F) {
+        return s;
+    }
+    if (v.f < min16) {
+        return s | (1 << 10);
+    }
+    if (v.f >= max16) {
+        return max16f16 | s;
+    }
+
+    v.u -= ((127 - 15) << 23);
+    v.u >>= (23 - 10);
+    return v.u | s;
+}
+
+// half2float of libmvnc, copied from numpy
+static uint32_t half2float(uint16_t h)
+{
+    uint16_t h_exp, h_sig;
+    uint32_t f_sgn, f_exp, f_sig;
+
+    h_exp = (h&0x7c00u);
+    f_sgn = ((uint32_t)h&0x8000u) << 16;
+    switch (h_exp) {
+        case 0x0000u:
+            h_sig = (h&0x03ffu);
+            if (h_sig == 0) {
+                return f_sgn;
+            }
+            h_sig <<= 1;
+            while ((h_sig&0x0400u) == 0) {
+                h_sig <<= 1;
+                h_exp++;
+            }
+            f_exp = ((uint32_t)(127 - 15 - h_exp)) << 23;
+            f_sig = ((uint32_t)(h_sig&0x03ffu)) << 13;
+            return f_sgn + f_exp + f_sig;
+        case 0x7c00u:
+            return f_sgn + 0x7f800000u + (((uint32_t)(h&0x03ffu)) << 13);
+        default:
+            return f_sgn + (((uint32_t)(h&0x7fffu) + 0x1c000u) << 13);
+    }
+}
+
+// float2half of libmvnc, copied from numpy
+static uint16_t float2half(uint32_t f)
+{
+    uint32_t f_exp, f_sig;
+    uint16_t h_sgn, h_exp, h_sig;
+
+    h_sgn = (uint16_t) ((f&0x80000000u) >> 16);
+    f_exp = (f&0x7f800000u);
+
+    if (f_exp >= 0x47800000u) {
+        if (f_exp == 0x7f800000u) {
+            f_sig = (f&0x007fffffu);
+            if (f_sig != 0) {
+                uint16_t ret = (uint16_t) (0x7c00u + (f_sig >> 13));
+                if (ret == 0x7c00u) {
+                    ret++;
+                }
+                return h_sgn + ret;
+            } else {
+                return (uint16_t) (h_sgn + 0x7c00u);
+            }
+        } else {
+            return (uint16_t) (h_sgn + 0x7c00u);
+        }
+    }
+
+    if (f_exp <= 0x38000000u) {
+        if (f_exp < 0x33000000u) {
+            return h_sgn;
+        }
+        f_exp >>= 23;
+        f_sig = (0x00800000u + (f&0x007fffffu));
+        f_sig >>= (113 - f_exp);
+        f_sig += 0x00001000u;
+        h_sig = (uint16_t) (f_sig >> 13);
+        return (uint16_t) (h_sgn + h_sig);
+    }
+
+    h_exp = (uint16_t) ((f_exp - 0x38000000u) >> 13);
+    f_sig = (f&0x007fffffu);
+    f_sig += 0x00001000u;
+    h_sig = (uint16_t) (f_sig >> 13);
+    return h_sgn + h_exp + h_sig;
+}
+
+}  // namespace reference
+
+static uint32_t asbits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static float asfloat(uint32_t u)
+{
+    return reference::asfloat(u);
+}
+
+struct Check {
+    const char* name;
+    uint64_t values = 0;
+    uint64_t mismatches = 0;
+
+    explicit Check(const char* name) : name(name) {}
+
+    void expect(uint32_t got, uint32_t want, uint32_t input)
+    {
+        values++;
+        if (got != want && mismatches++ < 10)
+            printf("  %s: input 0x%08x gives 0x%08x, expected 0x%08x\n", name, input, got, want);
+    }
+
+    uint64_t report() const
+    {
+        printf("%-28s %8llu values, %llu mismatches\n", name,
+               static_cast<unsigned long long>(values), static_cast<unsigned long long>(mismatches));
+        return mismatches;
+    }
+};
+
+// every fp16 value as fp32, the fp32 values next to it and the rounding
+// boundaries to the next fp16 value with their neighbours
+static std::vector<float> fp16ConversionInputs()
+{
+    std::vector<float> inputs;
+    for (uint32_t h = 0; h < 0x10000; h++) {
+        uint32_t f = reference::half2float(h);
+        inputs.push_back(asfloat(f));
+        if ((h & 0x7c00) == 0x7c00)
+            continue;
+        inputs.push_back(asfloat(f + 1));
+        if ((h & 0x7fff) != 0)
+            inputs.push_back(asfloat(f - 1));
+
+        uint32_t next = reference::half2float(h + 1);
+        if ((h & 0x7fff) != 0x7bff && (h & 0x7fff) != 0x7fff) {
+            uint32_t middle = asbits((asfloat(f) + asfloat(next)) * 0.5f);
+            inputs.push_back(asfloat(middle));
+            inputs.push_back(asfloat(middle + 1));
+            inputs.push_back(asfloat(middle - 1));
+        }
+    }
+    // beyond the fp16 range
+    for (float big : {65504.0f, 65519.0f, 65520.0f, 65536.0f, 1e10f, 3.4e38f}) {
+        inputs.push_back(big);
+        inputs.push_back(-big);
+    }
+    return inputs;
+}
+
+static uint64_t checkEquivalence()
+{
+    const float scales[][2] = {{1.0f, 0.0f}, {0.5f, 3.0f}, {-2.0f, 0.25f}};
+
+    std::vector<uint16_t> halves(0x10000);
+    for (uint32_t h = 0; h < halves.size(); h++)
+        halves[h] = static_cast<uint16_t>(h);
+    std::vector<float> floats = fp16ConversionInputs();
+
+    std::vector<float> floatOut(floats.size() > halves.size() ? floats.size() : halves.size());
+    std::vector<uint16_t> halfOut(floatOut.size());
+
+    Check toF32("vpu_fp16_to_f32"), toF32Ieee("vpu_fp16_to_f32_ieee");
+    Check fromF32("vpu_fp16_from_f32"), fromF32Ieee("vpu_fp16_from_f32_ieee");
+    for (uint16_t h : halves) {
+        toF32.expect(asbits(vpu_fp16_to_f32(h)), asbits(reference::f16tof32(h)), h);
+        toF32Ieee.expect(vpu_fp16_to_f32_ieee(h), reference::half2float(h), h);
+    }
+    for (float f : floats) {
+        fromF32.expect(vpu_fp16_from_f32(f), reference::f32tof16(f), asbits(f));
+        fromF32Ieee.expect(vpu_fp16_from_f32_ieee(asbits(f)), reference::float2half(asbits(f)), asbits(f));
+    }
+
+    // the array kernels run from an aligned and from a misaligned start, so
+    // the vector loops and the scalar tails both see every value
+    Check toF32Array("vpu_fp16_to_f32_array"), toF32IeeeArray("vpu_fp16_to_f32_ieee_array");
+    Check fromF32Array("vpu_fp16_from_f32_array"), fromF32IeeeArray("vpu_fp16_from_f32_ieee_array");
+    for (size_t start = 0; start < 2; start++) {
+        size_t n = halves.size() - start;
+        for (const auto& sb : scales) {
+            vpu_fp16_to_f32_array(&floatOut[0], &halves[start], n, sb[0], sb[1]);
+            for (size_t i = 0; i < n; i++) {
+                uint16_t h = halves[start + i];
+                toF32Array.expect(asbits(floatOut[i]), asbits(reference::f16tof32(h) * sb[0] + sb[1]), h);
+            }
+        }
+        vpu_fp16_to_f32_ieee_array(&floatOut[0], &halves[start], n);
+        for (size_t i = 0; i < n; i++)
+            toF32IeeeArray.expect(asbits(floatOut[i]), reference::half2float(halves[start + i]), halves[start + i]);
+
+        n = floats.size() - start;
+        for (const auto& sb : scales) {
+            vpu_fp16_from_f32_array(&halfOut[0], &floats[start], n, sb[0], sb[1]);
+            for (size_t i = 0; i < n; i++) {
+                float f = floats[start + i];
+                fromF32Array.expect(halfOut[i], reference::f32tof16(f * sb[0] + sb[1]), asbits(f));
+            }
+        }
+        vpu_fp16_from_f32_ieee_array(&halfOut[0], &floats[start], n);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t f = asbits(floats[start + i]);
+            fromF32IeeeArray.expect(halfOut[i], reference::float2half(f), f);
+        }
+    }
+
+    return toF32.report() + toF32Ieee.report() + fromF32.report() + fromF32Ieee.report() +
+           toF32Array.report() + toF32IeeeArray.report() + fromF32Array.report() + fromF32IeeeArray.report();
+}
+
+// best of the repeats, in ns per element
+static double timeConversion(const std::function<void()>& convert, size_t elements, int repeats)
+{
+    double best = 0.0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        convert();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+    return best / elements;
+}
+
+static void printTiming(const char* name, double referenceNs, double kernelNs)
+{
+    printf("%-28s %6.3f ns/elem, scalar %6.3f ns/elem, %.2fx faster\n",
+           name, kernelNs, referenceNs, referenceNs / kernelNs);
+}
+
+static void benchmark(size_t elements, int repeats)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+    std::vector<float> floats(elements), floatOut(elements);
+    std::vector<uint16_t> halves(elements), halfOut(elements);
+    for (size_t i = 0; i < elements; i++) {
+        floats[i] = distribution(random);
+        halves[i] = reference::f32tof16(floats[i]);
+    }
+    const float scale = 0.5f, bias = 3.0f;
+
+    printf("%zu elements, best of %d runs, kernels: %s\n", elements, repeats, vpu_fp16_isa());
+
+    printTiming("vpu_fp16_from_f32_array",
+        timeConversion([&] {
+            for (size_t i = 0; i < elements; i++)
+                halfOut[i] = reference::f32tof16(floats[i] * scale + bias);
+        }, elements, repeats),
+        timeConversion([&] { vpu_fp16_from_f32_array(&halfOut[0], &floats[0], elements, scale, bias); },
+                       elements, repeats));
+    printTiming("vpu_fp16_to_f32_array",
+        timeConversion([&] {
+            for (size_t i = 0; i < elements; i++)
+                floatOut[i] = reference::f16tof32(halves[i]) * scale + bias;
+        }, elements, repeats),
+        timeConversion([&] { vpu_fp16_to_f32_array(&floatOut[0], &halves[0], elements, scale, bias); },
+                       elements, repeats));
+    printTiming("vpu_fp16_from_f32_ieee_array",
+        timeConversion([&] {
+            for (size_t i = 0; i < elements; i++)
+                halfOut[i] = reference::float2half(asbits(floats[i]));
+        }, elements, repeats),
+        timeConversion([&] { vpu_fp16_from_f32_ieee_array(&halfOut[0], &floats[0], elements); },
+                       elements, repeats));
+    printTiming("vpu_fp16_to_f32_ieee_array",
+        timeConversion([&] {
+            for (size_t i = 0; i < elements; i++)
+                floatOut[i] = asfloat(reference::half2float(halves[i]));
+        }, elements, repeats),
+        timeConversion([&] { vpu_fp16_to_f32_ieee_array(&floatOut[0], &halves[0], elements); },
+                       elements, repeats));
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-n elements] [-r repeats] [-c]\n"
+           "  -c  run the equivalence check only\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    size_t elements = 1 << 20;
+    int repeats = 20;
+    bool checkOnly = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:ch")) != -1) {
+        switch (opt) {
+        case 'n': elements = strtoul(optarg, NULL, 0); break;
+        case 'r': repeats = atoi(optarg); break;
+        case 'c': checkOnly = true; break;
+        default:
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+    if (elements < 1 || repeats < 1) {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    uint64_t mismatches = checkEquivalence();
+    if (mismatches) {
+        printf("Error - %llu conversions differ from the scalar converters\n",
+               static_cast<unsigned long long>(mismatches));
+        return 1;
+    }
+    if (!checkOnly)
+        benchmark(elements, repeats);
+    return 0;
+}
@@ -0,0 +1,28 @@
+LOCAL_PATH:= $(call my-dir)
+
+# ==================================
+
+# executable: graph_upload_bench
+$(info LOCAL_PATH =$(LOCAL_PATH))
+include $(CLEAR_VARS)
+
+LIBUSB_HEADER:= $(LOCAL_PATH)/../../../../../../../../../../external/libusb/libusb
+
+LOCAL_SRC_FILES := graph_upload_bench.cpp
+
+LOCAL_MODULE := graph_upload_bench
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH) \
+	$(LOCAL_PATH)/../../../../api/include \
+	$(LIBUSB_HEADER) \
+	$(LOCAL_PATH)/../../../../api/src/common/components/XLink/pc
+
+
+LOCAL_CFLAGS += -O2 -Wall -pthread -fPIC -MMD -MP -fPIE -std=c++11
+
+#LOCAL_SHARED_LIBRARIES := libmvnc
+LOCAL_SHARED_LIBRARIES := libusb1.0 liblog libmvnc
+LOCAL_STATIC_LIBRARIES :=
+
+include $(BUILD_EXECUTABLE)
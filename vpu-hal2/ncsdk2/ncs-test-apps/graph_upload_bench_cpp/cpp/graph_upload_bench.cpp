@@ -0,0 +1,164 @@
+// Copyright 2017 Intel Corporation.
+// The source code, information and material ("Material") contained herein is
+// owned by Intel Corporation or its suppliers or licensors, and title to such
+// Material remains with Intel Corporation or its suppliers or licensors.
+// The Material contains proprietary information of Intel or its suppliers and
+// licensors. The Material is protected by worldwide copyright laws and treaty
+// provisions.
+// No part of the Material may be used, copied, reproduced, modified, published,
+// uploaded, posted, transmitted, distributed or disclosed in any way without
+// Intel's prior express written permission. No license under any patent,
+// copyright or other intellectual property rights in the Material is granted to
+// or conferred upon you, either expressly, by implication, inducement, estoppel
+// or otherwise.
+// Any license under such intellectual property rights must be express and
+// approved by Intel in writing.
+
+// Graph upload benchmark against a simulated device of the loopback XLink
+// backend. Times ncGraphAllocate for the decoded size of a graph file and,
+// when its weights are compressed, for the size of the file itself, which is
+// what a device decoding the weights would have to receive.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+#include <mvnc.h>
+#include <LoopbackLinkPlatform.h>
+
+// graph file layout, see mv_blob_format.h of the Myriad graph transformer
+#define ELF_HEADER_SIZE         34
+#define BLOB_MAGIC_NUMBER       8708
+#define STAGE_SECTION_OFFSET    64
+
+// compressed graph file header, see blob_compression.cpp of the Myriad plugin
+#define COMPRESSION_MAGIC       0x5a42564dU
+#define COMPRESSED_SIZE_OFFSET  8
+
+// The simulated firmware only parses the graph headers, so a graph of the
+// same size costs the link the same as the real one.
+static std::vector<uint8_t> makeGraphFile(uint32_t size)
+{
+    std::vector<uint8_t> blob(size > STAGE_SECTION_OFFSET + 16 ? size : STAGE_SECTION_OFFSET + 16, 0);
+    uint32_t header[9] = {BLOB_MAGIC_NUMBER, static_cast<uint32_t>(blob.size()), 2, 1, 1, 0,
+                          STAGE_SECTION_OFFSET, 0, 0};
+    uint32_t stageSection[4] = {1, sizeof(stageSection), 2, 2};
+    memcpy(&blob[ELF_HEADER_SIZE], header, sizeof(header));
+    memcpy(&blob[STAGE_SECTION_OFFSET], stageSection, sizeof(stageSection));
+    return blob;
+}
+
+// Returns the mean time of one ncGraphAllocate in seconds, or a negative value on error.
+static double timeUpload(struct deviceHandle_t* device, const std::vector<uint8_t>& graphFile, int uploads)
+{
+    double seconds = 0;
+    for (int n = 0; n < uploads; n++) {
+        struct graphHandle_t* graph;
+        if (ncGraphInit("upload", &graph) != NC_OK)
+            return -1;
+        auto start = std::chrono::steady_clock::now();
+        ncStatus_t retCode = ncGraphAllocate(device, graph, graphFile.data(), graphFile.size());
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (retCode != NC_OK) {
+            printf("    ncStatus value: %d\n", retCode);
+            return -1;
+        }
+        ncGraphDeallocate(graph);
+    }
+    return seconds / uploads;
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s -g graph file [-n uploads] [-b MB/s] [-l latency us]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    loopbackLinkConfig_t config = {};
+    config.devices = 1;
+    config.bandwidthMBps = 40;
+    config.latencyUs = 100;
+    const char* graphPath = NULL;
+    int uploads = 5;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:n:b:l:h")) != -1) {
+        switch (opt) {
+        case 'g': graphPath = optarg; break;
+        case 'n': uploads = atoi(optarg); break;
+        case 'b': config.bandwidthMBps = atof(optarg); break;
+        case 'l': config.latencyUs = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+    if (graphPath == NULL || uploads < 1) {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    std::ifstream file(graphPath, std::ios::binary);
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (content.empty()) {
+        printf("Error - could not read %s\n", graphPath);
+        exit(-1);
+    }
+    uint32_t fileSize = content.size();
+    uint32_t plainSize = fileSize;
+    uint32_t magic = 0;
+    if (fileSize >= COMPRESSED_SIZE_OFFSET + sizeof(plainSize))
+        memcpy(&magic, &content[0], sizeof(magic));
+    bool compressed = magic == COMPRESSION_MAGIC;
+    if (compressed)
+        memcpy(&plainSize, &content[COMPRESSED_SIZE_OFFSET], sizeof(plainSize));
+
+    // must come before the first NC API call initializes XLink
+    LoopbackLinkConfigure(&config);
+    int loglevel = 2;
+    ncGlobalSetOption(NC_RW_LOG_LEVEL, &loglevel, sizeof(loglevel));
+
+    struct deviceHandle_t* device;
+    ncStatus_t retCode = ncDeviceInit(0, &device);
+    if (retCode == NC_OK)
+        retCode = ncDeviceOpen(device);
+    if (retCode != NC_OK) {
+        printf("Error - could not open the simulated device\n");
+        printf("    ncStatus value: %d\n", retCode);
+        exit(-1);
+    }
+
+    printf("%s: %u bytes, weights %s\n", graphPath, plainSize,
+           compressed ? "compressed" : "not compressed");
+    printf("link %.1f MB/s, %u us latency, %d uploads each\n",
+           config.bandwidthMBps, config.latencyUs, uploads);
+
+    int rc = 0;
+    double plainSeconds = timeUpload(device, makeGraphFile(plainSize), uploads);
+    if (plainSeconds < 0) {
+        printf("Error - could not allocate a graph of %u bytes\n", plainSize);
+        rc = 1;
+    } else {
+        printf("plain upload:      %10u bytes in %.3f s\n", plainSize, plainSeconds);
+    }
+    if (compressed && rc == 0) {
+        double compressedSeconds = timeUpload(device, makeGraphFile(fileSize), uploads);
+        if (compressedSeconds < 0) {
+            printf("Error - could not allocate a graph of %u bytes\n", fileSize);
+            rc = 1;
+        } else {
+            printf("compressed upload: %10u bytes in %.3f s, %.1f%% of the size, %.2fx faster\n",
+                   fileSize, compressedSeconds, 100.0 * fileSize / plainSize, plainSeconds / compressedSeconds);
+        }
+    }
+
+    ncDeviceClose(device);
+    return rc;
+}
@@ -35,9 +35,13 @@
 #include "ie_exception_conversion.hpp"
 #include "debug.h"
 #include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
 
 #include <android/log.h>
 #include <cutils/log.h>
+#include <cutils/properties.h>
 
 using namespace InferenceEngine::details;
 using namespace IRBuilder;
@@ -97,61 +101,156 @@ static void setConfig(std::map<std::string, std::string> &config) {
     //config[VPUConfigParams::VPU_LOG_LEVEL] = CONFIG_VALUE(LOG_DEBUG);
     //config[InferenceEngine::PluginConfigParams::KEY_LOG_LEVEL] = InferenceEngine::PluginConfigParams::LOG_DEBUG /*LOG_WARNING*/;
     //config[InferenceEngine::VPUConfigParams::IGNORE_UNKNOWN_LAYERS] = InferenceEngine::PluginConfigParams::NO;
+
+    // replicate networks on every attached stick
+    if (property_get_bool("vendor.vpu.multi_device", false)) {
+        config[VPU_CONFIG_KEY(MULTI_DEVICE)] = CONFIG_VALUE(YES);
+    }
 }
 
+// Number of infer requests created per network. The device fifos are made as
+// deep as the pool, so every pooled request can have an inference in flight
+// at the same time.
+#define VPU_DEFAULT_INFER_REQUESTS 4
+
 class ExecuteNetwork
 {
     InferenceEnginePluginPtr enginePtr;
+    TargetDevice targetDevice = TargetDevice::eMYRIAD;
     ICNNNetwork *network;
     //IExecutableNetwork::Ptr pExeNet;
     ExecutableNetwork executable_network;
     InputsDataMap inputInfo;
     OutputsDataMap outputInfo;
     IInferRequest::Ptr req;
-    InferRequest inferRequest;
     ResponseDesc resp;
 
+    // pool of infer requests, checked out by one execution at a time
+    std::vector<InferRequest> inferRequests;
+    std::vector<size_t> freeRequests;
+    std::mutex requestMutex;
+    std::condition_variable requestAvailable;
+
+    void createInferRequests(size_t numRequests)
+    {
+        if (numRequests == 0) numRequests = 1;
+
+        std::lock_guard<std::mutex> lock(requestMutex);
+        inferRequests.clear();
+        freeRequests.clear();
+        for (size_t i = 0; i < numRequests; i++) {
+            inferRequests.push_back(executable_network.CreateInferRequest());
+            freeRequests.push_back(i);
+        }
+        ALOGI("%zu infer requests created", numRequests);
+    }
+
 public:
     ExecuteNetwork(){}
     ExecuteNetwork(IRDocument &doc, TargetDevice target = TargetDevice::eCPU)
     {
         InferenceEngine::PluginDispatcher dispatcher({"/vendor/lib64","/vendor/lib","/system/lib64","/system/lib","","./"});
         enginePtr = dispatcher.getSuitablePlugin(target);
+        targetDevice = target;
 
         network = doc.getNetwork();
         network->getInputsInfo(inputInfo);
         network->getOutputsInfo(outputInfo);
 
-        size_t batch = 1;
-        network->setBatchSize(batch);
+        // the Myriad plugin runs batched networks one batch item at a time
+        if (target != TargetDevice::eMYRIAD) {
+            size_t batch = 1;
+            network->setBatchSize(batch);
+        }
 
     		#ifdef NNLOG
             ALOGI("Myriad Plugin loaded");
     		#endif
     }
 
-    ExecuteNetwork(ExecutableNetwork& exeNet) : ExecuteNetwork(){
+    ExecuteNetwork(ExecutableNetwork& exeNet, size_t numRequests = VPU_DEFAULT_INFER_REQUESTS) : ExecuteNetwork(){
     executable_network = exeNet;
-    inferRequest = executable_network.CreateInferRequest();
-    ALOGI("infer request created");
-
+    createInferRequests(numRequests);
     }
 
-    void loadNetwork()
+    void loadNetwork(size_t numRequests = VPU_DEFAULT_INFER_REQUESTS)
     {
 
+        // the CPU plugin rejects the Myriad keys
         std::map<std::string, std::string> networkConfig;
-        setConfig(networkConfig);
+        if (targetDevice == TargetDevice::eMYRIAD) {
+            setConfig(networkConfig);
+            networkConfig[VPU_CONFIG_KEY(FIFO_DEPTH)] = std::to_string(std::max<size_t>(numRequests, 1));
+        }
 
         InferencePlugin plugin(enginePtr);
         executable_network = plugin.LoadNetwork(*network, networkConfig);
         //std::cout << "Network loaded" << std::endl;
 		    ALOGI("Network loaded");
 
-        inferRequest = executable_network.CreateInferRequest();
-        //std::cout << "infer request created" << std::endl;
+        createInferRequests(numRequests);
       }
 
+    // Loads a network previously written by exportNetwork() instead of
+    // compiling it. Returns false if the plugin refuses the file.
+    bool importNetwork(const std::string& fileName, size_t numRequests = VPU_DEFAULT_INFER_REQUESTS)
+    {
+        try {
+            InferencePlugin plugin(enginePtr);
+            plugin.SetConfig({{VPU_CONFIG_KEY(FIFO_DEPTH), std::to_string(std::max<size_t>(numRequests, 1))}});
+            IExecutableNetwork::Ptr exeNet;
+            plugin.ImportNetwork(exeNet, fileName);
+            executable_network = ExecutableNetwork(exeNet);
+        } catch (const std::exception& ex) {
+            ALOGW("failed to import network from %s: %s", fileName.c_str(), ex.what());
+            return false;
+        }
+        ALOGI("Network imported from %s", fileName.c_str());
+
+        createInferRequests(numRequests);
+        return true;
+    }
+
+    bool exportNetwork(const std::string& fileName)
+    {
+        try {
+            executable_network.Export(fileName);
+        } catch (const std::exception& ex) {
+            ALOGW("failed to export network to %s: %s", fileName.c_str(), ex.what());
+            return false;
+        }
+        return true;
+    }
+
+    std::string pluginVersion()
+    {
+        const Version *version = nullptr;
+        enginePtr->GetVersion(version);
+        return (version && version->buildNumber) ? version->buildNumber : "";
+    }
+
+    // Checks out an idle infer request, blocking until one is returned
+    // when all of them are in flight.
+    size_t acquireInferRequest()
+    {
+        std::unique_lock<std::mutex> lock(requestMutex);
+        requestAvailable.wait(lock, [this] { return !freeRequests.empty(); });
+        size_t id = freeRequests.back();
+        freeRequests.pop_back();
+        return id;
+    }
+
+    void releaseInferRequest(size_t id)
+    {
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            freeRequests.push_back(id);
+        }
+        requestAvailable.notify_one();
+    }
+
+    size_t numInferRequests() const { return inferRequests.size(); }
+
     void prepareInput()
     {
 	  #ifdef NNLOG
@@ -182,7 +281,7 @@ public:
     }
 
     //setBlob input/output blob for infer request
-    void setBlob(const std::string& inName, const Blob::Ptr& inputBlob)
+    void setBlob(size_t id, const std::string& inName, const Blob::Ptr& inputBlob)
     {
         #ifdef NNLOG
         ALOGI("setBlob input or output blob name : %s", inName.c_str());
@@ -190,16 +289,16 @@ public:
         #endif
 
         //inferRequest.SetBlob(inName.c_str(), inputBlob);
-        inferRequest.SetBlob(inName, inputBlob);
+        inferRequests[id].SetBlob(inName, inputBlob);
 
         //std::cout << "setBlob input or output name : " << inName << std::endl;
 
     }
 
      //for non aync infer request
-    TBlob<float>::Ptr getBlob(const std::string& outName) {
+    TBlob<float>::Ptr getBlob(size_t id, const std::string& outName) {
        Blob::Ptr outputBlob;
-       outputBlob = inferRequest.GetBlob(outName);
+       outputBlob = inferRequests[id].GetBlob(outName);
        //std::cout << "GetBlob input or output name : " << outName << std::endl;
        #ifdef NNLOG
        ALOGI("Get input/output blob, name : ", outName.c_str());
@@ -208,39 +307,41 @@ public:
        //return outputBlob;
     }
 
-    void Infer() {
-        #ifdef NNLOG
-        ALOGI("Infer Network\n");
-        #endif
-//        inferRequest = executable_network.CreateInferRequest();
-/*
-        auto inName = inputInfo.begin()->first;
-        ALOGI("set input blob\n");
-        inferRequest.SetBlob(inName, in);
-
-        ALOGI("aks prepare output blob\n");
-        const std::string firstOutName = outputInfo.begin()->first;
-        InferenceEngine::TBlob<PrecisionTrait<Precision::FP32>::value_type>::Ptr outputBlob;
-        outputBlob = InferenceEngine::make_shared_blob<PrecisionTrait<Precision::FP32>::value_type,
-                InferenceEngine::SizeVector>(Precision::FP32, outputInfo.begin()->second->getDims());
-        outputBlob->allocate();
-
-        ALOGI("set output blob\n");
-        inferRequest.SetBlob(firstOutName, outputBlob);
-
-*/
+    // Runs the request to completion. Returns the status of the inference,
+    // anything but OK means the outputs are not valid.
+    StatusCode Infer(size_t id) {
         #ifdef NNLOG
         ALOGI("StartAsync scheduled");
         #endif
-        inferRequest.StartAsync();  //for async infer
-        //ALOGI("async wait");
-        inferRequest.Wait(1000);
+        inferRequests[id].StartAsync();  //for async infer
+        StatusCode status = inferRequests[id].Wait(IInferRequest::WaitMode::RESULT_READY);
+        if (status != StatusCode::OK) {
+            ALOGE("infer request %zu failed with status %d", id, status);
+            return status;
+        }
 
-        //std::cout << "output name : " << firstOutName << std::endl;
         #ifdef NNLOG
         ALOGI("infer request completed");
         #endif
 
-        return;
+        return status;
     }
 };
+
+// Holds an infer request of a network for the scope of one execution and
+// returns it to the pool on every path out, including exceptions.
+class InferRequestLease
+{
+    ExecuteNetwork* engine;
+    size_t requestId;
+
+public:
+    explicit InferRequestLease(ExecuteNetwork* enginePtr)
+        : engine(enginePtr), requestId(enginePtr->acquireInferRequest()) {}
+    ~InferRequestLease() { engine->releaseInferRequest(requestId); }
+
+    InferRequestLease(const InferRequestLease&) = delete;
+    InferRequestLease& operator=(const InferRequestLease&) = delete;
+
+    size_t id() const { return requestId; }
+};